@@ -230,6 +230,74 @@ class DenseNDArray(NDArray, somacore.DenseNDArray):
             arrow_table.column("soma_data").to_numpy().reshape(target_shape)
         )
 
+    def read_into(
+        self,
+        coords: Sequence[Union[int, slice]],
+        out: np.ndarray,
+    ) -> np.ndarray:
+        """Reads a dense slice of the array directly into a NumPy array.
+
+        Unlike :meth:`read`, the cells are written by TileDB straight into
+        ``out`` rather than through Arrow, which avoids allocating and copying
+        the result. ``coords`` holds one integer or slice per dimension; slice
+        indices are doubly inclusive, and an unbounded slice covers the shape
+        of the dimension. ``out`` must be a writeable, C- or Fortran-contiguous
+        array with the dtype of ``soma_data`` and the shape of the slice.
+
+        Args:
+            coords:
+                One integer or slice (with step 1) per dimension.
+            out:
+                The array to read the cells into.
+
+        Returns:
+            ``out``.
+
+        Raises:
+            TypeError:
+                If ``out`` is not a NumPy array or its dtype does not match.
+            ValueError:
+                If ``coords`` or the shape of ``out`` do not match the array,
+                or the object is not open for reading.
+
+        Lifecycle:
+            Experimental.
+        """
+        self._check_open_read()
+        _util.check_type("out", out, (np.ndarray,))
+        if not (out.flags.c_contiguous or out.flags.f_contiguous):
+            raise ValueError("read_into requires a C- or Fortran-contiguous array")
+
+        handle: clib.SOMADenseNDArray = self._handle._handle
+        shape = handle.shape
+        if len(coords) != len(shape):
+            raise ValueError(
+                f"read_into expects one coordinate per dimension ({len(shape)}), "
+                f"got {len(coords)}"
+            )
+        ranges: List[Tuple[int, int]] = []
+        for dim_idx, coord in enumerate(coords):
+            if isinstance(coord, slice):
+                if coord.step not in (None, 1):
+                    raise ValueError("read_into slices must have a step of 1")
+                start = 0 if coord.start is None else coord.start
+                stop = shape[dim_idx] - 1 if coord.stop is None else coord.stop
+            elif isinstance(coord, (int, np.integer)):
+                start = stop = int(coord)
+            else:
+                raise TypeError(
+                    f"read_into coordinates must be ints or slices, got {type(coord)}"
+                )
+            if start < 0 or stop < start or stop >= shape[dim_idx]:
+                raise ValueError(
+                    f"read_into coordinate {coord} is out of the bounds of "
+                    f"dimension {dim_idx} with shape {shape[dim_idx]}"
+                )
+            ranges.append((int(start), int(stop)))
+
+        handle.read_into(ranges, out)
+        return out
+
     def write(
         self,
         coords: options.DenseNDCoords,
@@ -401,18 +401,41 @@ class BlockwiseScipyReadIter(BlockwiseReadIterBase[BlockwiseScipyReadIterResult]
         """Private. Compressed sparse variants"""
         assert self.compress
         assert self.major_axis not in self.reindex_disable_on_axis
-        for ((i, j), d), indices in self._maybe_eager_iterator(
-            self._sorted_tbl_reader(_pool), _pool
+        yield from self._maybe_eager_iterator(self._compressed_reader(), _pool)
+
+    def _compressed_reader(
+        self,
+    ) -> Iterator[Tuple[Union[sparse.csr_matrix, sparse.csc_matrix], IndicesType],]:
+        """Private. Read each block straight into CSR/CSC buffers, which are
+        reindexed and sorted in C++ and wrapped by scipy without a copy"""
+        kwargs: Dict[str, object] = {"result_order": self.sr.result_order}
+        cls = sparse.csr_matrix if self.major_axis == 0 else sparse.csc_matrix
+        minor_indexer = self.minor_axes_indexer.get(self.minor_axis)
+        for coord_chunk in _coords_strider(
+            self.coords[self.major_axis],
+            self.sr.shape[self.major_axis],
+            self.size[0],
         ):
-            major_coords = indices[self.major_axis]
-            minor_coords = indices[self.minor_axis]
-            cls = sparse.csr_matrix if self.major_axis == 0 else sparse.csc_matrix
-            sp = cls(
-                sparse.coo_matrix(
-                    (d, (i, j)), shape=self._mk_shape(major_coords, minor_coords)
-                )
+            self.sr.reset(**kwargs)
+            step_coords = list(self.coords)
+            step_coords[self.major_axis] = coord_chunk
+            self.array._set_reader_coords(self.sr, step_coords)
+
+            joinids = list(self.joinids)
+            joinids[self.major_axis] = pa.array(coord_chunk)
+            shape = self._mk_shape(coord_chunk, joinids[self.minor_axis])
+            major_indexer = IntIndexer(coord_chunk, context=self.context)
+            matrix = self.sr.read_compressed_matrix(
+                f"soma_dim_{self.major_axis}",
+                f"soma_dim_{self.minor_axis}",
+                "soma_data",
+                shape[self.major_axis],
+                shape[self.minor_axis],
+                major_indexer._reindexer,
+                None if minor_indexer is None else minor_indexer._reindexer,
             )
-            yield sp, indices
+            sp = cls((matrix.data, matrix.indices, matrix.indptr), shape=shape)
+            yield sp, (joinids[0].to_numpy(), joinids[1].to_numpy())
 
 
 class SparseTensorReadIterBase(somacore.ReadIter[_RT], metaclass=abc.ABCMeta):
@@ -456,6 +479,36 @@ class SparseCOOTensorReadIter(SparseTensorReadIterBase[pa.SparseCOOTensor]):
         ).T
         return pa.SparseCOOTensor.from_numpy(coo_data, coo_coords, shape=self.shape)
 
+    def _read_coo_tensor(self, concat: bool) -> Optional[pa.SparseCOOTensor]:
+        """Private. Read the coordinates straight into the interleaved layout
+        of a COO tensor in C++, and wrap them and the values without a copy"""
+        dims = [f"soma_dim_{n}" for n in range(len(self.shape))]
+        if concat:
+            tensor = self.sr.read_coo_tensor(dims, "soma_data")
+        else:
+            tensor = self.sr.read_next_coo_tensor(dims, "soma_data")
+            if tensor is None:
+                return None
+        return pa.SparseCOOTensor.from_numpy(
+            tensor.data, tensor.coords, shape=self.shape
+        )
+
+    def __next__(self) -> pa.SparseCOOTensor:
+        tensor = self._read_coo_tensor(concat=False)
+        if tensor is None:
+            raise StopIteration
+        return tensor
+
+    def concat(self) -> pa.SparseCOOTensor:
+        """Returns all the requested data in a single operation.
+
+        If some data has already been retrieved using ``next``, this will return
+        the rest of the data after that is already returned.
+        """
+        tensor = self._read_coo_tensor(concat=True)
+        assert tensor is not None
+        return tensor
+
 
 def _arrow_table_reader(sr: clib.SOMAArray) -> Iterator[pa.Table]:
     """Private. Simple Table iterator on any Array"""
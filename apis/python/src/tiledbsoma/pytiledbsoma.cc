@@ -63,6 +63,42 @@ PYBIND11_MODULE(pytiledbsoma, m) {
         .value("absolute", URIType::absolute)
         .value("relative", URIType::relative);
 
+    py::enum_<AggregateOp>(m, "AggregateOp")
+        .value("count", AggregateOp::count)
+        .value("sum", AggregateOp::sum)
+        .value("mean", AggregateOp::mean)
+        .value("min", AggregateOp::min)
+        .value("max", AggregateOp::max);
+
+    py::enum_<ScanOrder>(m, "ScanOrder")
+        .value("arbitrary", ScanOrder::arbitrary)
+        .value("range", ScanOrder::range);
+
+    py::enum_<Projection>(m, "Projection")
+        .value("all", Projection::all)
+        .value("values", Projection::values)
+        .value("coordinates", Projection::coordinates)
+        .value("count", Projection::count);
+
+    py::enum_<StringLayout>(m, "StringLayout")
+        .value("large", StringLayout::large)
+        .value("compact", StringLayout::compact)
+        .value("view", StringLayout::view);
+
+    py::enum_<CompareOp>(m, "CompareOp")
+        .value("eq", CompareOp::eq)
+        .value("ne", CompareOp::ne)
+        .value("lt", CompareOp::lt)
+        .value("le", CompareOp::le)
+        .value("gt", CompareOp::gt)
+        .value("ge", CompareOp::ge);
+
+    py::enum_<ArithmeticOp>(m, "ArithmeticOp")
+        .value("add", ArithmeticOp::add)
+        .value("sub", ArithmeticOp::sub)
+        .value("mul", ArithmeticOp::mul)
+        .value("div", ArithmeticOp::div);
+
     m.doc() = "SOMA acceleration library";
 
     m.def("version", []() { return tiledbsoma::version::as_string(); });
@@ -30,6 +30,7 @@
  * This file defines the SOMAArray bindings.
  */
 
+#include <tiledbsoma/reindexer/reindexer.h>
 #include "common.h"
 
 #define DENUM(x) .value(#x, TILEDB_##x)
@@ -82,7 +83,121 @@ void write_coords(
     }
 }
 
+/***
+ * Return a numpy array viewing a buffer of a CompressedMatrix or COOTensor,
+ * which the array keeps alive through its base object
+ * @param owner Python object owning the buffer
+ * @param buffer Buffer bytes
+ * @param type Element type
+ * @return numpy array
+ */
+py::array buffer_view(
+    py::object owner, tcb::span<std::byte> buffer, tiledb_datatype_t type) {
+    auto dtype = tdb_to_np_dtype(type, 1);
+    py::ssize_t size = buffer.size() / dtype.itemsize();
+    return py::array(dtype, {size}, {}, buffer.data(), owner);
+}
+
 void load_soma_array(py::module& m) {
+    py::class_<PartitionedScan>(m, "PartitionedScan")
+        .def(
+            "read_next",
+            [](PartitionedScan& scan) -> std::optional<py::object> {
+                py::gil_scoped_release release;
+                auto buffers = scan.read_next();
+                if (buffers.has_value()) {
+                    py::gil_scoped_acquire acquire;
+                    return to_table(*buffers);
+                }
+                return std::nullopt;
+            })
+        .def_property_readonly("partitions", &PartitionedScan::partitions);
+
+    // The buffers are exposed as numpy arrays without copying, in the
+    // layout expected by scipy.sparse.csr_matrix and csc_matrix
+    py::class_<CompressedMatrix, std::shared_ptr<CompressedMatrix>>(
+        m, "CompressedMatrix")
+        .def_property_readonly(
+            "shape",
+            [](CompressedMatrix& matrix) {
+                return std::make_pair(matrix.n_major(), matrix.n_minor());
+            })
+        .def_property_readonly("nnz", &CompressedMatrix::nnz)
+        .def_property_readonly(
+            "indptr",
+            [](py::object self) {
+                auto& matrix = self.cast<CompressedMatrix&>();
+                return buffer_view(self, matrix.indptr(), matrix.index_type());
+            })
+        .def_property_readonly(
+            "indices",
+            [](py::object self) {
+                auto& matrix = self.cast<CompressedMatrix&>();
+                return buffer_view(self, matrix.indices(), matrix.index_type());
+            })
+        .def_property_readonly("data", [](py::object self) {
+            auto& matrix = self.cast<CompressedMatrix&>();
+            return buffer_view(self, matrix.data(), matrix.data_type());
+        });
+
+    // The coordinates and values are exposed as numpy arrays without
+    // copying, in the layout expected by pyarrow.SparseCOOTensor.from_numpy
+    py::class_<COOTensor, std::shared_ptr<COOTensor>>(m, "COOTensor")
+        .def_property_readonly("nnz", &COOTensor::nnz)
+        .def_property_readonly("ndim", &COOTensor::ndim)
+        .def_property_readonly(
+            "coords",
+            [](py::object self) {
+                auto& tensor = self.cast<COOTensor&>();
+                py::ssize_t nnz = tensor.nnz();
+                py::ssize_t ndim = tensor.ndim();
+                return py::array_t<int64_t>(
+                    {nnz, ndim}, tensor.coords().data(), self);
+            })
+        .def_property_readonly("data", [](py::object self) {
+            auto& tensor = self.cast<COOTensor&>();
+            return buffer_view(self, tensor.data(), tensor.data_type());
+        });
+
+    py::class_<ValueExpr, std::shared_ptr<ValueExpr>>(m, "ValueExpr")
+        .def_static("column", &ValueExpr::column, "name"_a)
+        // Integers are tried first, so that Python ints stay exact
+        .def_static(
+            "literal",
+            py::overload_cast<int64_t>(&ValueExpr::literal),
+            "value"_a)
+        .def_static(
+            "literal",
+            py::overload_cast<uint64_t>(&ValueExpr::literal),
+            "value"_a)
+        .def_static(
+            "literal",
+            py::overload_cast<double>(&ValueExpr::literal),
+            "value"_a)
+        .def_static(
+            "arithmetic", &ValueExpr::arithmetic, "op"_a, "lhs"_a, "rhs"_a);
+
+    py::class_<ValueFilter, std::shared_ptr<ValueFilter>>(m, "ValueFilter")
+        .def_static(
+            "compare", &ValueFilter::compare, "op"_a, "lhs"_a, "rhs"_a)
+        .def_static(
+            "in_set",
+            py::overload_cast<const std::string&, const std::vector<int64_t>&>(
+                &ValueFilter::in_set),
+            "column"_a,
+            "values"_a)
+        .def_static(
+            "in_set",
+            py::overload_cast<
+                const std::string&,
+                const std::vector<std::string>&>(&ValueFilter::in_set),
+            "column"_a,
+            "values"_a)
+        .def_static("all_of", &ValueFilter::all_of, "filters"_a)
+        .def_static("any_of", &ValueFilter::any_of, "filters"_a)
+        .def_static("negate", &ValueFilter::negate, "filter"_a)
+        .def("columns", &ValueFilter::columns);
+
     py::class_<SOMAArray, SOMAObject>(m, "SOMAArray")
         .def(
             py::init(
@@ -493,6 +608,71 @@ void load_soma_array(py::module& m) {
 
         .def("results_complete", &SOMAArray::results_complete)
 
+        .def("set_projection", &SOMAArray::set_projection, "projection"_a)
+
+        .def(
+            "set_value_filter",
+            &SOMAArray::set_value_filter,
+            "filter"_a = py::none())
+
+        .def("set_limit", &SOMAArray::set_limit, "limit"_a = py::none())
+
+        .def("set_string_layout", &SOMAArray::set_string_layout, "layout"_a)
+
+        .def(
+            "read_top_k",
+            [](SOMAArray& array,
+               const std::string& column,
+               uint64_t k,
+               bool largest) -> py::object {
+                std::shared_ptr<ArrayBuffers> buffers;
+                {
+                    py::gil_scoped_release release;
+                    buffers = array.read_top_k(column, k, largest);
+                }
+                return *to_table(buffers);
+            },
+            "column"_a,
+            "k"_a,
+            "largest"_a = true)
+
+        .def(
+            "read_compressed_matrix",
+            &SOMAArray::read_compressed_matrix,
+            py::call_guard<py::gil_scoped_release>(),
+            "major_dim"_a,
+            "minor_dim"_a,
+            "value_column"_a,
+            "n_major"_a,
+            "n_minor"_a,
+            "major_indexer"_a = py::none(),
+            "minor_indexer"_a = py::none())
+
+        .def(
+            "read_next_coo_tensor",
+            &SOMAArray::read_next_coo_tensor,
+            py::call_guard<py::gil_scoped_release>(),
+            "dims"_a,
+            "value_column"_a)
+
+        .def(
+            "read_coo_tensor",
+            &SOMAArray::read_coo_tensor,
+            py::call_guard<py::gil_scoped_release>(),
+            "dims"_a,
+            "value_column"_a)
+
+        .def(
+            "estimate_result_sizes",
+            [](SOMAArray& array) {
+                // Column name -> (number of cells, number of data bytes)
+                std::map<std::string, std::pair<uint64_t, uint64_t>> sizes;
+                for (auto& [name, estimate] : array.estimate_result_sizes()) {
+                    sizes[name] = {estimate.num_cells, estimate.data_bytes};
+                }
+                return sizes;
+            })
+
         .def(
             "read_next",
             [](SOMAArray& array) -> std::optional<py::object> {
@@ -514,10 +694,71 @@ void load_soma_array(py::module& m) {
                 return std::nullopt;
             })
 
+        .def(
+            "to_arrow_stream",
+            [](SOMAArray& array, bool prefetch) -> py::object {
+                // The reader moves the stream out of `stream` on import, and
+                // keeps the array alive (see keep_alive below) until it is
+                // released
+                ArrowArrayStream stream;
+                array.to_arrow_stream(&stream, prefetch);
+                auto pa = py::module::import("pyarrow");
+                auto reader_import = pa.attr("RecordBatchReader")
+                                         .attr("_import_from_c");
+                return reader_import((uintptr_t)(&stream));
+            },
+            "prefetch"_a = true,
+            py::keep_alive<0, 1>())
+
         .def("write", write)
 
+        .def(
+            "write_stream",
+            [](SOMAArray& array, py::handle py_reader, bool sort_coords) {
+                ArrowArrayStream stream;
+                py_reader.attr("_export_to_c")((uintptr_t)(&stream));
+
+                // Batches are cast and written without the GIL. A reader
+                // backed by Python objects acquires it as needed.
+                py::gil_scoped_release release;
+                return array.write_stream(&stream, sort_coords);
+            },
+            "reader"_a,
+            "sort_coords"_a = true)
+
         .def("write_coords", write_coords)
 
+        .def(
+            "aggregate",
+            [](SOMAArray& array,
+               const std::string& column,
+               AggregateOp op,
+               std::optional<std::string> group_by) -> py::object {
+                std::shared_ptr<ArrayBuffers> buffers;
+                {
+                    py::gil_scoped_release release;
+                    buffers = array.aggregate(column, op, group_by);
+                }
+                return *to_table(buffers);
+            },
+            "column"_a,
+            "op"_a,
+            "group_by"_a = py::none())
+
+        .def(
+            "partitioned_scan",
+            &SOMAArray::partitioned_scan,
+            "num_partitions"_a,
+            "order"_a = ScanOrder::arbitrary,
+            "max_queued_batches"_a = 0,
+            py::call_guard<py::gil_scoped_release>())
+
+        .def(
+            "set_dim_indexer",
+            &SOMAArray::set_dim_indexer,
+            "dim"_a,
+            "indexer"_a.none(true))
+
         .def("nnz", &SOMAArray::nnz, py::call_guard<py::gil_scoped_release>())
 
         .def_property_readonly("shape", &SOMAArray::shape)
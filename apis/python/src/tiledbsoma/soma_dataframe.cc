@@ -147,6 +147,21 @@ void load_soma_dataframe(py::module& m) {
         .def_property_readonly(
             "count",
             &SOMADataFrame::count,
-            py::call_guard<py::gil_scoped_release>());
+            py::call_guard<py::gil_scoped_release>())
+        .def(
+            "read_late_materialized",
+            [](SOMADataFrame& sdf, std::vector<std::string> column_names) {
+                std::vector<std::shared_ptr<ArrayBuffers>> batches;
+                {
+                    py::gil_scoped_release release;
+                    batches = sdf.read_late_materialized(column_names);
+                }
+                py::list tables;
+                for (auto& batch : batches) {
+                    tables.append(*to_table(batch));
+                }
+                return tables;
+            },
+            "column_names"_a = std::vector<std::string>());
 }
 }  // namespace libtiledbsomacpp
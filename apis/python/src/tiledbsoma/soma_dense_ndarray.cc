@@ -124,6 +124,51 @@ void load_soma_dense_ndarray(py::module& m) {
 
         .def_static("exists", &SOMADenseNDArray::exists)
 
-        .def("write", write);
+        .def("write", write)
+
+        .def(
+            "read_into",
+            [](SOMADenseNDArray& array,
+               std::vector<std::pair<int64_t, int64_t>> ranges,
+               py::array out) {
+                if (!out.writeable()) {
+                    throw py::value_error("Output array is not writeable");
+                }
+                // Buffers of another type with the same item size would have
+                // the bits of the values reinterpreted
+                auto dtype = tdb_to_np_dtype(
+                    array.tiledb_schema()->attribute("soma_data").type(), 1);
+                if (!out.dtype().equiv(dtype)) {
+                    throw py::type_error(
+                        "Output array dtype " +
+                        py::str(out.dtype()).cast<std::string>() +
+                        " does not match the soma_data dtype " +
+                        py::str(dtype).cast<std::string>());
+                }
+                if (static_cast<size_t>(out.ndim()) != ranges.size()) {
+                    throw py::value_error(
+                        "Output array must have one dimension per range");
+                }
+                for (size_t i = 0; i < ranges.size(); i++) {
+                    auto extent = ranges[i].second - ranges[i].first + 1;
+                    if (out.shape(i) != extent) {
+                        throw py::value_error(
+                            "Output array shape does not match the ranges");
+                    }
+                }
+                std::vector<int64_t> strides(
+                    out.strides(), out.strides() + out.ndim());
+                void* data = out.mutable_data();
+                uint64_t nbytes = out.nbytes();
+
+                py::gil_scoped_release release;
+                try {
+                    array.read_into(ranges, data, nbytes, strides);
+                } catch (const std::exception& e) {
+                    TPY_ERROR_LOC(e.what());
+                }
+            },
+            "ranges"_a,
+            "out"_a);
 }
 }  // namespace libtiledbsomacpp
@@ -36,6 +36,7 @@
 #include <pybind11/stl.h>
 #include <pybind11/stl_bind.h>
 
+#include <tiledbsoma/reindexer/reindexer.h>
 #include <tiledbsoma/tiledbsoma>
 
 #include "common.h"
@@ -110,6 +111,21 @@ void load_soma_sparse_ndarray(py::module& m) {
             "result_order"_a = ResultOrder::automatic,
             "timestamp"_a = py::none())
 
-        .def_static("exists", &SOMASparseNDArray::exists);
+        .def_static("exists", &SOMASparseNDArray::exists)
+
+        .def(
+            "reduce_by_dim",
+            [](SOMASparseNDArray& array,
+               const std::string& dim_name,
+               std::shared_ptr<IntIndexer> indexer) -> py::object {
+                std::shared_ptr<ArrayBuffers> buffers;
+                {
+                    py::gil_scoped_release release;
+                    buffers = array.reduce_by_dim(dim_name, indexer);
+                }
+                return *to_table(buffers);
+            },
+            "dim_name"_a,
+            "indexer"_a = py::none());
 }
 }  // namespace libtiledbsomacpp
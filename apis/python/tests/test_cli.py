@@ -0,0 +1,98 @@
+import os
+import shutil
+import subprocess
+
+import pyarrow as pa
+import pytest
+
+import tiledbsoma as soma
+
+# The tdbsoma CLI is built with libtiledbsoma, not with the Python package
+TDBSOMA = os.environ.get("TDBSOMA", shutil.which("tdbsoma"))
+
+pytestmark = pytest.mark.skipif(TDBSOMA is None, reason="tdbsoma is not built")
+
+
+def run(*args):
+    return subprocess.run([TDBSOMA, *args], capture_output=True, text=True)
+
+
+def require_arrow():
+    if "built without Arrow" in run("import", "-", "-").stderr:
+        pytest.skip("tdbsoma is built without Arrow C++")
+
+
+@pytest.fixture
+def dataframe_uri(tmp_path):
+    uri = (tmp_path / "sdf").as_posix()
+    schema = pa.schema(
+        [
+            ("soma_joinid", pa.int64()),
+            ("label", pa.dictionary(pa.int8(), pa.large_string())),
+        ]
+    )
+    soma.DataFrame.create(
+        uri, schema=schema, index_column_names=["soma_joinid"]
+    ).close()
+    return uri
+
+
+def test_import_dictionary_batches(tmp_path, dataframe_uri):
+    require_arrow()
+
+    # Every batch carries the same dictionary, which the first one adds to
+    # the enumeration of the array
+    labels = pa.array(["red", "green", "blue"])
+    schema = pa.schema(
+        [
+            ("soma_joinid", pa.int64()),
+            ("label", pa.dictionary(pa.int8(), pa.string())),
+        ]
+    )
+    input_path = (tmp_path / "input.arrows").as_posix()
+    expected = []
+    with pa.ipc.new_stream(input_path, schema) as writer:
+        for batch in range(4):
+            joinids = list(range(batch * 5, batch * 5 + 5))
+            indexes = [(batch + i) % 3 for i in range(5)]
+            label = pa.DictionaryArray.from_arrays(
+                pa.array(indexes, pa.int8()), labels
+            )
+            writer.write_batch(
+                pa.record_batch([pa.array(joinids, pa.int64()), label], schema)
+            )
+            expected += [labels[i].as_py() for i in indexes]
+
+    result = run("import", input_path, dataframe_uri)
+    assert result.returncode == 0, result.stderr
+    assert "Imported 20 rows" in result.stdout
+
+    with soma.DataFrame.open(dataframe_uri) as sdf:
+        table = sdf.read().concat().sort_by("soma_joinid")
+    assert table["soma_joinid"].to_pylist() == list(range(20))
+    assert table["label"].to_pylist() == expected
+    dictionary = table["label"].combine_chunks().dictionary.to_pylist()
+    assert sorted(dictionary) == ["blue", "green", "red"]
+
+
+def test_errors_go_to_stderr(tmp_path, dataframe_uri):
+    require_arrow()
+
+    missing = (tmp_path / "missing.arrows").as_posix()
+    result = run("import", missing, dataframe_uri)
+    assert result.returncode == 1
+    assert result.stdout == ""
+    assert missing in result.stderr
+
+    result = run("export", dataframe_uri)
+    assert result.returncode == 1
+    assert result.stdout == ""
+    assert "expects an array URI and an output path" in result.stderr
+
+    result = run()
+    assert result.returncode == 1
+    assert "Usage" in result.stderr
+
+    result = run("--help")
+    assert result.returncode == 0
+    assert "Usage" in result.stdout
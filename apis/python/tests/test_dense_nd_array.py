@@ -62,6 +62,53 @@ def test_dense_nd_array_create_ok(
         assert isinstance(A._handle._handle, soma.pytiledbsoma.SOMADenseNDArray)
 
 
+def test_dense_nd_array_read_into(tmp_path):
+    uri = tmp_path.as_posix()
+    soma.DenseNDArray.create(uri, type=pa.int32(), shape=(4,))
+    with soma.DenseNDArray.open(uri, "w") as A:
+        A.write((slice(0, 3),), pa.Tensor.from_numpy(np.arange(4, dtype=np.int32)))
+
+    with soma.DenseNDArray.open(uri) as A:
+        out = np.zeros(4, dtype=np.int32)
+        assert A.read_into((slice(0, 3),), out) is out
+        assert out.tolist() == [0, 1, 2, 3]
+
+        out = np.zeros(4, dtype=np.int32)
+        A.read_into((slice(None),), out)
+        assert out.tolist() == [0, 1, 2, 3]
+
+        out = np.zeros(2, dtype=np.int32)
+        A.read_into((slice(1, 2),), out)
+        assert out.tolist() == [1, 2]
+
+        out = np.zeros(1, dtype=np.int32)
+        A.read_into((3,), out)
+        assert out.tolist() == [3]
+
+        # Same item size, different type: the bits must not be reinterpreted
+        with pytest.raises(TypeError):
+            A.read_into((slice(0, 3),), np.zeros(4, dtype=np.float32))
+        with pytest.raises(TypeError):
+            A.read_into((slice(0, 3),), np.zeros(4, dtype=np.uint32))
+
+        with pytest.raises(TypeError):
+            A.read_into((slice(0, 3),), [0, 0, 0, 0])
+        with pytest.raises(ValueError):
+            A.read_into((slice(0, 3), slice(0, 3)), np.zeros(4, dtype=np.int32))
+        with pytest.raises(ValueError):
+            A.read_into((slice(0, 4),), np.zeros(5, dtype=np.int32))
+        with pytest.raises(ValueError):
+            A.read_into((slice(0, 3, 2),), np.zeros(2, dtype=np.int32))
+        with pytest.raises(ValueError):
+            A.read_into((slice(0, 3),), np.zeros(3, dtype=np.int32))
+        with pytest.raises(ValueError):
+            A.read_into((slice(0, 3),), np.zeros(4, dtype=np.int32)[::-1])
+
+    with soma.DenseNDArray.open(uri, "w") as A:
+        with pytest.raises(ValueError):
+            A.read_into((slice(0, 3),), np.zeros(4, dtype=np.int32))
+
+
 def test_dense_nd_array_reopen(tmp_path):
     soma.DenseNDArray.create(
         tmp_path.as_posix(), type=pa.float64(), shape=(1,), tiledb_timestamp=1
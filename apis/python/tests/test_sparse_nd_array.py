@@ -16,6 +16,7 @@ import pytest
 import scipy.sparse as sparse
 
 import tiledbsoma as soma
+import tiledbsoma.pytiledbsoma as clib
 from tiledbsoma import _factory
 from tiledbsoma.options import SOMATileDBContext
 import tiledb
@@ -1871,3 +1872,115 @@ def test_global_writes(tmp_path):
                 data,
                 platform_config=soma.TileDBCreateOptions(),
             )
+
+
+@pytest.fixture
+def coo_array(tmp_path):
+    """A 6x5 matrix where row 0 holds 1, 2, 3 and row 5 holds 10."""
+    uri = (tmp_path / "coo").as_posix()
+    soma.SparseNDArray.create(uri, type=pa.int32(), shape=(6, 5)).close()
+    with soma.SparseNDArray.open(uri, "w") as A:
+        A.write(
+            pa.Table.from_pydict(
+                {
+                    "soma_dim_0": pa.array([0, 0, 0, 5], type=pa.int64()),
+                    "soma_dim_1": pa.array([1, 2, 3, 4], type=pa.int64()),
+                    "soma_data": pa.array([1, 2, 3, 10], type=pa.int32()),
+                }
+            )
+        )
+    return uri
+
+
+def open_clib(uri, mode=clib.OpenMode.read, config=None):
+    context = clib.SOMAContext(config or {})
+    return contextlib.closing(clib.SOMASparseNDArray.open(uri, mode, context))
+
+
+def test_aggregate(coo_array):
+    with open_clib(coo_array) as handle:
+        total = handle.aggregate("soma_data", clib.AggregateOp.sum)
+        assert total["sum"].to_pylist() == [16]
+
+        handle.reset()
+        by_row = handle.aggregate("soma_data", clib.AggregateOp.count, "soma_dim_0")
+        assert by_row["soma_dim_0"].to_pylist() == [0, 5]
+        assert by_row["count"].to_pylist() == [3, 1]
+
+        handle.reset()
+        with pytest.raises(soma.SOMAError):
+            handle.aggregate("soma_data", clib.AggregateOp.sum, "nonesuch")
+
+
+def test_to_arrow_stream(coo_array):
+    # Small buffers, so the stream returns several batches
+    config = {"soma.init_buffer_bytes": "16"}
+    with open_clib(coo_array, config=config) as handle:
+        handle.reset(result_order=clib.ResultOrder.rowmajor)
+        reader = handle.to_arrow_stream()
+        assert reader.schema.names == ["soma_dim_0", "soma_dim_1", "soma_data"]
+        batches = list(reader)
+        assert len(batches) > 1
+        table = pa.Table.from_batches(batches)
+        assert table["soma_dim_0"].to_pylist() == [0, 0, 0, 5]
+        assert table["soma_data"].to_pylist() == [1, 2, 3, 10]
+
+
+def test_write_stream(tmp_path, coo_array):
+    uri = (tmp_path / "copy").as_posix()
+    soma.SparseNDArray.create(uri, type=pa.int32(), shape=(6, 5)).close()
+
+    config = {"soma.init_buffer_bytes": "16"}
+    with open_clib(coo_array, config=config) as src, open_clib(
+        uri, clib.OpenMode.write
+    ) as dst:
+        assert dst.write_stream(src.to_arrow_stream()) == 4
+
+    with soma.SparseNDArray.open(coo_array) as A, soma.SparseNDArray.open(uri) as B:
+        assert B.read().tables().concat() == A.read().tables().concat()
+
+    # Columns that are not in the array are rejected before any write
+    reader = pa.RecordBatchReader.from_batches(
+        pa.schema([("nonesuch", pa.int64())]), []
+    )
+    with open_clib(uri, clib.OpenMode.write) as dst:
+        with pytest.raises(soma.SOMAError):
+            dst.write_stream(reader)
+
+
+def test_value_filter(coo_array):
+    # soma_data * 2 > soma_dim_1 + 1
+    arithmetic = clib.ValueFilter.compare(
+        clib.CompareOp.gt,
+        clib.ValueExpr.arithmetic(
+            clib.ArithmeticOp.mul,
+            clib.ValueExpr.column("soma_data"),
+            clib.ValueExpr.literal(2),
+        ),
+        clib.ValueExpr.arithmetic(
+            clib.ArithmeticOp.add,
+            clib.ValueExpr.column("soma_dim_1"),
+            clib.ValueExpr.literal(1),
+        ),
+    )
+    assert sorted(arithmetic.columns()) == ["soma_data", "soma_dim_1"]
+
+    with open_clib(coo_array) as handle:
+        handle.reset(result_order=clib.ResultOrder.rowmajor)
+        handle.set_value_filter(arithmetic)
+        table = handle.to_arrow_stream().read_all()
+        assert table["soma_data"].to_pylist() == [2, 3, 10]
+
+        # The filtered columns are read without being selected
+        handle.reset(column_names=["soma_dim_0"])
+        handle.set_value_filter(
+            clib.ValueFilter.any_of(
+                [
+                    clib.ValueFilter.in_set("soma_dim_1", [2, 4]),
+                    clib.ValueFilter.negate(arithmetic),
+                ]
+            )
+        )
+        table = handle.to_arrow_stream().read_all()
+        assert table.schema.names == ["soma_dim_0"]
+        assert sorted(table["soma_dim_0"].to_pylist()) == [0, 0, 5]
@@ -334,6 +334,24 @@ BEGIN_RCPP
     return R_NilValue;
 END_RCPP
 }
+// sr_read_csx
+Rcpp::List sr_read_csx(Rcpp::XPtr<tdbs::SOMAArray> sr, const std::string& major_dim, const std::string& minor_dim, const std::string& value_column, double n_major, double n_minor, Rcpp::Nullable<Rcpp::XPtr<tdbs::IntIndexer>> major_idx, Rcpp::Nullable<Rcpp::XPtr<tdbs::IntIndexer>> minor_idx);
+RcppExport SEXP _tiledbsoma_sr_read_csx(SEXP srSEXP, SEXP major_dimSEXP, SEXP minor_dimSEXP, SEXP value_columnSEXP, SEXP n_majorSEXP, SEXP n_minorSEXP, SEXP major_idxSEXP, SEXP minor_idxSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::XPtr<tdbs::SOMAArray> >::type sr(srSEXP);
+    Rcpp::traits::input_parameter< const std::string& >::type major_dim(major_dimSEXP);
+    Rcpp::traits::input_parameter< const std::string& >::type minor_dim(minor_dimSEXP);
+    Rcpp::traits::input_parameter< const std::string& >::type value_column(value_columnSEXP);
+    Rcpp::traits::input_parameter< double >::type n_major(n_majorSEXP);
+    Rcpp::traits::input_parameter< double >::type n_minor(n_minorSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable<Rcpp::XPtr<tdbs::IntIndexer>> >::type major_idx(major_idxSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable<Rcpp::XPtr<tdbs::IntIndexer>> >::type minor_idx(minor_idxSEXP);
+    rcpp_result_gen = Rcpp::wrap(sr_read_csx(sr, major_dim, minor_dim, value_column, n_major, n_minor, major_idx, minor_idx));
+    return rcpp_result_gen;
+END_RCPP
+}
 // tiledbsoma_stats_enable
 void tiledbsoma_stats_enable();
 RcppExport SEXP _tiledbsoma_tiledbsoma_stats_enable() {
@@ -455,6 +473,7 @@ static const R_CallMethodDef CallEntries[] = {
     {"_tiledbsoma_sr_next", (DL_FUNC) &_tiledbsoma_sr_next, 1},
     {"_tiledbsoma_sr_reset", (DL_FUNC) &_tiledbsoma_sr_reset, 1},
     {"_tiledbsoma_sr_set_dim_points", (DL_FUNC) &_tiledbsoma_sr_set_dim_points, 3},
+    {"_tiledbsoma_sr_read_csx", (DL_FUNC) &_tiledbsoma_sr_read_csx, 8},
     {"_tiledbsoma_tiledbsoma_stats_enable", (DL_FUNC) &_tiledbsoma_tiledbsoma_stats_enable, 0},
     {"_tiledbsoma_tiledbsoma_stats_disable", (DL_FUNC) &_tiledbsoma_tiledbsoma_stats_disable, 0},
     {"_tiledbsoma_tiledbsoma_stats_reset", (DL_FUNC) &_tiledbsoma_tiledbsoma_stats_reset, 0},
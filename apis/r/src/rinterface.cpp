@@ -125,54 +125,26 @@ SEXP soma_array_reader(const std::string& uri,
         apply_dim_ranges(sr.get(), name2dim, lst);
     }
 
-    // Getting next batch:  std::optional<std::shared_ptr<ArrayBuffers>>
-    auto sr_data = sr->read_next();
+    // Getting next batch as a struct array with its schema:
+    // std::optional<ArrowTable>
+    auto batch = sr->read_next_arrow();
     if (!sr->results_complete()) {
         Rcpp::stop("Read of '%s' is incomplete.\nConsider increasing the memory "
                    "allocation via the configuration\noption 'soma.init_buffer_bytes', "
                    "or using iterated partial reads.", uri);
     }
     spdl::info("[soma_array_reader] Read complete with {} rows and {} cols",
-               sr_data->get()->num_rows(), sr_data->get()->names().size());
+               batch->first->length, batch->first->n_children);
 
-    const std::vector<std::string> names = sr_data->get()->names();
-    auto ncol = names.size();
     // Schema first
     auto schemaxp = nanoarrow_schema_owning_xptr();
     auto sch = nanoarrow_output_schema_from_xptr(schemaxp);
-    exitIfError(ArrowSchemaInitFromType(sch, NANOARROW_TYPE_STRUCT), "Bad schema init");
-    exitIfError(ArrowSchemaSetName(sch, ""), "Bad schema name");
-    exitIfError(ArrowSchemaAllocateChildren(sch, ncol), "Bad schema children alloc");
+    ArrowSchemaMove(batch->second.get(), sch);
 
     // Array second
     auto arrayxp = nanoarrow_array_owning_xptr();
     auto arr = nanoarrow_output_array_from_xptr(arrayxp);
-    exitIfError(ArrowArrayInitFromType(arr, NANOARROW_TYPE_STRUCT), "Bad array init");
-    exitIfError(ArrowArrayAllocateChildren(arr, ncol), "Bad array children alloc");
-
-    arr->length = 0;             // initial value
-    for (size_t i=0; i<ncol; i++) {
-        spdl::info("[soma_array_reader] Accessing '{}' at pos {}", names[i], i);
-
-        // now buf is a shared_ptr to ColumnBuffer
-        auto buf = sr_data->get()->at(names[i]);
-
-        // this is pair of array and schema pointer
-        auto pp = tdbs::ArrowAdapter::to_arrow(buf);
-
-        //memcpy((void*) sch->children[i], pp.second.get(), sizeof(ArrowSchema));
-        //memcpy((void*) arr->children[i], pp.first.get(), sizeof(ArrowArray));
-        ArrowArrayMove(pp.first.get(),  arr->children[i]);
-        ArrowSchemaMove(pp.second.get(), sch->children[i]);
-
-        spdl::info("[soma_array_reader] Incoming name {} length {}",
-                   std::string(pp.second->name), pp.first->length);
-
-        if (pp.first->length > arr->length) {
-            spdl::debug("[soma_array_reader] Setting array length to {}", pp.first->length);
-            arr->length = pp.first->length;
-        }
-    }
+    ArrowArrayMove(batch->first.get(), arr);
 
    // Nanoarrow special: stick schema into xptr tag to return single SEXP
    array_xptr_set_schema(arrayxp, schemaxp); 			// embed schema in array
@@ -7,6 +7,7 @@
 #include <nanoarrow/r.h>                 // for C interface to Arrow (via R package nanoarrow)
 #include <nanoarrow/nanoarrow.h>
 #include <RcppInt64>                    // for fromInteger64
+#include <cstring>
 
 #include <tiledb/tiledb>
 #if TILEDB_VERSION_MAJOR == 2 && TILEDB_VERSION_MINOR >= 4
@@ -14,6 +15,7 @@
 #endif
 #include <tiledbsoma/tiledbsoma>
 #include <tiledbsoma/reindexer/reindexer.h>
+#include <tiledbsoma/utils/util.h>
 
 #include "rutilities.h"         // local declarations
 #include "xptr-utils.h"         // xptr taggging utilitie
@@ -198,44 +200,25 @@ SEXP sr_next(Rcpp::XPtr<tdbs::SOMAArray> sr) {
        return create_empty_arrow_table();
    }
 
-   auto sr_data = sr->read_next();
+   // The batch comes as a struct array with a copy of its schema, which the
+   // exporter builds once rather than per batch
+   auto batch = sr->read_next_arrow();
+   if (!batch) {
+       spdl::trace("[sr_next] no further batch");
+       return create_empty_arrow_table();
+   }
    spdl::debug("[sr_next] Read {} rows and {} cols",
-               sr_data->get()->num_rows(), sr_data->get()->names().size());
+               batch->first->length, batch->first->n_children);
 
-   const std::vector<std::string> names = sr_data->get()->names();
-   auto ncol = names.size();
    // Schema first
    auto schemaxp = nanoarrow_schema_owning_xptr();
    auto sch = nanoarrow_output_schema_from_xptr(schemaxp);
-   exitIfError(ArrowSchemaInitFromType(sch, NANOARROW_TYPE_STRUCT), "Bad schema init");
-   exitIfError(ArrowSchemaSetName(sch, ""), "Bad schema name");
-   exitIfError(ArrowSchemaAllocateChildren(sch, ncol), "Bad schema children alloc");
+   ArrowSchemaMove(batch->second.get(), sch);
 
    // Array second
    auto arrayxp = nanoarrow_array_owning_xptr();
    auto arr = nanoarrow_output_array_from_xptr(arrayxp);
-   exitIfError(ArrowArrayInitFromType(arr, NANOARROW_TYPE_STRUCT), "Bad array init");
-   exitIfError(ArrowArrayAllocateChildren(arr, ncol), "Bad array children alloc");
-
-   arr->length = 0;             // initial value
-
-   for (size_t i=0; i<ncol; i++) {
-       spdl::trace("[sr_next] Accessing {} at {}", names[i], i);
-
-       // now buf is a shared_ptr to ColumnBuffer
-       auto buf = sr_data->get()->at(names[i]);
-
-       // this is pair of array and schema pointer
-       auto pp = tdbs::ArrowAdapter::to_arrow(buf);
-
-       ArrowArrayMove(pp.first.get(),   arr->children[i]);
-       ArrowSchemaMove(pp.second.get(), sch->children[i]);
-
-       if (pp.first->length > arr->length) {
-           spdl::debug("[soma_array_reader] Setting array length to {}", pp.first->length);
-           arr->length = pp.first->length;
-       }
-   }
+   ArrowArrayMove(batch->first.get(), arr);
 
    spdl::debug("[sr_next] Exporting chunk with {} rows", arr->length);
    // Nanoarrow special: stick schema into xptr tag to return single SEXP
@@ -261,3 +244,64 @@ void sr_set_dim_points(Rcpp::XPtr<tdbs::SOMAArray> sr, std::string dim,
     spdl::debug("[sr_set_dim_points] Set on dim '{}' for {} points, first two are {} and {}",
                 dim, points.length(), vec[0], vec[1]);
 }
+
+//' Read the rest of a query into compressed sparse matrix components
+//'
+//' The matrix is built in C++ by a parallel counting sort on the major
+//' dimension, with coordinates optionally mapped through re-indexers. The
+//' components are those of a \code{dgCMatrix} when the major dimension gives
+//' the columns, or of a \code{dgRMatrix} when it gives the rows.
+//'
+//' @param sr An external pointer to a SOMAArray reset for reading
+//' @param major_dim,minor_dim Names of the major and minor dimensions
+//' @param value_column Name of the numeric value column
+//' @param n_major,n_minor Extents of the major and minor axes
+//' @param major_idx,minor_idx Optional external pointers to re-indexers
+//' @return A list with elements \code{p}, \code{i} and \code{x}
+//' @noRd
+// [[Rcpp::export]]
+Rcpp::List sr_read_csx(Rcpp::XPtr<tdbs::SOMAArray> sr,
+                       const std::string& major_dim,
+                       const std::string& minor_dim,
+                       const std::string& value_column,
+                       double n_major, double n_minor,
+                       Rcpp::Nullable<Rcpp::XPtr<tdbs::IntIndexer>> major_idx = R_NilValue,
+                       Rcpp::Nullable<Rcpp::XPtr<tdbs::IntIndexer>> minor_idx = R_NilValue) {
+    check_xptr_tag<tdbs::SOMAArray>(sr);
+
+    // The re-indexers stay owned by their R external pointers
+    auto borrow = [](Rcpp::Nullable<Rcpp::XPtr<tdbs::IntIndexer>> idx) {
+        std::shared_ptr<tdbs::IntIndexer> indexer;
+        if (idx.isNotNull()) {
+            Rcpp::XPtr<tdbs::IntIndexer> xp(idx);
+            check_xptr_tag<tdbs::IntIndexer>(xp);
+            indexer = std::shared_ptr<tdbs::IntIndexer>(xp.get(), [](tdbs::IntIndexer*) {});
+        }
+        return indexer;
+    };
+
+    auto matrix = sr->read_compressed_matrix(major_dim, minor_dim, value_column,
+                                             static_cast<uint64_t>(n_major),
+                                             static_cast<uint64_t>(n_minor),
+                                             borrow(major_idx), borrow(minor_idx));
+    if (matrix->index_type() != TILEDB_INT32) {
+        Rcpp::stop("Matrix with %.0f entries exceeds the range of R integer indices",
+                   static_cast<double>(matrix->nnz()));
+    }
+
+    // R owns its vectors, so the components are copied once, and the values
+    // are converted to double as Matrix expects
+    Rcpp::IntegerVector p(matrix->n_major() + 1), i(matrix->nnz());
+    std::memcpy(p.begin(), matrix->indptr().data(), matrix->indptr().size());
+    std::memcpy(i.begin(), matrix->indices().data(), matrix->indices().size());
+    Rcpp::NumericVector x(matrix->nnz());
+    tdbs::util::visit_numeric_type(matrix->data_type(), [&](auto value) {
+        using T = decltype(value);
+        auto data = reinterpret_cast<const T*>(matrix->data().data());
+        std::copy(data, data + matrix->nnz(), x.begin());
+    });
+    spdl::debug("[sr_read_csx] Read {} entries along '{}'", matrix->nnz(), major_dim);
+    return Rcpp::List::create(Rcpp::Named("p") = p,
+                              Rcpp::Named("i") = i,
+                              Rcpp::Named("x") = x);
+}
@@ -69,6 +69,7 @@ set(INHERITED_CMAKE_ARGS
   -DOVERRIDE_INSTALL_PREFIX=${OVERRIDE_INSTALL_PREFIX}
   -DTILEDBSOMA_BUILD_STATIC=${TILEDBSOMA_BUILD_STATIC}
   -DTILEDBSOMA_BUILD_CLI=${TILEDBSOMA_BUILD_CLI}
+  -DArrow_DIR=${Arrow_DIR}
   -DTILEDBSOMA_ENABLE_TESTING=${TILEDBSOMA_ENABLE_TESTING}
   -DCMAKE_OSX_ARCHITECTURES=${CMAKE_OSX_ARCHITECTURES}
 )
@@ -27,13 +27,44 @@
  *
  * @section DESCRIPTION
  *
- * This file is currently a sandbox for C++ API experiments
+ * This file defines the tiledbsoma CLI. The `export` subcommand streams the
+ * reads of a SOMA array to an Arrow IPC stream or Feather file, and the
+ * `import` subcommand writes Arrow IPC or Parquet files into a SOMA array.
+ * Run with a SOMA experiment URI instead, the CLI is a sandbox for C++ API
+ * experiments.
  */
 
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <optional>
+#include <set>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#ifdef TILEDBSOMA_CLI_ARROW
+#include <arrow/buffer.h>
+#include <arrow/c/bridge.h>
+#include <arrow/io/file.h>
+#include <arrow/ipc/reader.h>
+#include <arrow/ipc/writer.h>
+#include <arrow/record_batch.h>
+#include <arrow/util/compression.h>
+#include <arrow/util/iterator.h>
+#include <arrow/util/thread_pool.h>
+#endif
+
+#ifdef TILEDBSOMA_CLI_PARQUET
+#include <parquet/arrow/reader.h>
+#endif
+
 #include "soma/enums.h"
 #include "soma/soma_array.h"
 #include "utils/arrow_adapter.h"
 #include "utils/logger.h"
+#include "utils/util.h"
 
 using namespace tiledbsoma;
 
@@ -109,20 +140,665 @@ void test_arrow(const std::string& uri) {
     }
 }
 
-int main(int argc, char** argv) {
-    LOG_CONFIG("debug");
+//===================================================================
+//= Command-line arguments
+//===================================================================
 
-    if (argc < 2) {
-        printf("Run with CI test SOMA:\n\n");
-        printf("  %s test/soco/pbmc3k_processed\n", argv[0]);
+// Arguments of a subcommand: positional arguments, and the values of
+// `--name value` or `--name=value` options, which may repeat. Flags take no
+// value and are set to "true".
+struct Args {
+    std::vector<std::string> positional;
+    std::multimap<std::string, std::string> options;
+
+    // Value of an option, or `fallback` if not given. The last value wins.
+    std::string get(
+        const std::string& name, const std::string& fallback = "") const {
+        auto [first, last] = options.equal_range(name);
+        return first == last ? fallback : std::prev(last)->second;
+    }
+
+    // Values of a repeated option, in command-line order
+    std::vector<std::string> all(const std::string& name) const {
+        std::vector<std::string> values;
+        auto [first, last] = options.equal_range(name);
+        for (auto it = first; it != last; ++it) {
+            values.push_back(it->second);
+        }
+        return values;
+    }
+};
+
+Args parse_args(
+    int argc, char** argv, int first, const std::set<std::string>& flags = {}) {
+    Args args;
+    for (int i = first; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg.rfind("--", 0) != 0) {
+            args.positional.push_back(arg);
+            continue;
+        }
+        auto eq = arg.find('=');
+        if (flags.count(arg.substr(2)) > 0) {
+            args.options.emplace(arg.substr(2), "true");
+        } else if (eq != std::string::npos) {
+            args.options.emplace(arg.substr(2, eq - 2), arg.substr(eq + 1));
+        } else if (i + 1 < argc) {
+            args.options.emplace(arg.substr(2), argv[++i]);
+        } else {
+            throw TileDBSOMAError(
+                fmt::format("Option '{}' requires a value", arg));
+        }
+    }
+    return args;
+}
+
+// Split `text` at each `sep`
+std::vector<std::string> split(const std::string& text, char sep) {
+    std::vector<std::string> parts;
+    size_t start = 0;
+    while (true) {
+        auto end = text.find(sep, start);
+        parts.push_back(text.substr(start, end - start));
+        if (end == std::string::npos) {
+            return parts;
+        }
+        start = end + 1;
+    }
+}
+
+// Strip leading and trailing spaces, and the quotes around a value
+std::string trim(const std::string& text) {
+    auto start = text.find_first_not_of(' ');
+    if (start == std::string::npos) {
+        return "";
+    }
+    auto end = text.find_last_not_of(' ');
+    auto trimmed = text.substr(start, end - start + 1);
+    if (trimmed.size() >= 2 &&
+        (trimmed.front() == '\'' || trimmed.front() == '"') &&
+        trimmed.back() == trimmed.front()) {
+        return trimmed.substr(1, trimmed.size() - 2);
+    }
+    return trimmed;
+}
+
+// Parse the value of a column or option
+template <typename T>
+T parse_number(const std::string& name, const std::string& text) {
+    try {
+        size_t pos = 0;
+        T value;
+        if constexpr (std::is_floating_point_v<T>) {
+            value = static_cast<T>(std::stod(text, &pos));
+        } else if constexpr (std::is_signed_v<T>) {
+            value = static_cast<T>(std::stoll(text, &pos));
+        } else {
+            value = static_cast<T>(std::stoull(text, &pos));
+        }
+        if (pos == text.size()) {
+            return value;
+        }
+    } catch (const std::logic_error&) {
+    }
+    throw TileDBSOMAError(
+        fmt::format("Invalid value '{}' for '{}'", text, name));
+}
+
+// Parse the value of an option that must be positive if given, or return 0
+template <typename T>
+T parse_positive_option(const Args& args, const std::string& name) {
+    if (args.options.count(name) == 0) {
         return 0;
     }
+    auto text = args.get(name);
+    auto option = "--" + name;
+    auto value = parse_number<T>(option, text);
+    if (value <= 0) {
+        throw TileDBSOMAError(
+            fmt::format("Invalid value '{}' for '{}'", text, option));
+    }
+    return value;
+}
+
+// Context from the `--config key=value` options, e.g.
+// `--config soma.init_buffer_bytes=1073741824`, which override `config`
+std::shared_ptr<SOMAContext> make_context(
+    const Args& args, std::map<std::string, std::string> config = {}) {
+    for (auto& option : args.all("config")) {
+        auto eq = option.find('=');
+        if (eq == std::string::npos) {
+            throw TileDBSOMAError(fmt::format(
+                "Invalid config '{}', expected key=value", option));
+        }
+        config[option.substr(0, eq)] = option.substr(eq + 1);
+    }
+    return std::make_shared<SOMAContext>(config);
+}
+
+ResultOrder parse_result_order(const std::string& order) {
+    if (order == "auto") {
+        return ResultOrder::automatic;
+    } else if (order == "row-major") {
+        return ResultOrder::rowmajor;
+    } else if (order == "col-major") {
+        return ResultOrder::colmajor;
+    }
+    throw TileDBSOMAError(fmt::format(
+        "Invalid result order '{}', expected auto, row-major or col-major",
+        order));
+}
+
+//===================================================================
+//= export
+//===================================================================
+
+// Select the `--range dim=lo:hi` ranges, which may repeat for a dimension
+void apply_ranges(SOMAArray& array, const std::vector<std::string>& ranges) {
+    std::map<std::string, std::vector<std::pair<std::string, std::string>>>
+        dim_ranges;
+    for (auto& range : ranges) {
+        auto eq = range.find('=');
+        auto colon = range.find(':', eq);
+        if (eq == std::string::npos || colon == std::string::npos) {
+            throw TileDBSOMAError(fmt::format(
+                "Invalid range '{}', expected dim=lo:hi", range));
+        }
+        dim_ranges[trim(range.substr(0, eq))].emplace_back(
+            trim(range.substr(eq + 1, colon - eq - 1)),
+            trim(range.substr(colon + 1)));
+    }
+
+    auto domain = array.tiledb_schema()->domain();
+    for (auto& [dim, bounds] : dim_ranges) {
+        if (!domain.has_dimension(dim)) {
+            throw TileDBSOMAError(
+                fmt::format("Range on '{}', which is not a dimension", dim));
+        }
+        auto type = domain.dimension(dim).type();
+        if (type == TILEDB_STRING_ASCII || type == TILEDB_STRING_UTF8) {
+            array.set_dim_ranges(dim, bounds);
+            continue;
+        }
+        util::visit_numeric_type(type, [&](auto zero) {
+            using T = decltype(zero);
+            std::vector<std::pair<T, T>> typed;
+            for (auto& [lo, hi] : bounds) {
+                typed.emplace_back(
+                    parse_number<T>(dim, lo), parse_number<T>(dim, hi));
+            }
+            array.set_dim_ranges(dim, typed);
+        });
+    }
+}
+
+// Build the query condition of a `--where "column op value"` option, e.g.
+// `--where "n_genes >= 100"`. Enumerated columns compare their labels.
+QueryCondition parse_condition(
+    const Context& ctx, const ArraySchema& schema, const std::string& expr) {
+    using Op = std::pair<std::string, tiledb_query_condition_op_t>;
+    static const std::vector<Op> ops = {
+        {"==", TILEDB_EQ},
+        {"!=", TILEDB_NE},
+        {"<=", TILEDB_LE},
+        {">=", TILEDB_GE},
+        {"<", TILEDB_LT},
+        {">", TILEDB_GT}};
+
+    // The first operator in the expression, preferring two-character ones
+    size_t pos = std::string::npos;
+    std::string symbol;
+    tiledb_query_condition_op_t op = TILEDB_EQ;
+    for (auto& [candidate, candidate_op] : ops) {
+        auto found = expr.find(candidate);
+        if (found < pos) {
+            pos = found;
+            symbol = candidate;
+            op = candidate_op;
+        }
+    }
+    if (pos == std::string::npos) {
+        throw TileDBSOMAError(fmt::format(
+            "Invalid condition '{}', expected 'column op value'", expr));
+    }
+    auto column = trim(expr.substr(0, pos));
+    auto value = trim(expr.substr(pos + symbol.size()));
+
+    tiledb_datatype_t type;
+    bool enumerated = false;
+    if (schema.has_attribute(column)) {
+        auto attr = schema.attribute(column);
+        type = attr.type();
+        enumerated = AttributeExperimental::get_enumeration_name(ctx, attr)
+                         .has_value();
+    } else if (schema.domain().has_dimension(column)) {
+        type = schema.domain().dimension(column).type();
+    } else {
+        throw TileDBSOMAError(
+            fmt::format("Condition on unknown column '{}'", column));
+    }
+
+    if (enumerated || type == TILEDB_STRING_ASCII ||
+        type == TILEDB_STRING_UTF8 || type == TILEDB_CHAR) {
+        return QueryCondition::create(ctx, column, value, op);
+    }
+    if (type == TILEDB_BOOL) {
+        value = value == "true" ? "1" : value == "false" ? "0" : value;
+    }
+    return util::visit_numeric_type(type, [&](auto zero) {
+        using T = decltype(zero);
+        return QueryCondition::create<T>(
+            ctx, column, parse_number<T>(column, value), op);
+    });
+}
+
+#ifdef TILEDBSOMA_CLI_ARROW
+void check(const arrow::Status& status) {
+    if (!status.ok()) {
+        throw TileDBSOMAError(status.ToString());
+    }
+}
+
+template <typename T>
+T check(arrow::Result<T> result) {
+    check(result.status());
+    return result.MoveValueUnsafe();
+}
+#endif
+
+int export_command(const Args& args) {
+#ifndef TILEDBSOMA_CLI_ARROW
+    (void)args;
+    throw TileDBSOMAError(
+        "export is unavailable: tiledbsoma-cli was built without Arrow C++");
+#else
+    if (args.positional.size() != 2) {
+        throw TileDBSOMAError("export expects an array URI and an output path");
+    }
+    auto& uri = args.positional[0];
+    auto& output = args.positional[1];
+
+    // Feather files are Arrow IPC files, with a footer for random access
+    auto format = args.get("format");
+    if (format.empty()) {
+        auto feather = output.size() > 8 &&
+                       output.substr(output.size() - 8) == ".feather";
+        format = feather ? "file" : "stream";
+    }
+    if (format == "feather") {
+        format = "file";
+    }
+    if (format != "stream" && format != "file") {
+        throw TileDBSOMAError(fmt::format(
+            "Invalid format '{}', expected stream, file or feather", format));
+    }
+
+    std::vector<std::string> columns;
+    if (auto names = args.get("columns"); !names.empty()) {
+        columns = split(names, ',');
+    }
+
+    auto ctx = make_context(args);
+    auto array = SOMAArray::open(
+        OpenMode::read,
+        uri,
+        ctx,
+        "export",
+        columns,
+        "auto",
+        parse_result_order(args.get("result-order", "auto")));
+    apply_ranges(*array, args.all("range"));
+
+    std::optional<QueryCondition> condition;
+    for (auto& expr : args.all("where")) {
+        auto qc = parse_condition(
+            *ctx->tiledb_ctx(), *array->tiledb_schema(), expr);
+        condition = condition ? condition->combine(qc, TILEDB_AND) : qc;
+    }
+    if (condition) {
+        array->set_condition(*condition);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    // The record batches are read from the array stream, which reads the
+    // next batch while the current one is written
+    struct ArrowArrayStream stream;
+    array->to_arrow_stream(&stream);
+    auto reader = check(arrow::ImportRecordBatchReader(&stream));
+
+    auto options = arrow::ipc::IpcWriteOptions::Defaults();
+    auto compression = args.get("compression", "none");
+    if (compression == "lz4") {
+        options.codec = check(
+            arrow::util::Codec::Create(arrow::Compression::LZ4_FRAME));
+    } else if (compression == "zstd") {
+        options.codec = check(
+            arrow::util::Codec::Create(arrow::Compression::ZSTD));
+    } else if (compression != "none") {
+        throw TileDBSOMAError(fmt::format(
+            "Invalid compression '{}', expected none, lz4 or zstd",
+            compression));
+    }
+
+    auto sink = check(arrow::io::FileOutputStream::Open(output));
+    auto writer =
+        format == "file" ?
+            check(arrow::ipc::MakeFileWriter(sink, reader->schema(), options)) :
+            check(arrow::ipc::MakeStreamWriter(
+                sink, reader->schema(), options));
+
+    int64_t rows = 0;
+    int64_t batches = 0;
+    while (true) {
+        std::shared_ptr<arrow::RecordBatch> batch;
+        check(reader->ReadNext(&batch));
+        if (batch == nullptr) {
+            break;
+        }
+        check(writer->WriteRecordBatch(*batch));
+        rows += batch->num_rows();
+        batches++;
+    }
+    check(writer->Close());
+    auto bytes = check(sink->Tell());
+    check(sink->Close());
+    array->close();
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() -
+                                            start;
+    printf(
+        "Exported %lld rows in %lld batches to '%s': %lld bytes in %.3f s, "
+        "%.0f rows/s\n",
+        (long long)rows,
+        (long long)batches,
+        output.c_str(),
+        (long long)bytes,
+        elapsed.count(),
+        elapsed.count() > 0 ? rows / elapsed.count() : 0.0);
+    return 0;
+#endif
+}
+
+//===================================================================
+//= import
+//===================================================================
+
+#ifdef TILEDBSOMA_CLI_ARROW
+/**
+ * @brief Reads the batches of another reader regrouped into batches of
+ * `batch_size` rows, the last one possibly shorter. Input batches that fit
+ * are passed through; others are sliced or concatenated, which copies them.
+ */
+class RebatchReader : public arrow::RecordBatchReader {
+   public:
+    RebatchReader(
+        std::shared_ptr<arrow::RecordBatchReader> input, int64_t batch_size)
+        : input_(input)
+        , batch_size_(batch_size) {
+    }
+
+    std::shared_ptr<arrow::Schema> schema() const override {
+        return input_->schema();
+    }
+
+    arrow::Status ReadNext(std::shared_ptr<arrow::RecordBatch>* out) override {
+        std::vector<std::shared_ptr<arrow::RecordBatch>> parts;
+        int64_t rows = 0;
+        bool whole = true;
+        while (rows < batch_size_) {
+            if (rest_ == nullptr) {
+                ARROW_RETURN_NOT_OK(input_->ReadNext(&rest_));
+                if (rest_ == nullptr) {
+                    break;
+                }
+            } else {
+                whole = false;
+            }
+            auto take = std::min(rest_->num_rows(), batch_size_ - rows);
+            if (take < rest_->num_rows()) {
+                parts.push_back(rest_->Slice(0, take));
+                rest_ = rest_->Slice(take);
+                whole = false;
+            } else {
+                parts.push_back(rest_);
+                rest_ = nullptr;
+            }
+            rows += take;
+        }
+
+        if (parts.empty()) {
+            *out = nullptr;
+        } else if (parts.size() == 1 && whole) {
+            *out = parts.front();
+        } else {
+            // The concatenation also gives the slices a zero offset
+            ARROW_ASSIGN_OR_RAISE(*out, arrow::ConcatenateRecordBatches(parts));
+        }
+        return arrow::Status::OK();
+    }
+
+   private:
+    std::shared_ptr<arrow::RecordBatchReader> input_;
+    int64_t batch_size_;
+
+    // Rows of the last input batch not yet returned
+    std::shared_ptr<arrow::RecordBatch> rest_;
+};
+
+// Format of an input file from its leading magic bytes: Parquet files
+// start with "PAR1", Arrow IPC files (Feather) with "ARROW1", and streams
+// with neither. The file is left at its start.
+std::string sniff_format(arrow::io::RandomAccessFile& file) {
+    auto magic = check(file.ReadAt(0, 6));
+    std::string head(
+        reinterpret_cast<const char*>(magic->data()), magic->size());
 
+    // Stream readers read from the current position
+    check(file.Seek(0));
+    if (head.rfind("PAR1", 0) == 0) {
+        return "parquet";
+    }
+    return head == "ARROW1" ? "file" : "stream";
+}
+#endif
+
+int import_command(const Args& args) {
+#ifndef TILEDBSOMA_CLI_ARROW
+    (void)args;
+    throw TileDBSOMAError(
+        "import is unavailable: tiledbsoma-cli was built without Arrow C++");
+#else
+    if (args.positional.size() != 2) {
+        throw TileDBSOMAError("import expects an input path and an array URI");
+    }
+    auto& input = args.positional[0];
+    auto& uri = args.positional[1];
+    auto batch_size = parse_positive_option<int64_t>(args, "batch-size");
+    auto threads = parse_positive_option<int>(args, "threads");
+    auto global_order = args.get("global-order") == "true";
+
+    // The threads decode the input and run the TileDB writes, unless the
+    // config sets the TileDB concurrency
+    std::map<std::string, std::string> config;
+    if (threads > 0) {
+        check(arrow::SetCpuThreadPoolCapacity(threads));
+        config["sm.compute_concurrency_level"] = std::to_string(threads);
+        config["sm.io_concurrency_level"] = std::to_string(threads);
+    }
+    auto ctx = make_context(args, config);
+
+    auto array = SOMAArray::open(OpenMode::write, uri, ctx, "import");
+    auto type = array->type();
+    if (type && *type != "SOMADataFrame" && *type != "SOMASparseNDArray") {
+        throw TileDBSOMAError(fmt::format(
+            "Cannot import into '{}', which is a {}: expected a "
+            "SOMADataFrame or SOMASparseNDArray",
+            uri,
+            *type));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    auto file = check(arrow::io::ReadableFile::Open(input));
+    auto format = args.get("format");
+    if (format.empty()) {
+        format = sniff_format(*file);
+    }
+
+    auto read_options = arrow::ipc::IpcReadOptions::Defaults();
+    read_options.use_threads = threads != 1;
+
+    // The Parquet file reader must outlive its batch reader
+    std::shared_ptr<arrow::RecordBatchReader> reader;
+#ifdef TILEDBSOMA_CLI_PARQUET
+    std::unique_ptr<parquet::arrow::FileReader> parquet_reader;
+#endif
+    if (format == "stream") {
+        reader = check(
+            arrow::ipc::RecordBatchStreamReader::Open(file, read_options));
+    } else if (format == "file" || format == "feather") {
+        auto file_reader = check(
+            arrow::ipc::RecordBatchFileReader::Open(file, read_options));
+        auto next = std::make_shared<int>(0);
+        reader = check(arrow::RecordBatchReader::MakeFromIterator(
+            arrow::MakeFunctionIterator(
+                [file_reader,
+                 next]() -> arrow::Result<std::shared_ptr<arrow::RecordBatch>> {
+                    if (*next == file_reader->num_record_batches()) {
+                        return nullptr;
+                    }
+                    return file_reader->ReadRecordBatch((*next)++);
+                }),
+            file_reader->schema()));
+    } else if (format == "parquet") {
+#ifdef TILEDBSOMA_CLI_PARQUET
+        parquet::ArrowReaderProperties properties;
+        properties.set_use_threads(threads != 1);
+        if (batch_size > 0) {
+            properties.set_batch_size(batch_size);
+        }
+        parquet::arrow::FileReaderBuilder builder;
+        check(builder.Open(file));
+        builder.properties(properties);
+        parquet_reader = check(builder.Build());
+        reader = check(parquet_reader->GetRecordBatchReader());
+#else
+        throw TileDBSOMAError(
+            "Parquet input is unavailable: tiledbsoma-cli was built without "
+            "Parquet");
+#endif
+    } else {
+        throw TileDBSOMAError(fmt::format(
+            "Invalid format '{}', expected stream, file, feather or parquet",
+            format));
+    }
+
+    if (batch_size > 0) {
+        reader = std::make_shared<RebatchReader>(reader, batch_size);
+    }
+
+    // Each batch is written as a fragment, and cast to the array types
+    // while the previous one is written
+    struct ArrowArrayStream stream;
+    check(arrow::ExportRecordBatchReader(reader, &stream));
+    auto cells = array->write_stream(&stream, !global_order);
+    array->close();
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() -
+                                            start;
+    printf(
+        "Imported %llu rows from '%s' in %.3f s, %.0f rows/s\n",
+        (unsigned long long)cells,
+        input.c_str(),
+        elapsed.count(),
+        elapsed.count() > 0 ? cells / elapsed.count() : 0.0);
+    return 0;
+#endif
+}
+
+//===================================================================
+//= main
+//===================================================================
+
+void usage(FILE* out, const char* program) {
+    fprintf(
+        out,
+        "Usage:\n"
+        "  %s export [options] <array-uri> <output>\n"
+        "      Stream the reads of a SOMA array to an Arrow IPC stream or\n"
+        "      Feather (Arrow IPC file) on local disk.\n"
+        "\n"
+        "      --format stream|file|feather  Output format, by default file\n"
+        "                                    for a .feather output, else\n"
+        "                                    stream\n"
+        "      --columns a,b,...             Columns to read, by default all\n"
+        "      --range dim=lo:hi             Inclusive range of a dimension,\n"
+        "                                    repeatable\n"
+        "      --where 'column op value'     Query condition, with op one of\n"
+        "                                    == != < <= > >=; repeated\n"
+        "                                    conditions are combined with AND\n"
+        "      --result-order auto|row-major|col-major\n"
+        "      --compression none|lz4|zstd   IPC buffer compression\n"
+        "      --config key=value            TileDB or SOMA config, e.g.\n"
+        "                                    soma.init_buffer_bytes=...\n"
+        "      --log-level level             Log level, by default warn\n"
+        "\n"
+        "  %s import [options] <input> <array-uri>\n"
+        "      Write an Arrow IPC stream, Feather (Arrow IPC file) or Parquet\n"
+        "      file into an existing SOMADataFrame or SOMASparseNDArray.\n"
+        "\n"
+        "      --format stream|file|feather|parquet\n"
+        "                                    Input format, by default\n"
+        "                                    detected from the file\n"
+        "      --batch-size rows             Rows per write, by default the\n"
+        "                                    input batches\n"
+        "      --global-order                The rows of each batch are in\n"
+        "                                    the global order of the array,\n"
+        "                                    so the write skips sorting\n"
+        "      --threads n                   Threads decoding the input and\n"
+        "                                    writing to TileDB\n"
+        "      --config key=value            TileDB or SOMA config\n"
+        "      --log-level level             Log level, by default warn\n"
+        "\n"
+        "  %s <soma-uri>\n"
+        "      Run the C++ API experiments, e.g. with the CI test SOMA:\n"
+        "      %s test/soco/pbmc3k_processed\n",
+        program,
+        program,
+        program,
+        program);
+}
+
+int main(int argc, char** argv) {
+    // Errors, and the usage shown for missing arguments, go to stderr so
+    // they are not mixed with the output of a command
+    if (argc < 2) {
+        usage(stderr, argv[0]);
+        return 1;
+    }
+
+    std::string command = argv[1];
     try {
+        if (command == "export") {
+            auto args = parse_args(argc, argv, 2);
+            LOG_CONFIG(args.get("log-level", "warn"));
+            return export_command(args);
+        }
+        if (command == "import") {
+            auto args = parse_args(argc, argv, 2, {"global-order"});
+            LOG_CONFIG(args.get("log-level", "warn"));
+            return import_command(args);
+        }
+        if (command == "-h" || command == "--help") {
+            usage(stdout, argv[0]);
+            return 0;
+        }
+
+        LOG_CONFIG("debug");
         test_arrow(argv[1]);
         //        test_sdf(argv[1]);
     } catch (const std::exception& e) {
-        printf("%s\n", e.what());
+        fprintf(stderr, "%s\n", e.what());
         return 1;
     }
 
@@ -33,16 +33,38 @@
 #ifndef TILEDB_THREAD_POOL_H
 #define TILEDB_THREAD_POOL_H
 
-#include "producer_consumer_queue.h"
 #include "status.h"
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <functional>
 #include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
 
+#include <logger_public.h>
 #include <tiledb/tiledb>
 
 namespace tiledbsoma {
 
+/**
+ * A work-stealing thread pool.
+ *
+ * Every worker owns a task deque. Tasks scheduled from a worker are pushed to
+ * the back of its own deque and popped from the back again (LIFO), which keeps
+ * recursively spawned work on the thread whose caches hold its data. Tasks
+ * scheduled from outside of the pool are distributed round-robin over the
+ * worker deques. A worker with an empty deque steals from the front of the
+ * other deques (FIFO), so large, old tasks are the ones that migrate.
+ *
+ * `wait_all` executes pending tasks on the waiting thread instead of
+ * blocking, so nested parallel work cannot deadlock even on a pool with a
+ * single thread.
+ */
 class ThreadPool {
  public:
   using Task = std::future<Status>;
@@ -59,8 +81,15 @@ class ThreadPool {
    * zero will construct the thread pool in its shutdown state--constructed but
    * not accepting nor executing any tasks.  A value of 256*hardware_concurrency
    * or larger is an error.
+   * @param cpu_affinity CPUs the worker threads may run on.  If empty, the
+   * threads are not pinned.
+   * @param pin_workers If true, worker `i` is pinned to the single CPU
+   * `cpu_affinity[i % cpu_affinity.size()]` rather than to the whole set.
    */
-  explicit ThreadPool(size_t n);
+  explicit ThreadPool(
+      size_t n,
+      std::vector<size_t> cpu_affinity = {},
+      bool pin_workers = false);
 
   /** Deleted default constructor */
   ThreadPool() = delete;
@@ -101,13 +130,19 @@ class ThreadPool {
 
     auto task = std::make_shared<std::packaged_task<R()>>(
         [f = std::forward<Fn>(f),
-         args = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+         args = std::make_tuple(std::forward<Args>(args)...),
+         enqueued = std::chrono::steady_clock::now()]() mutable {
+          record_task_start(enqueued);
           return std::apply(std::move(f), std::move(args));
         });
 
     std::future<R> future = task->get_future();
 
-    task_queue_.push(task);
+    if (!enqueue(task)) {
+      Task invalid_future;
+      LOG_ERROR("Cannot execute task; thread pool has shut down.");
+      return invalid_future;
+    }
 
     return future;
   }
@@ -155,23 +190,80 @@ class ThreadPool {
   /* ********************************* */
 
  private:
+  using TaskPtr = std::shared_ptr<std::packaged_task<Status()>>;
+
+  /** A task deque owned by a single worker, from which others may steal */
+  struct WorkerQueue {
+    std::mutex mutex;
+    std::deque<TaskPtr> tasks;
+  };
+
   /** The worker thread routine */
-  void worker();
+  void worker(size_t index);
+
+  /** Restrict the calling worker thread to its configured CPUs */
+  void set_worker_affinity(size_t index);
 
   /** Terminate threads in the thread pool */
   void shutdown();
 
-  /** Producer-consumer queue where functions to be executed are kept */
-  ProducerConsumerQueue<
-      std::shared_ptr<std::packaged_task<Status()>>,
-      std::deque<std::shared_ptr<std::packaged_task<Status()>>>>
-      task_queue_;
+  /** Record how long a task waited in the queue, if stats are enabled */
+  static void record_task_start(std::chrono::steady_clock::time_point enqueued);
+
+  /**
+   * Push a task onto the deque of the calling worker, or onto the next deque
+   * in round-robin order if the caller is not one of our workers.
+   *
+   * @return false if the pool has been shut down.
+   */
+  bool enqueue(TaskPtr task);
+
+  /**
+   * Pop a task from the calling worker's own deque, or steal one from
+   * another worker. Never blocks on an empty pool.
+   */
+  std::optional<TaskPtr> try_pop();
+
+  /**
+   * Index of the calling thread in this pool, or `queues_.size()` if the
+   * calling thread is not one of our workers.
+   */
+  size_t worker_index() const;
+
+  /** One task deque per worker thread */
+  std::vector<std::unique_ptr<WorkerQueue>> queues_;
+
+  /** Round-robin cursor for tasks scheduled from outside of the pool */
+  std::atomic<size_t> next_queue_{0};
+
+  /** Number of tasks scheduled but not yet popped from any deque */
+  std::atomic<int64_t> pending_tasks_{0};
+
+  /** Number of workers sleeping, or about to sleep, on `sleep_cv_` */
+  std::atomic<size_t> sleeping_workers_{0};
+
+  /** Set once the pool starts to shut down */
+  std::atomic<bool> stopping_{false};
+
+  /** Mutex and condition variable idle workers sleep on */
+  std::mutex sleep_mutex_;
+  std::condition_variable sleep_cv_;
 
   /** The worker threads */
   std::vector<std::thread> threads_;
 
+  /** CPUs the worker threads are pinned to, if not empty */
+  std::vector<size_t> cpu_affinity_;
+
+  /** Pin each worker to a single CPU of `cpu_affinity_` */
+  bool pin_workers_;
+
   /** The maximum level of concurrency among all of the worker threads */
   std::atomic<size_t> concurrency_level_;
+
+  /** The pool and worker index of the calling thread, if it is a worker */
+  static thread_local const ThreadPool* tls_pool_;
+  static thread_local size_t tls_index_;
 };
 }  // namespace tiledbsoma
 
@@ -37,18 +37,30 @@
 #include <queue>
 #include <thread>
 
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
 #include "soma/logger_public.h"
+#include "utils/stats.h"
 
 namespace tiledbsoma {
 
+thread_local const ThreadPool* ThreadPool::tls_pool_ = nullptr;
+thread_local size_t ThreadPool::tls_index_ = 0;
+
 // Constructor.  May throw an exception on error.  No logging is done as the
 // logger may not yet be initialized.
-ThreadPool::ThreadPool(size_t n)
-    : concurrency_level_(n) {
+ThreadPool::ThreadPool(
+    size_t n, std::vector<size_t> cpu_affinity, bool pin_workers)
+    : cpu_affinity_(std::move(cpu_affinity))
+    , pin_workers_(pin_workers)
+    , concurrency_level_(n) {
   // If concurrency_level_ is set to zero, construct the thread pool in shutdown
-  // state.  Explicitly shut down the task queue as well.
+  // state.  Explicitly mark the pool as stopping as well.
   if (concurrency_level_ == 0) {
-    task_queue_.drain();
+    stopping_.store(true);
     return;
   }
 
@@ -62,6 +74,11 @@ ThreadPool::ThreadPool(size_t n)
     throw std::runtime_error(msg);
   }
 
+  queues_.reserve(concurrency_level_);
+  for (size_t i = 0; i < concurrency_level_; ++i) {
+    queues_.emplace_back(std::make_unique<WorkerQueue>());
+  }
+
   threads_.reserve(concurrency_level_);
 
   for (size_t i = 0; i < concurrency_level_; ++i) {
@@ -74,7 +91,7 @@ ThreadPool::ThreadPool(size_t n)
     size_t tries = 3;
     while (tries--) {
       try {
-        tmp = std::thread(&ThreadPool::worker, this);
+        tmp = std::thread(&ThreadPool::worker, this, i);
       } catch (const std::system_error& e) {
         if (e.code() != std::errc::resource_unavailable_try_again ||
             tries == 0) {
@@ -100,22 +117,162 @@ ThreadPool::ThreadPool(size_t n)
   }
 }
 
-void ThreadPool::worker() {
+void ThreadPool::worker(size_t index) {
+  tls_pool_ = this;
+  tls_index_ = index;
+
+  // Pin before the worker touches any memory, so that with the default
+  // first-touch policy whatever it allocates lands on its own NUMA node.
+  if (!cpu_affinity_.empty()) {
+    set_worker_affinity(index);
+  }
+
   while (true) {
-    auto val = task_queue_.pop();
-    if (val) {
+    if (auto val = try_pop()) {
       (*(*val))();
-    } else {
+      continue;
+    }
+
+    // Announce that we are going to sleep before checking for pending tasks.
+    // enqueue() increments pending_tasks_ before checking sleeping_workers_,
+    // so either we see the new task here or the producer sees us and wakes us
+    // up.
+    sleeping_workers_.fetch_add(1);
+    {
+      std::unique_lock lock{sleep_mutex_};
+      sleep_cv_.wait(lock, [this]() {
+        return stopping_.load() || pending_tasks_.load() > 0;
+      });
+    }
+    sleeping_workers_.fetch_sub(1);
+
+    // Pending tasks are still executed during shutdown.
+    if (stopping_.load() && pending_tasks_.load() <= 0) {
       break;
     }
   }
+
+  tls_pool_ = nullptr;
+}
+
+void ThreadPool::set_worker_affinity(size_t index) {
+#ifdef __linux__
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  for (size_t i = 0; i < cpu_affinity_.size(); ++i) {
+    auto cpu = cpu_affinity_[i];
+    if (pin_workers_ && i != index % cpu_affinity_.size()) {
+      continue;
+    }
+    if (cpu < CPU_SETSIZE) {
+      CPU_SET(cpu, &cpu_set);
+    }
+  }
+  int rc = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+  if (rc != 0) {
+    LOG_WARN(
+        "[ThreadPool] Unable to set the CPU affinity of worker " +
+        std::to_string(index) + "; error " + std::to_string(rc));
+  }
+#else
+  if (index == 0) {
+    LOG_WARN("[ThreadPool] CPU affinity is only supported on Linux; ignored");
+  }
+#endif
+}
+
+void ThreadPool::record_task_start(
+    std::chrono::steady_clock::time_point enqueued) {
+  // Updated lock-free: every task passes through here
+  static stats::AtomicTimer queue_wait("soma.thread_pool.task_queue_wait");
+  if (stats::is_enabled()) {
+    queue_wait.add(std::chrono::steady_clock::now() - enqueued);
+  }
+}
+
+size_t ThreadPool::worker_index() const {
+  return tls_pool_ == this ? tls_index_ : queues_.size();
+}
+
+bool ThreadPool::enqueue(TaskPtr task) {
+  if (stopping_.load() || queues_.empty()) {
+    return false;
+  }
+
+  // Count the task before it becomes visible so that pending_tasks_ never
+  // under-counts the tasks in the deques.
+  auto pending = pending_tasks_.fetch_add(1) + 1;
+  static stats::AtomicCounter tasks("soma.thread_pool.tasks");
+  static stats::AtomicCounter max_depth("soma.thread_pool.max_queue_depth");
+  tasks.add();
+  max_depth.max(static_cast<uint64_t>(pending));
+
+  auto index = worker_index();
+  if (index == queues_.size()) {
+    index = next_queue_.fetch_add(1, std::memory_order_relaxed) %
+            queues_.size();
+  }
+  {
+    std::scoped_lock lock{queues_[index]->mutex};
+    queues_[index]->tasks.push_back(std::move(task));
+  }
+
+  if (sleeping_workers_.load() > 0) {
+    // Take the lock so the notification cannot fall between a worker's check
+    // of the predicate and its wait.
+    std::scoped_lock lock{sleep_mutex_};
+    sleep_cv_.notify_one();
+  }
+  return true;
+}
+
+std::optional<ThreadPool::TaskPtr> ThreadPool::try_pop() {
+  if (queues_.empty()) {
+    return {};
+  }
+
+  auto index = worker_index();
+  if (index < queues_.size()) {
+    // Newest task of our own deque first
+    auto& queue = *queues_[index];
+    std::scoped_lock lock{queue.mutex};
+    if (!queue.tasks.empty()) {
+      auto task = std::move(queue.tasks.back());
+      queue.tasks.pop_back();
+      pending_tasks_.fetch_sub(1);
+      return task;
+    }
+  }
+
+  // Otherwise steal the oldest task of another deque, starting with our
+  // neighbour so that thieves spread out over the victims.
+  auto start = index < queues_.size() ?
+                   index + 1 :
+                   next_queue_.load(std::memory_order_relaxed);
+  for (size_t i = 0; i < queues_.size(); ++i) {
+    auto& victim = *queues_[(start + i) % queues_.size()];
+    std::unique_lock lock{victim.mutex, std::try_to_lock};
+    if (!lock.owns_lock() || victim.tasks.empty()) {
+      continue;
+    }
+    auto task = std::move(victim.tasks.front());
+    victim.tasks.pop_front();
+    pending_tasks_.fetch_sub(1);
+    return task;
+  }
+
+  return {};
 }
 
 // shutdown is private and only called by constructor and destructor (RAII), so
 // shutdown won't be called from multiple threads.
 void ThreadPool::shutdown() {
   concurrency_level_.store(0);
-  task_queue_.drain();
+  {
+    std::scoped_lock lock{sleep_mutex_};
+    stopping_.store(true);
+    sleep_cv_.notify_all();
+  }
   for (auto&& t : threads_) {
     t.join();
   }
@@ -189,7 +346,7 @@ std::vector<Status> ThreadPool::wait_all_status(std::vector<Task>& tasks) {
 
       // In the meantime, try to do something useful to make progress (and avoid
       // deadlock)
-      if (auto val = task_queue_.try_pop()) {
+      if (auto val = try_pop()) {
         (*(*val))();
       } else {
         // If nothing useful to do, yield so we don't burn cycles
@@ -31,6 +31,7 @@
  */
 
 #include "reindexer.h"
+#include <algorithm>
 #include <thread_pool/thread_pool.h>
 #include <thread>
 #include "khash.h"
@@ -39,6 +40,7 @@
 #include "utils/arrow_adapter.h"
 #include "utils/common.h"
 #include "utils/logger.h"
+#include "utils/stats.h"
 
 // Typedef for a 64-bit khash table
 KHASH_MAP_INIT_INT64(m64, int64_t)
@@ -46,6 +48,11 @@ KHASH_MAP_INIT_INT64(m64, int64_t)
 namespace tiledbsoma {
 
 void IntIndexer::map_locations(const int64_t* keys, size_t size) {
+    stats::ScopedTimer timer("soma.indexer.map_locations");
+    if (hash_ != nullptr) {
+        kh_destroy(m64, hash_);
+        hash_ = nullptr;
+    }
     map_size_ = size;
 
     // Handling edge cases
@@ -81,10 +88,15 @@ void IntIndexer::lookup(const int64_t* keys, int64_t* results, size_t size) {
     if (size == 0) {
         return;
     }
-    // Single thread checks
-    if (context_ == nullptr || context_->thread_pool() == nullptr ||
-        context_->thread_pool()->concurrency_level() == 1) {
-        for (size_t i = 0; i < size; i++) {
+    if (hash_ == nullptr) {
+        // Nothing was mapped, so no key is found
+        std::fill(results, results + size, -1);
+        return;
+    }
+    stats::ScopedTimer timer("soma.indexer.lookup");
+    stats::add_counter("soma.indexer.lookup_keys", size);
+    auto lookup_range = [this, keys, results](size_t start, size_t end) {
+        for (size_t i = start; i < end; i++) {
             auto k = kh_get(m64, hash_, keys[i]);
             if (k == kh_end(hash_)) {
                 // According to pandas behavior
@@ -93,55 +105,19 @@ void IntIndexer::lookup(const int64_t* keys, int64_t* results, size_t size) {
                 results[i] = kh_val(hash_, k);
             }
         }
+    };
+    // Single thread checks
+    if (context_ == nullptr) {
+        lookup_range(0, size);
         return;
     }
-    LOG_DEBUG(fmt::format(
-        "Lookup with thread concurrency {} on data size {}",
-        context_->thread_pool()->concurrency_level(),
-        size));
-
-    std::vector<tiledbsoma::ThreadPool::Task> tasks;
-
-    size_t thread_chunk_size = size /
-                               context_->thread_pool()->concurrency_level();
-    if (thread_chunk_size == 0) {
-        thread_chunk_size = 1;
-    }
-
-    for (size_t i = 0; i < size; i += thread_chunk_size) {
-        size_t start = i;
-        size_t end = i + thread_chunk_size;
-        if (end > size) {
-            end = size;
-        }
-        LOG_DEBUG(fmt::format(
-            "Creating tileDB task for the range from {} to {} ", start, end));
-        tiledbsoma::ThreadPool::Task task = context_->thread_pool()->execute(
-            [this, start, end, &results, &keys]() {
-                for (size_t i = start; i < end; i++) {
-                    auto k = kh_get(m64, hash_, keys[i]);
-                    if (k == kh_end(hash_)) {
-                        // According to pandas behavior
-                        results[i] = -1;
-                    } else {
-                        results[i] = kh_val(hash_, k);
-                    }
-                }
-                return tiledbsoma::Status::Ok();
-            });
-        assert(task.valid());
-        tasks.emplace_back(std::move(task));
-        LOG_DEBUG(fmt::format(
-            "Task for the range from {} to {} inserted in the queue",
-            start,
-            end));
-    }
-    context_->thread_pool()->wait_all(tasks);
+    LOG_DEBUG(fmt::format("[Re-indexer] Lookup on data size {}", size));
+    context_->parallel_for(0, size, LOOKUP_GRAIN_SIZE, lookup_range);
 }
 
 IntIndexer::~IntIndexer() {
-    if (map_size_ > 0) {
-        kh_destroy(m64, this->hash_);
+    if (hash_ != nullptr) {
+        kh_destroy(m64, hash_);
     }
 }
 
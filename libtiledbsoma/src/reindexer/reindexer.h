@@ -72,6 +72,13 @@ class IntIndexer {
 
         lookup(keys.data(), results.data(), keys.size());
     }
+    /**
+     * Return the number of keys mapped by map_locations, 0 if it was never
+     * called. Lookups return positions in [0, size()).
+     */
+    size_t size() const {
+        return map_size_;
+    }
     IntIndexer(){};
     IntIndexer(std::shared_ptr<tiledbsoma::SOMAContext> context)
         : context_(context) {
@@ -80,9 +87,16 @@ class IntIndexer {
 
    private:
     /*
-     * The created 64bit hash table
+     * Minimum number of keys looked up per parallel task. A khash lookup
+     * takes tens of nanoseconds, so smaller chunks are dominated by
+     * scheduling overhead.
+     */
+    static constexpr size_t LOOKUP_GRAIN_SIZE = 1 << 14;
+
+    /*
+     * The created 64bit hash table, null until keys are mapped
      */
-    kh_m64_s* hash_;
+    kh_m64_s* hash_ = nullptr;
 
     std::shared_ptr<SOMAContext> context_ = nullptr;
     /*
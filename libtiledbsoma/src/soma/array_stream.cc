@@ -0,0 +1,162 @@
+/**
+ * @file   array_stream.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2024 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *   This file defines the ArrayStream class.
+ */
+
+#include "array_stream.h"
+#include <cerrno>
+#include "../utils/logger.h"
+#include "../utils/stats.h"
+#include "soma_array.h"
+
+namespace tiledbsoma {
+
+//===================================================================
+//= public static
+//===================================================================
+
+void ArrayStream::export_to(
+    SOMAArray* array, struct ArrowArrayStream* stream, bool prefetch) {
+    stream->get_schema = &ArrayStream::get_schema;
+    stream->get_next = &ArrayStream::get_next;
+    stream->get_last_error = &ArrayStream::get_last_error;
+    stream->release = &ArrayStream::release;
+    stream->private_data = new ArrayStream(array, prefetch);
+}
+
+//===================================================================
+//= public non-static
+//===================================================================
+
+ArrayStream::~ArrayStream() {
+    if (pending_ != nullptr && pending_->release != nullptr) {
+        pending_->release(pending_.get());
+    }
+}
+
+//===================================================================
+//= private static
+//===================================================================
+
+int ArrayStream::get_schema(
+    struct ArrowArrayStream* stream, struct ArrowSchema* out) {
+    auto self = static_cast<ArrayStream*>(stream->private_data);
+    try {
+        if (self->exporter_.schema() == nullptr && !self->done_) {
+            self->fetch();
+        }
+        if (self->exporter_.schema() == nullptr) {
+            return ArrowSchemaInitFromType(out, NANOARROW_TYPE_STRUCT);
+        }
+        return ArrowSchemaDeepCopy(self->exporter_.schema(), out);
+    } catch (const std::exception& e) {
+        self->error_ = e.what();
+        return EIO;
+    }
+}
+
+int ArrayStream::get_next(
+    struct ArrowArrayStream* stream, struct ArrowArray* out) {
+    auto self = static_cast<ArrayStream*>(stream->private_data);
+    try {
+        if (self->pending_ == nullptr && !self->fetch()) {
+            // A released array marks the end of the stream
+            out->release = nullptr;
+            return 0;
+        }
+        ArrowArrayMove(self->pending_.get(), out);
+        self->pending_.reset();
+        stats::add_counter("soma.array_stream.batches");
+        return 0;
+    } catch (const std::exception& e) {
+        self->error_ = e.what();
+        return EIO;
+    }
+}
+
+const char* ArrayStream::get_last_error(struct ArrowArrayStream* stream) {
+    auto self = static_cast<ArrayStream*>(stream->private_data);
+    return self->error_.empty() ? nullptr : self->error_.c_str();
+}
+
+void ArrayStream::release(struct ArrowArrayStream* stream) {
+    delete static_cast<ArrayStream*>(stream->private_data);
+    stream->private_data = nullptr;
+    stream->release = nullptr;
+}
+
+//===================================================================
+//= private non-static
+//===================================================================
+
+bool ArrayStream::fetch() {
+    while (!done_) {
+        auto batch = array_->read_next();
+        if (!batch) {
+            done_ = true;
+            break;
+        }
+
+        // Read the next batch while this one is consumed
+        if (prefetch_) {
+            array_->prefetch_next();
+        }
+
+        // Empty batches are skipped, once the schema is known
+        auto& buffers = *batch;
+        size_t num_rows = buffers->names().empty() ? 0 : buffers->num_rows();
+        if (num_rows == 0 && exporter_.schema() != nullptr) {
+            continue;
+        }
+
+        // A string column falls back to 64-bit offsets when a batch holds
+        // more data than its layout allows, which the schema returned to
+        // the consumer cannot follow
+        if (exporter_.schema() != nullptr && !exporter_.matches(*buffers)) {
+            throw TileDBSOMAError(
+                "[ArrayStream] A batch does not match the stream schema: "
+                "string data too large for the selected layout. Use the "
+                "large string layout, or a smaller buffer size.");
+        }
+
+        auto array = exporter_.export_array(buffers);
+        if (num_rows == 0) {
+            array->release(array.get());
+            continue;
+        }
+
+        LOG_DEBUG(fmt::format("[ArrayStream] Read batch of {} rows", num_rows));
+        pending_ = std::move(array);
+        return true;
+    }
+    return false;
+}
+
+}  // namespace tiledbsoma
@@ -0,0 +1,134 @@
+/**
+ * @file   array_stream.h
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2024 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *   This declares the ArrayStream class, which exports the reads of a
+ *   SOMAArray as an Arrow C stream of record batches.
+ */
+
+#ifndef SOMA_ARRAY_STREAM_H
+#define SOMA_ARRAY_STREAM_H
+
+#include <memory>
+#include <string>
+
+#include "../utils/arrow_adapter.h"
+#include "batch_exporter.h"
+
+namespace tiledbsoma {
+
+class SOMAArray;
+
+/**
+ * @brief The private data of an ArrowArrayStream reading a SOMAArray. Each
+ * call to `get_next` returns the next non-empty batch of `read_next` as a
+ * struct array. With prefetch, the read of the following batch is
+ * submitted before the batch is returned, so TileDB reads it while the
+ * consumer processes the current one.
+ *
+ * The stream schema is that of the first batch, which `get_schema` reads
+ * ahead if needed. If the query returns no batch at all, the schema is a
+ * struct without fields. The schema is kept for the lifetime of the
+ * stream: a later batch whose string data is too large for the compact or
+ * view layout of the first fails `get_next`, rather than falling back to
+ * 64-bit offsets.
+ */
+class ArrayStream {
+   public:
+    //===================================================================
+    //= public static
+    //===================================================================
+
+    /**
+     * @brief Initialize `stream` to read `array`, from its current query.
+     * The array must stay open, and must not be read otherwise, until the
+     * stream is released.
+     *
+     * @param array Array opened in read mode
+     * @param stream Uninitialized stream
+     * @param prefetch Submit the read of the next batch ahead of `get_next`
+     */
+    static void export_to(
+        SOMAArray* array, struct ArrowArrayStream* stream, bool prefetch);
+
+    //===================================================================
+    //= public non-static
+    //===================================================================
+
+    ArrayStream(const ArrayStream&) = delete;
+    ArrayStream& operator=(const ArrayStream&) = delete;
+
+    ~ArrayStream();
+
+   private:
+    //===================================================================
+    //= private static
+    //===================================================================
+
+    // ArrowArrayStream callbacks, which forward to the ArrayStream in
+    // `private_data`
+    static int get_schema(
+        struct ArrowArrayStream* stream, struct ArrowSchema* out);
+    static int get_next(
+        struct ArrowArrayStream* stream, struct ArrowArray* out);
+    static const char* get_last_error(struct ArrowArrayStream* stream);
+    static void release(struct ArrowArrayStream* stream);
+
+    //===================================================================
+    //= private non-static
+    //===================================================================
+
+    ArrayStream(SOMAArray* array, bool prefetch)
+        : array_(array)
+        , prefetch_(prefetch) {
+    }
+
+    // Read the next non-empty batch into `pending_`, keeping the schema of
+    // the first batch read. Return false at the end of the query.
+    bool fetch();
+
+    SOMAArray* array_;
+
+    bool prefetch_;
+
+    // True once `read_next` returned std::nullopt
+    bool done_ = false;
+
+    // Batch read but not yet returned by `get_next`
+    std::unique_ptr<ArrowArray> pending_;
+
+    // Exporter of the batches, which holds the stream schema
+    BatchExporter exporter_;
+
+    // Message of the last error returned by a callback
+    std::string error_;
+};
+
+}  // namespace tiledbsoma
+
+#endif  // SOMA_ARRAY_STREAM_H
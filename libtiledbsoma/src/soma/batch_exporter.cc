@@ -0,0 +1,103 @@
+/**
+ * @file   batch_exporter.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2024 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *   This file defines the BatchExporter class.
+ */
+
+#include "batch_exporter.h"
+#include "../utils/logger.h"
+#include "../utils/stats.h"
+#include "array_buffers.h"
+
+namespace tiledbsoma {
+
+//===================================================================
+//= public non-static
+//===================================================================
+
+BatchExporter::~BatchExporter() {
+    release_schema();
+}
+
+std::unique_ptr<ArrowArray> BatchExporter::export_array(
+    std::shared_ptr<ArrayBuffers> batch) {
+    // The schema is derived before the arrays, from the buffers as read
+    if (!matches(*batch)) {
+        LOG_DEBUG("[BatchExporter] Building the batch schema");
+        release_schema();
+        schema_ = ArrowAdapter::to_arrow_schema(batch);
+        stats::add_counter("soma.batch_exporter.schemas");
+    }
+    stats::add_counter("soma.batch_exporter.batches");
+    return ArrowAdapter::to_arrow_array(batch);
+}
+
+ArrowTable BatchExporter::export_batch(std::shared_ptr<ArrayBuffers> batch) {
+    auto array = export_array(batch);
+    auto schema = std::make_unique<ArrowSchema>();
+    if (ArrowSchemaDeepCopy(schema_.get(), schema.get()) != NANOARROW_OK) {
+        array->release(array.get());
+        throw TileDBSOMAError("[BatchExporter] Failed to copy the schema");
+    }
+    return {std::move(array), std::move(schema)};
+}
+
+//===================================================================
+//= private non-static
+//===================================================================
+
+bool BatchExporter::matches(ArrayBuffers& batch) const {
+    auto& names = batch.names();
+    if (schema_ == nullptr ||
+        schema_->n_children != static_cast<int64_t>(names.size())) {
+        return false;
+    }
+    for (size_t i = 0; i < names.size(); i++) {
+        auto child = schema_->children[i];
+        if (names[i] != child->name) {
+            return false;
+        }
+        // The format of a string column depends on the size of its data
+        auto column = batch.at(names[i]);
+        if (column->is_var() &&
+            ArrowAdapter::export_format(column) != child->format) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void BatchExporter::release_schema() {
+    if (schema_ != nullptr && schema_->release != nullptr) {
+        schema_->release(schema_.get());
+    }
+    schema_.reset();
+}
+
+}  // namespace tiledbsoma
@@ -0,0 +1,116 @@
+/**
+ * @file   batch_exporter.h
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2024 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *   This declares the BatchExporter class, which exports the read batches
+ *   of a query as Arrow struct arrays sharing one schema.
+ */
+
+#ifndef SOMA_BATCH_EXPORTER_H
+#define SOMA_BATCH_EXPORTER_H
+
+#include <memory>
+
+#include "../utils/arrow_adapter.h"
+
+namespace tiledbsoma {
+
+class ArrayBuffers;
+
+/**
+ * @brief The BatchExporter exports read batches as Arrow struct arrays,
+ * i.e. record batches, whose children reference the column buffers without
+ * a copy. The struct schema is built from the first batch and kept while
+ * later batches have the same columns and formats, so each of those only
+ * exports its arrays.
+ */
+class BatchExporter {
+   public:
+    //===================================================================
+    //= public non-static
+    //===================================================================
+
+    BatchExporter() = default;
+    BatchExporter(const BatchExporter&) = delete;
+    BatchExporter& operator=(const BatchExporter&) = delete;
+
+    ~BatchExporter();
+
+    /**
+     * @brief Export a batch as a struct array, first rebuilding the schema
+     * if the batch differs from the previous one in its columns or their
+     * formats.
+     *
+     * @param batch Batch returned by a read, not yet exported
+     * @return std::unique_ptr<ArrowArray> Struct array with one child per
+     * column
+     */
+    std::unique_ptr<ArrowArray> export_array(
+        std::shared_ptr<ArrayBuffers> batch);
+
+    /**
+     * @brief Export a batch as a struct array with a copy of its schema.
+     *
+     * @param batch Batch returned by a read, not yet exported
+     * @return ArrowTable
+     */
+    ArrowTable export_batch(std::shared_ptr<ArrayBuffers> batch);
+
+    /**
+     * @brief Return the schema of the last exported batch, owned by the
+     * exporter, or nullptr before the first export.
+     *
+     * @return const ArrowSchema*
+     */
+    const ArrowSchema* schema() const {
+        return schema_.get();
+    }
+
+    /**
+     * @brief Return true if the schema describes the columns of `batch`,
+     * i.e. if exporting it keeps the schema.
+     *
+     * @param batch Batch returned by a read, not yet exported
+     */
+    bool matches(ArrayBuffers& batch) const;
+
+   private:
+    //===================================================================
+    //= private non-static
+    //===================================================================
+
+    // Release the schema, if any
+    void release_schema();
+
+    // Schema of the exported batches
+    std::unique_ptr<ArrowSchema> schema_;
+};
+
+}  // namespace tiledbsoma
+
+#endif  // SOMA_BATCH_EXPORTER_H
@@ -31,7 +31,11 @@
  */
 
 #include "column_buffer.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
 #include "../utils/logger.h"
+#include "../utils/stats.h"
 
 namespace tiledbsoma {
 
@@ -42,7 +46,9 @@ using namespace tiledb;
 //===================================================================
 
 std::shared_ptr<ColumnBuffer> ColumnBuffer::create(
-    std::shared_ptr<Array> array, std::string_view name) {
+    std::shared_ptr<Array> array,
+    std::string_view name,
+    std::optional<std::pair<size_t, size_t>> size) {
     auto schema = array->schema();
     auto name_str = std::string(name);  // string for TileDB API
 
@@ -75,7 +81,8 @@ std::shared_ptr<ColumnBuffer> ColumnBuffer::create(
             is_var,
             is_nullable,
             enumeration,
-            is_ordered);
+            is_ordered,
+            size);
 
     } else if (schema.domain().has_dimension(name_str)) {
         auto dim = schema.domain().dimension(name_str);
@@ -97,12 +104,145 @@ std::shared_ptr<ColumnBuffer> ColumnBuffer::create(
             is_var,
             false,
             std::nullopt,
-            false);
+            false,
+            size);
     }
 
     throw TileDBSOMAError("[ColumnBuffer] Column name not found: " + name_str);
 }
 
+size_t ColumnBuffer::alloc_bytes(const Config& config) {
+    // Set number of bytes for the data buffer. Override with a value from
+    // the config if present.
+    auto num_bytes = DEFAULT_ALLOC_BYTES;
+    if (config.contains(CONFIG_KEY_INIT_BYTES)) {
+        auto value_str = config.get(CONFIG_KEY_INIT_BYTES);
+        try {
+            num_bytes = std::stoull(value_str);
+        } catch (const std::exception& e) {
+            throw TileDBSOMAError(fmt::format(
+                "[ColumnBuffer] Error parsing {}: '{}' ({})",
+                CONFIG_KEY_INIT_BYTES,
+                value_str,
+                e.what()));
+        }
+    }
+    return num_bytes;
+}
+
+uint64_t ColumnBuffer::max_narrow_bytes(const Config& config) {
+    uint64_t max_bytes = std::numeric_limits<int32_t>::max();
+    if (config.contains(CONFIG_KEY_MAX_NARROW_BYTES)) {
+        auto value_str = config.get(CONFIG_KEY_MAX_NARROW_BYTES);
+        try {
+            max_bytes = std::min<uint64_t>(max_bytes, std::stoull(value_str));
+        } catch (const std::exception& e) {
+            throw TileDBSOMAError(fmt::format(
+                "[ColumnBuffer] Error parsing {}: '{}' ({})",
+                CONFIG_KEY_MAX_NARROW_BYTES,
+                value_str,
+                e.what()));
+        }
+    }
+    return max_bytes;
+}
+
+std::shared_ptr<ColumnBuffer> ColumnBuffer::gather(
+    const std::vector<ColumnBuffer*>& sources,
+    const std::vector<std::pair<size_t, uint64_t>>& cells) {
+    if (sources.empty()) {
+        throw TileDBSOMAError("[ColumnBuffer] Cannot gather without sources");
+    }
+    auto& first = *sources.front();
+    for (auto source : sources) {
+        if (source->type_ != first.type_ || source->is_var_ != first.is_var_ ||
+            source->is_nullable_ != first.is_nullable_) {
+            throw TileDBSOMAError(fmt::format(
+                "[ColumnBuffer] Cannot gather '{}' from '{}': types differ",
+                first.name_,
+                source->name_));
+        }
+    }
+
+    auto result = std::make_shared<ColumnBuffer>(
+        first.name_,
+        first.type_,
+        cells.size(),
+        first.is_var_ ? 0 : cells.size() * first.type_size_,
+        first.is_var_,
+        first.is_nullable_,
+        first.enumeration_,
+        first.is_ordered_);
+
+    for (auto [index, cell] : cells) {
+        if (index >= sources.size() || cell >= sources[index]->num_cells_) {
+            throw TileDBSOMAError(fmt::format(
+                "[ColumnBuffer] Cannot gather cell {} of source {} of '{}'",
+                cell,
+                index,
+                first.name_));
+        }
+        auto& source = *sources[index];
+        if (first.is_var_) {
+            auto start = source.offsets_[cell];
+            auto len = source.offsets_[cell + 1] - start;
+            result->offsets_.push_back(result->data_.size());
+            result->data_.insert(
+                result->data_.end(),
+                source.data_.data() + start,
+                source.data_.data() + start + len);
+        } else {
+            auto data = source.data_.data() + cell * first.type_size_;
+            result->data_.insert(
+                result->data_.end(), data, data + first.type_size_);
+        }
+        if (first.is_nullable_) {
+            result->validity_.push_back(source.validity_[cell]);
+        }
+    }
+
+    if (first.is_var_) {
+        result->offsets_.push_back(result->data_.size());
+        result->data_size_ = result->data_.size();
+    } else {
+        result->data_size_ = cells.size();
+    }
+    result->num_cells_ = cells.size();
+
+    if (first.has_enumeration_) {
+        result->add_enumeration(first.enums_);
+    }
+    result->export_plan_ = first.export_plan_;
+    result->string_layout_ = first.string_layout_;
+    result->max_narrow_bytes_ = first.max_narrow_bytes_;
+
+    return result;
+}
+
+uint32_t* ColumnBuffer::offsets_to_uint32() {
+    if (!is_var_) {
+        throw TileDBSOMAError(fmt::format(
+            "[ColumnBuffer] Offsets requested for non-variable length column "
+            "'{}'",
+            name_));
+    }
+    if (offsets_[num_cells_] > (uint64_t)std::numeric_limits<int32_t>::max()) {
+        throw TileDBSOMAError(fmt::format(
+            "[ColumnBuffer] Data of column '{}' is too large for 32-bit "
+            "offsets",
+            name_));
+    }
+
+    // Offset i is written to bytes [4i, 4i + 4), which only overlap the
+    // 64-bit offsets already read
+    auto bytes = reinterpret_cast<std::byte*>(offsets_.data());
+    for (uint64_t i = 0; i <= num_cells_; i++) {
+        auto offset = static_cast<uint32_t>(offsets_[i]);
+        std::memcpy(bytes + i * sizeof(uint32_t), &offset, sizeof(uint32_t));
+    }
+    return reinterpret_cast<uint32_t*>(bytes);
+}
+
 void ColumnBuffer::to_bitmap(tcb::span<uint8_t> bytemap) {
     int i_dst = 0;
     for (unsigned int i_src = 0; i_src < bytemap.size(); i_src++) {
@@ -157,6 +297,11 @@ ColumnBuffer::ColumnBuffer(
     if (is_nullable_) {
         validity_.reserve(num_cells);
     }
+    stats::add_counter("soma.column_buffer.allocs");
+    stats::add_counter(
+        "soma.column_buffer.alloc_bytes",
+        num_bytes + (is_var_ ? (num_cells + 1) * sizeof(uint64_t) : 0) +
+            (is_nullable_ ? num_cells : 0));
 }
 
 ColumnBuffer::~ColumnBuffer() {
@@ -196,6 +341,60 @@ size_t ColumnBuffer::update_size(const Query& query) {
     return num_cells_;
 }
 
+size_t ColumnBuffer::compact(tcb::span<const uint8_t> keep) {
+    if (keep.size() != num_cells_) {
+        throw TileDBSOMAError(fmt::format(
+            "[ColumnBuffer] Cannot compact '{}': {} flags for {} cells",
+            name_,
+            keep.size(),
+            num_cells_));
+    }
+
+    size_t dst = 0;
+    if (is_var_) {
+        // Offsets are read ahead of the position being written, so they can
+        // be rewritten in place.
+        uint64_t data_dst = 0;
+        for (size_t src = 0; src < num_cells_; src++) {
+            if (!keep[src]) {
+                continue;
+            }
+            auto start = offsets_[src];
+            auto len = offsets_[src + 1] - start;
+            if (data_dst != start) {
+                std::memmove(
+                    data_.data() + data_dst, data_.data() + start, len);
+            }
+            offsets_[dst] = data_dst;
+            data_dst += len;
+            if (is_nullable_) {
+                validity_[dst] = validity_[src];
+            }
+            dst++;
+        }
+        offsets_[dst] = data_dst;
+    } else {
+        for (size_t src = 0; src < num_cells_; src++) {
+            if (!keep[src]) {
+                continue;
+            }
+            if (dst != src) {
+                std::memcpy(
+                    data_.data() + dst * type_size_,
+                    data_.data() + src * type_size_,
+                    type_size_);
+                if (is_nullable_) {
+                    validity_[dst] = validity_[src];
+                }
+            }
+            dst++;
+        }
+    }
+
+    num_cells_ = dst;
+    return num_cells_;
+}
+
 std::vector<std::string> ColumnBuffer::strings() {
     std::vector<std::string> result;
 
@@ -223,23 +422,25 @@ std::shared_ptr<ColumnBuffer> ColumnBuffer::alloc(
     bool is_var,
     bool is_nullable,
     std::optional<Enumeration> enumeration,
-    bool is_ordered) {
-    // Set number of bytes for the data buffer. Override with a value from
-    // the config if present.
-    auto num_bytes = DEFAULT_ALLOC_BYTES;
-    if (config.contains(CONFIG_KEY_INIT_BYTES)) {
-        auto value_str = config.get(CONFIG_KEY_INIT_BYTES);
-        try {
-            num_bytes = std::stoull(value_str);
-        } catch (const std::exception& e) {
-            throw TileDBSOMAError(fmt::format(
-                "[ColumnBuffer] Error parsing {}: '{}' ({})",
-                CONFIG_KEY_INIT_BYTES,
-                value_str,
-                e.what()));
-        }
+    bool is_ordered,
+    std::optional<std::pair<size_t, size_t>> size) {
+    std::shared_ptr<ColumnBuffer> buffer;
+    if (size.has_value()) {
+        buffer = std::make_shared<ColumnBuffer>(
+            name,
+            type,
+            size->first,
+            size->second,
+            is_var,
+            is_nullable,
+            enumeration,
+            is_ordered);
+        buffer->max_narrow_bytes_ = max_narrow_bytes(config);
+        return buffer;
     }
 
+    auto num_bytes = alloc_bytes(config);
+
     // bool is_dense = schema.array_type() == TILEDB_DENSE;
     // if (is_dense) {
     //     // TODO: Handle dense arrays similar to tiledb python module
@@ -253,7 +454,7 @@ std::shared_ptr<ColumnBuffer> ColumnBuffer::alloc(
     size_t num_cells = is_var ? num_bytes / sizeof(uint64_t) :
                                 num_bytes / tiledb::impl::type_size(type);
 
-    return std::make_shared<ColumnBuffer>(
+    buffer = std::make_shared<ColumnBuffer>(
         name,
         type,
         num_cells,
@@ -262,6 +463,8 @@ std::shared_ptr<ColumnBuffer> ColumnBuffer::alloc(
         is_nullable,
         enumeration,
         is_ordered);
+    buffer->max_narrow_bytes_ = max_narrow_bytes(config);
+    return buffer;
 }
 
 }  // namespace tiledbsoma
@@ -33,6 +33,7 @@
 #ifndef COLUMN_BUFFER_H
 #define COLUMN_BUFFER_H
 
+#include <limits>
 #include <stdexcept>  // for windows: error C2039: 'runtime_error': is not a member of 'std'
 
 #include <tiledb/tiledb>
@@ -40,6 +41,7 @@
 
 #include "../utils/arrow_adapter.h"
 #include "../utils/common.h"
+#include "enums.h"
 #include "soma_context.h"
 #include "span/span.hpp"
 
@@ -60,6 +62,8 @@ class ColumnBuffer {
     inline static const size_t DEFAULT_ALLOC_BYTES = 1 << 30;
     inline static const std::string
         CONFIG_KEY_INIT_BYTES = "soma.init_buffer_bytes";
+    inline static const std::string
+        CONFIG_KEY_MAX_NARROW_BYTES = "soma.max_narrow_string_bytes";
 
    public:
     //===================================================================
@@ -71,10 +75,46 @@ class ColumnBuffer {
      *
      * @param array TileDB array
      * @param name TileDB dimension or attribute name
+     * @param size Optional number of cells and number of data bytes to
+     * allocate, overriding the size set in the config
      * @return ColumnBuffer
      */
     static std::shared_ptr<ColumnBuffer> create(
-        std::shared_ptr<Array> array, std::string_view name);
+        std::shared_ptr<Array> array,
+        std::string_view name,
+        std::optional<std::pair<size_t, size_t>> size = std::nullopt);
+
+    /**
+     * @brief Return the number of bytes allocated for the data of each
+     * column, set by `soma.init_buffer_bytes` in the config.
+     *
+     * @param config TileDB Config
+     * @return size_t
+     */
+    static size_t alloc_bytes(const Config& config);
+
+    /**
+     * @brief Return the largest string data, in bytes, of a column exported
+     * with 32-bit offsets or as string views. It is 2 GiB, or less if set by
+     * `soma.max_narrow_string_bytes` in the config.
+     *
+     * @param config TileDB Config
+     * @return uint64_t
+     */
+    static uint64_t max_narrow_bytes(const Config& config);
+
+    /**
+     * @brief Return a new ColumnBuffer holding copies of the given cells, in
+     * order. The sources must hold the same column, and the result takes
+     * its name, type and enumeration from the first one.
+     *
+     * @param sources Source buffers
+     * @param cells Index into `sources` and cell index of each cell
+     * @return ColumnBuffer
+     */
+    static std::shared_ptr<ColumnBuffer> gather(
+        const std::vector<ColumnBuffer*>& sources,
+        const std::vector<std::pair<size_t, uint64_t>>& cells);
 
     /**
      * @brief Convert a bytemap to a bitmap in place.
@@ -213,6 +253,16 @@ class ColumnBuffer {
      */
     size_t update_size(const Query& query);
 
+    /**
+     * @brief Keep only the cells for which `keep` is non-zero, preserving
+     * their order. The data, offsets and validity buffers are compacted in
+     * place.
+     *
+     * @param keep One flag per cell
+     * @return size_t Number of cells kept
+     */
+    size_t compact(tcb::span<const uint8_t> keep);
+
     /**
      * @brief Return the number of cells in the buffer.
      *
@@ -336,6 +386,39 @@ class ColumnBuffer {
         ColumnBuffer::to_bitmap(validity());
     }
 
+    /**
+     * @brief Convert the offsets to uint32 in place, for export with 32-bit
+     * offsets. The data size must fit in an int32, and `offsets` must not
+     * be used afterwards.
+     *
+     * @return uint32_t* The converted offsets
+     */
+    uint32_t* offsets_to_uint32();
+
+    /**
+     * @brief Set the Arrow layout of the column when it holds strings or
+     * binary values.
+     */
+    void set_string_layout(StringLayout layout) {
+        string_layout_ = layout;
+    }
+
+    /**
+     * @brief Return the Arrow layout of the column when it holds strings or
+     * binary values.
+     */
+    StringLayout string_layout() const {
+        return string_layout_;
+    }
+
+    /**
+     * @brief Return the largest string data, in bytes, exported with the
+     * compact or view layout. Larger data is exported with 64-bit offsets.
+     */
+    uint64_t max_narrow_bytes() const {
+        return max_narrow_bytes_;
+    }
+
     /**
      * @brief Add an optional enumeration vector,
      *
@@ -345,6 +428,24 @@ class ColumnBuffer {
         has_enumeration_ = true;
     }
 
+    /**
+     * @brief Set the plan exporting the column to Arrow, shared with the
+     * other buffers read for the column from the open array.
+     *
+     * @param plan Arrow export plan
+     */
+    void set_export_plan(std::shared_ptr<ArrowExportPlan> plan) {
+        export_plan_ = plan;
+    }
+
+    /**
+     * @brief Return the shared Arrow export plan, or nullptr if none was
+     * set.
+     */
+    std::shared_ptr<ArrowExportPlan> export_plan() const {
+        return export_plan_;
+    }
+
     /**
      * @brief Return true if the buffer contains enumeration.
      */
@@ -428,6 +529,7 @@ class ColumnBuffer {
      * @param is_nullable True if nullable data
      * @param enumeration Optional Enumeration associated with column
      * @param is_ordered Optional Enumeration is ordered
+     * @param size Optional number of cells and number of data bytes
      * @return ColumnBuffer
      */
     static std::shared_ptr<ColumnBuffer> alloc(
@@ -437,7 +539,8 @@ class ColumnBuffer {
         bool is_var,
         bool is_nullable,
         std::optional<Enumeration> enumeration,
-        bool is_ordered);
+        bool is_ordered,
+        std::optional<std::pair<size_t, size_t>> size = std::nullopt);
 
     //===================================================================
     //= private non-static
@@ -476,12 +579,21 @@ class ColumnBuffer {
     // Validity buffer (optional).
     std::vector<uint8_t> validity_;
 
+    // Arrow layout of the exported strings, for var-sized columns
+    StringLayout string_layout_ = StringLayout::large;
+
+    // Largest string data exported with the compact or view layout
+    uint64_t max_narrow_bytes_ = std::numeric_limits<int32_t>::max();
+
     // True if the array has at least one enumerations
     bool has_enumeration_ = false;
 
     // Enumerations (optional)
     std::vector<std::string> enums_;
 
+    // Arrow export plan shared across batches (optional)
+    std::shared_ptr<ArrowExportPlan> export_plan_;
+
     // Enumerations (optional) as string and offsets
     std::string enum_str_;
     std::vector<uint32_t> enum_offsets_;
@@ -0,0 +1,354 @@
+/**
+ * @file   compressed_matrix.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2024 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *   This file defines the CompressedMatrix class.
+ */
+
+#include "compressed_matrix.h"
+#include <thread_pool/thread_pool.h>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <limits>
+#include <type_traits>
+#include "../reindexer/reindexer.h"
+#include "../utils/logger.h"
+#include "../utils/stats.h"
+#include "array_buffers.h"
+#include "soma_context.h"
+
+namespace tiledbsoma {
+
+using namespace tiledb;
+
+namespace {
+
+// Minimum number of cells per partition of the counting sort. Each partition
+// keeps one counter per major index, so it must also hold at least as many
+// cells as there are major indices to pay for its histogram.
+constexpr uint64_t MIN_PARTITION_CELLS = 1 << 16;
+
+// Minimum number of cells, or of major indices, per parallel task of the
+// passes that are not partitioned
+constexpr size_t CELL_GRAIN_SIZE = 1 << 16;
+constexpr size_t MAJOR_GRAIN_SIZE = 1 << 12;
+
+// Call `fn(begin, end)` over [begin, end), on the context thread pool if any
+void for_range(
+    SOMAContext* ctx,
+    size_t begin,
+    size_t end,
+    size_t grain_size,
+    const std::function<void(size_t, size_t)>& fn) {
+    if (ctx == nullptr) {
+        fn(begin, end);
+    } else {
+        ctx->parallel_for(begin, end, grain_size, fn);
+    }
+}
+
+// Set `positions` to the coordinates of a dimension over all batches, mapped
+// through the indexer if any, and check that they fall in [0, extent)
+void read_positions(
+    const std::vector<std::shared_ptr<ArrayBuffers>>& batches,
+    const std::string& dim,
+    uint64_t extent,
+    IntIndexer* indexer,
+    SOMAContext* ctx,
+    std::vector<int64_t>& positions) {
+    uint64_t offset = 0;
+    for (const auto& batch : batches) {
+        auto column = batch->at(dim);
+        if (column->type() != TILEDB_INT64 || column->is_nullable()) {
+            throw TileDBSOMAError(fmt::format(
+                "[CompressedMatrix] Dimension '{}' must be non-nullable int64",
+                dim));
+        }
+        auto coords = column->data<int64_t>();
+        if (indexer != nullptr) {
+            indexer->lookup(
+                coords.data(), positions.data() + offset, coords.size());
+        } else {
+            std::copy(
+                coords.begin(), coords.end(), positions.begin() + offset);
+        }
+        offset += coords.size();
+    }
+
+    std::atomic<bool> out_of_range{false};
+    for_range(
+        ctx, 0, positions.size(), CELL_GRAIN_SIZE, [&](size_t b, size_t e) {
+            for (size_t i = b; i < e; i++) {
+                if (positions[i] < 0 || (uint64_t)positions[i] >= extent) {
+                    out_of_range = true;
+                    return;
+                }
+            }
+        });
+    if (out_of_range) {
+        throw TileDBSOMAError(fmt::format(
+            "[CompressedMatrix] A coordinate of dimension '{}' {} outside of "
+            "[0, {})",
+            dim,
+            indexer == nullptr ? "falls" : "is not indexed or falls",
+            extent));
+    }
+}
+
+// Counting sort of the cells by major index into `indptr`, `indices` and
+// `data`. The values are moved as unsigned integers of their size.
+template <typename Index, typename Value>
+void sort_cells(
+    const std::vector<std::shared_ptr<ArrayBuffers>>& batches,
+    const std::string& value_column,
+    const std::vector<int64_t>& major,
+    const std::vector<int64_t>& minor,
+    uint64_t n_major,
+    size_t num_partitions,
+    SOMAContext* ctx,
+    Index* indptr,
+    Index* indices,
+    Value* data) {
+    uint64_t num_cells = major.size();
+    auto partition_begin = [&](size_t p) {
+        return num_cells * p / num_partitions;
+    };
+
+    // The first cell of each batch, and its values
+    std::vector<uint64_t> batch_begin{0};
+    std::vector<const Value*> values;
+    for (const auto& batch : batches) {
+        auto column = batch->at(value_column);
+        batch_begin.push_back(batch_begin.back() + column->size());
+        values.push_back((const Value*)column->data<std::byte>().data());
+    }
+
+    // Count the cells of each major index in each partition
+    std::vector<uint64_t> counts(num_partitions * n_major, 0);
+    for_range(ctx, 0, num_partitions, 1, [&](size_t b, size_t e) {
+        for (size_t p = b; p < e; p++) {
+            uint64_t* count = counts.data() + p * n_major;
+            uint64_t end = partition_begin(p + 1);
+            for (uint64_t i = partition_begin(p); i < end; i++) {
+                count[major[i]]++;
+            }
+        }
+    });
+
+    // Turn the counts into the offset of each partition within the entries
+    // of each major index, and sum them up into `indptr`
+    for_range(ctx, 0, n_major, MAJOR_GRAIN_SIZE, [&](size_t b, size_t e) {
+        for (size_t m = b; m < e; m++) {
+            uint64_t total = 0;
+            for (size_t p = 0; p < num_partitions; p++) {
+                uint64_t count = counts[p * n_major + m];
+                counts[p * n_major + m] = total;
+                total += count;
+            }
+            indptr[m + 1] = (Index)total;
+        }
+    });
+    indptr[0] = 0;
+    for (uint64_t m = 0; m < n_major; m++) {
+        indptr[m + 1] += indptr[m];
+    }
+
+    // Scatter the cells, each partition into its own slots, which keeps the
+    // entries of each major index in read order
+    for_range(ctx, 0, num_partitions, 1, [&](size_t b, size_t e) {
+        for (size_t p = b; p < e; p++) {
+            uint64_t* cursor = counts.data() + p * n_major;
+            uint64_t begin = partition_begin(p);
+            uint64_t end = partition_begin(p + 1);
+            auto next = std::upper_bound(
+                batch_begin.begin(), batch_begin.end(), begin);
+            size_t batch = next - batch_begin.begin() - 1;
+            for (uint64_t i = begin; i < end; i++) {
+                while (i >= batch_begin[batch + 1]) {
+                    batch++;
+                }
+                auto m = major[i];
+                auto slot = indptr[m] + cursor[m]++;
+                indices[slot] = (Index)minor[i];
+                data[slot] = values[batch][i - batch_begin[batch]];
+            }
+        }
+    });
+
+    // Sort the entries of each major index by minor index, unless they were
+    // read in that order
+    for_range(ctx, 0, n_major, MAJOR_GRAIN_SIZE, [&](size_t b, size_t e) {
+        std::vector<std::pair<Index, Value>> entries;
+        for (size_t m = b; m < e; m++) {
+            auto begin = indptr[m];
+            auto end = indptr[m + 1];
+            if (std::is_sorted(indices + begin, indices + end)) {
+                continue;
+            }
+            entries.clear();
+            for (auto slot = begin; slot < end; slot++) {
+                entries.emplace_back(indices[slot], data[slot]);
+            }
+            std::sort(
+                entries.begin(), entries.end(), [](auto& lhs, auto& rhs) {
+                    return lhs.first < rhs.first;
+                });
+            for (auto slot = begin; slot < end; slot++) {
+                indices[slot] = entries[slot - begin].first;
+                data[slot] = entries[slot - begin].second;
+            }
+        }
+    });
+}
+
+// Call `fn` with a null pointer of the unsigned type used to move values of
+// `size` bytes
+template <typename Fn>
+void visit_value_size(uint64_t size, Fn&& fn) {
+    switch (size) {
+        case 1:
+            return fn((uint8_t*)nullptr);
+        case 2:
+            return fn((uint16_t*)nullptr);
+        case 4:
+            return fn((uint32_t*)nullptr);
+        case 8:
+            return fn((uint64_t*)nullptr);
+        default:
+            throw TileDBSOMAError(fmt::format(
+                "[CompressedMatrix] Unsupported value size {}", size));
+    }
+}
+
+}  // namespace
+
+//===================================================================
+//= public static
+//===================================================================
+
+std::shared_ptr<CompressedMatrix> CompressedMatrix::from_coo(
+    const std::vector<std::shared_ptr<ArrayBuffers>>& batches,
+    const std::string& major_dim,
+    const std::string& minor_dim,
+    const std::string& value_column,
+    uint64_t n_major,
+    uint64_t n_minor,
+    std::shared_ptr<IntIndexer> major_indexer,
+    std::shared_ptr<IntIndexer> minor_indexer,
+    std::shared_ptr<SOMAContext> ctx) {
+    stats::ScopedTimer timer("soma.compressed_matrix.from_coo");
+    if (batches.empty()) {
+        throw TileDBSOMAError(
+            "[CompressedMatrix] At least one batch is required");
+    }
+
+    // Check the value column, and count the cells
+    auto first = batches.front()->at(value_column);
+    uint64_t num_cells = 0;
+    for (const auto& batch : batches) {
+        auto column = batch->at(value_column);
+        if (column->is_var() || column->is_nullable() ||
+            column->type() != first->type()) {
+            throw TileDBSOMAError(fmt::format(
+                "[CompressedMatrix] Value column '{}' must be fixed-size, "
+                "non-nullable and of the same type in every batch",
+                value_column));
+        }
+        num_cells += column->size();
+    }
+    stats::add_counter("soma.compressed_matrix.cells", num_cells);
+
+    auto result = std::shared_ptr<CompressedMatrix>(new CompressedMatrix());
+    result->n_major_ = n_major;
+    result->n_minor_ = n_minor;
+    result->nnz_ = num_cells;
+    result->data_type_ = first->type();
+
+    SOMAContext* context = ctx.get();
+    std::vector<int64_t> major(num_cells);
+    std::vector<int64_t> minor(num_cells);
+    read_positions(
+        batches, major_dim, n_major, major_indexer.get(), context, major);
+    read_positions(
+        batches, minor_dim, n_minor, minor_indexer.get(), context, minor);
+
+    // Partition the cells for the counting sort, no finer than one
+    // histogram's worth of cells per partition
+    size_t num_partitions = 1;
+    if (context != nullptr && context->thread_pool() != nullptr) {
+        uint64_t min_cells = std::max(MIN_PARTITION_CELLS, n_major);
+        num_partitions = std::clamp<uint64_t>(
+            num_cells / min_cells,
+            1,
+            context->thread_pool()->concurrency_level());
+    }
+
+    constexpr uint64_t max_int32 = std::numeric_limits<int32_t>::max();
+    bool narrow = num_cells <= max_int32 && n_minor <= max_int32;
+    result->index_type_ = narrow ? TILEDB_INT32 : TILEDB_INT64;
+    uint64_t index_size = narrow ? sizeof(int32_t) : sizeof(int64_t);
+    uint64_t value_size = tiledb::impl::type_size(result->data_type_);
+    result->indptr_.resize((n_major + 1) * index_size);
+    result->indices_.resize(num_cells * index_size);
+    result->data_.resize(num_cells * value_size);
+
+    visit_value_size(value_size, [&](auto* value) {
+        using Value = std::remove_pointer_t<decltype(value)>;
+        auto sort = [&](auto* index) {
+            using Index = std::remove_pointer_t<decltype(index)>;
+            sort_cells<Index, Value>(
+                batches,
+                value_column,
+                major,
+                minor,
+                n_major,
+                num_partitions,
+                context,
+                (Index*)result->indptr_.data(),
+                (Index*)result->indices_.data(),
+                (Value*)result->data_.data());
+        };
+        if (narrow) {
+            sort((int32_t*)nullptr);
+        } else {
+            sort((int64_t*)nullptr);
+        }
+    });
+
+    LOG_DEBUG(fmt::format(
+        "[CompressedMatrix] Built {}x{} matrix with {} entries in {} "
+        "partitions",
+        n_major,
+        n_minor,
+        num_cells,
+        num_partitions));
+    return result;
+}
+
+}  // namespace tiledbsoma
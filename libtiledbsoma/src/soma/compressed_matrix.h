@@ -0,0 +1,189 @@
+/**
+ * @file   compressed_matrix.h
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2024 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *   This declares the CompressedMatrix class, which builds a CSR or CSC
+ *   matrix from the coordinate and value buffers of sparse reads.
+ */
+
+#ifndef SOMA_COMPRESSED_MATRIX_H
+#define SOMA_COMPRESSED_MATRIX_H
+
+#include <tiledb/tiledb>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "span/span.hpp"
+
+namespace tiledbsoma {
+
+class ArrayBuffers;
+class IntIndexer;
+class SOMAContext;
+
+/**
+ * @brief A compressed sparse matrix, stored as `indptr`, `indices` and `data`
+ * buffers in the layout of scipy and Matrix: the entries of major index `i`
+ * are at positions [indptr[i], indptr[i + 1]), with their minor indices in
+ * increasing order. With rows as the major axis the matrix is CSR, with
+ * columns it is CSC.
+ *
+ * `indptr` and `indices` share one integer type: int32 when the number of
+ * entries and the minor extent both fit, else int64. `data` has the type of
+ * the value column.
+ */
+class CompressedMatrix {
+   public:
+    //===================================================================
+    //= public static
+    //===================================================================
+
+    /**
+     * @brief Build a compressed matrix from the cells of one or more read
+     * batches, with a parallel counting sort on the major coordinates.
+     *
+     * Coordinates are int64 dimensions. With an indexer, a coordinate is
+     * replaced by its position in the indexer, else it is used as is; either
+     * way it must fall in [0, extent) of its axis. Entries of a major index
+     * keep the order in which they were read, and are only sorted by minor
+     * index when that order differs.
+     *
+     * @param batches Read batches holding the three columns
+     * @param major_dim Dimension giving the major index
+     * @param minor_dim Dimension giving the minor index
+     * @param value_column Fixed-size, non-nullable column giving the values
+     * @param n_major Extent of the major axis
+     * @param n_minor Extent of the minor axis
+     * @param major_indexer Indexer applied to the major coordinates, or
+     * nullptr
+     * @param minor_indexer Indexer applied to the minor coordinates, or
+     * nullptr
+     * @param ctx Context whose thread pool runs the sort, or nullptr to run
+     * on the calling thread
+     */
+    static std::shared_ptr<CompressedMatrix> from_coo(
+        const std::vector<std::shared_ptr<ArrayBuffers>>& batches,
+        const std::string& major_dim,
+        const std::string& minor_dim,
+        const std::string& value_column,
+        uint64_t n_major,
+        uint64_t n_minor,
+        std::shared_ptr<IntIndexer> major_indexer = nullptr,
+        std::shared_ptr<IntIndexer> minor_indexer = nullptr,
+        std::shared_ptr<SOMAContext> ctx = nullptr);
+
+    //===================================================================
+    //= public non-static
+    //===================================================================
+
+    CompressedMatrix(const CompressedMatrix&) = delete;
+    CompressedMatrix& operator=(const CompressedMatrix&) = delete;
+
+    /**
+     * @brief Return the extent of the major axis.
+     */
+    uint64_t n_major() const {
+        return n_major_;
+    }
+
+    /**
+     * @brief Return the extent of the minor axis.
+     */
+    uint64_t n_minor() const {
+        return n_minor_;
+    }
+
+    /**
+     * @brief Return the number of entries.
+     */
+    uint64_t nnz() const {
+        return nnz_;
+    }
+
+    /**
+     * @brief Return the type of `indptr` and `indices`, TILEDB_INT32 or
+     * TILEDB_INT64.
+     */
+    tiledb_datatype_t index_type() const {
+        return index_type_;
+    }
+
+    /**
+     * @brief Return the type of `data`.
+     */
+    tiledb_datatype_t data_type() const {
+        return data_type_;
+    }
+
+    /**
+     * @brief Return the `n_major() + 1` entry offsets, as `index_type()`.
+     */
+    tcb::span<std::byte> indptr() {
+        return indptr_;
+    }
+
+    /**
+     * @brief Return the `nnz()` minor indices, as `index_type()`.
+     */
+    tcb::span<std::byte> indices() {
+        return indices_;
+    }
+
+    /**
+     * @brief Return the `nnz()` values, as `data_type()`.
+     */
+    tcb::span<std::byte> data() {
+        return data_;
+    }
+
+   private:
+    //===================================================================
+    //= private non-static
+    //===================================================================
+
+    CompressedMatrix() = default;
+
+    uint64_t n_major_ = 0;
+    uint64_t n_minor_ = 0;
+    uint64_t nnz_ = 0;
+
+    tiledb_datatype_t index_type_ = TILEDB_INT64;
+    tiledb_datatype_t data_type_ = TILEDB_ANY;
+
+    std::vector<std::byte> indptr_;
+    std::vector<std::byte> indices_;
+    std::vector<std::byte> data_;
+};
+
+}  // namespace tiledbsoma
+
+#endif  // SOMA_COMPRESSED_MATRIX_H
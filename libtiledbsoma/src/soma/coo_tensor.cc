@@ -0,0 +1,155 @@
+/**
+ * @file   coo_tensor.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2024 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *   This file defines the COOTensor class.
+ */
+
+#include "coo_tensor.h"
+#include <cstring>
+#include <functional>
+#include "../utils/logger.h"
+#include "../utils/stats.h"
+#include "array_buffers.h"
+#include "soma_context.h"
+
+namespace tiledbsoma {
+
+using namespace tiledb;
+
+namespace {
+
+// Minimum number of cells per parallel task of the interleaving pass
+constexpr size_t CELL_GRAIN_SIZE = 1 << 16;
+
+}  // namespace
+
+//===================================================================
+//= public static
+//===================================================================
+
+std::shared_ptr<COOTensor> COOTensor::from_batches(
+    const std::vector<std::shared_ptr<ArrayBuffers>>& batches,
+    const std::vector<std::string>& dims,
+    const std::string& value_column,
+    std::shared_ptr<SOMAContext> ctx) {
+    stats::ScopedTimer timer("soma.coo_tensor.from_batches");
+    if (batches.empty()) {
+        throw TileDBSOMAError("[COOTensor] At least one batch is required");
+    }
+    if (dims.empty()) {
+        throw TileDBSOMAError("[COOTensor] At least one dimension is required");
+    }
+
+    // Check the columns, and count the cells
+    auto first = batches.front()->at(value_column);
+    uint64_t num_cells = 0;
+    for (const auto& batch : batches) {
+        auto column = batch->at(value_column);
+        if (column->is_var() || column->is_nullable() ||
+            column->type() != first->type()) {
+            throw TileDBSOMAError(fmt::format(
+                "[COOTensor] Value column '{}' must be fixed-size, "
+                "non-nullable and of the same type in every batch",
+                value_column));
+        }
+        for (const auto& dim : dims) {
+            auto coords = batch->at(dim);
+            if (coords->type() != TILEDB_INT64 || coords->is_nullable()) {
+                throw TileDBSOMAError(fmt::format(
+                    "[COOTensor] Dimension '{}' must be non-nullable int64",
+                    dim));
+            }
+        }
+        num_cells += column->size();
+    }
+    stats::add_counter("soma.coo_tensor.cells", num_cells);
+
+    auto result = std::shared_ptr<COOTensor>(new COOTensor());
+    result->nnz_ = num_cells;
+    result->ndim_ = dims.size();
+    result->data_type_ = first->type();
+    result->coords_.resize(num_cells * dims.size());
+
+    // Interleave each batch's dimensions into its rows of the coordinate
+    // matrix. Each task writes whole rows, so tasks never share a cache
+    // line of the output except at their ends.
+    size_t ndim = dims.size();
+    uint64_t offset = 0;
+    for (const auto& batch : batches) {
+        std::vector<const int64_t*> columns;
+        for (const auto& dim : dims) {
+            columns.push_back(batch->at(dim)->data<int64_t>().data());
+        }
+        int64_t* rows = result->coords_.data() + offset * ndim;
+        auto interleave = [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                for (size_t d = 0; d < ndim; d++) {
+                    rows[i * ndim + d] = columns[d][i];
+                }
+            }
+        };
+        size_t size = batch->at(value_column)->size();
+        if (ctx == nullptr) {
+            interleave(0, size);
+        } else {
+            ctx->parallel_for(0, size, CELL_GRAIN_SIZE, interleave);
+        }
+        offset += size;
+    }
+
+    // Column buffers view their data as cells of the requested type, so the
+    // values are addressed in bytes from the start of each buffer
+    uint64_t value_size = tiledb::impl::type_size(result->data_type_);
+    if (batches.size() == 1) {
+        result->values_ = first;
+        result->data_view_ = tcb::span<std::byte>(
+            first->data<std::byte>().data(), num_cells * value_size);
+    } else {
+        result->data_.resize(num_cells * value_size);
+        offset = 0;
+        for (const auto& batch : batches) {
+            auto column = batch->at(value_column);
+            std::memcpy(
+                result->data_.data() + offset,
+                column->data<std::byte>().data(),
+                column->size() * value_size);
+            offset += column->size() * value_size;
+        }
+        result->data_view_ = tcb::span<std::byte>(result->data_);
+    }
+
+    LOG_DEBUG(fmt::format(
+        "[COOTensor] Built {}-d tensor with {} entries from {} batches",
+        ndim,
+        num_cells,
+        batches.size()));
+    return result;
+}
+
+}  // namespace tiledbsoma
@@ -0,0 +1,149 @@
+/**
+ * @file   coo_tensor.h
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2024 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *   This declares the COOTensor class, which builds a sparse tensor in
+ *   coordinate format from the coordinate and value buffers of sparse reads.
+ */
+
+#ifndef SOMA_COO_TENSOR_H
+#define SOMA_COO_TENSOR_H
+
+#include <tiledb/tiledb>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "span/span.hpp"
+
+namespace tiledbsoma {
+
+class ArrayBuffers;
+class ColumnBuffer;
+class SOMAContext;
+
+/**
+ * @brief A sparse tensor in coordinate (COO) format, in the layout of
+ * pyarrow's SparseCOOTensor: an `nnz() x ndim()` row-major matrix of int64
+ * coordinates, whose row `i` holds the coordinates of value `i`.
+ */
+class COOTensor {
+   public:
+    //===================================================================
+    //= public static
+    //===================================================================
+
+    /**
+     * @brief Build a tensor from the cells of one or more read batches,
+     * interleaving the dimensions into the coordinate matrix in one parallel
+     * pass.
+     *
+     * The values of a single batch are viewed in its column buffer without a
+     * copy; those of several batches are concatenated.
+     *
+     * @param batches Read batches holding the dimensions and value column
+     * @param dims Non-nullable int64 dimensions, in tensor axis order
+     * @param value_column Fixed-size, non-nullable column giving the values
+     * @param ctx Context whose thread pool interleaves the coordinates, or
+     * nullptr to run on the calling thread
+     */
+    static std::shared_ptr<COOTensor> from_batches(
+        const std::vector<std::shared_ptr<ArrayBuffers>>& batches,
+        const std::vector<std::string>& dims,
+        const std::string& value_column,
+        std::shared_ptr<SOMAContext> ctx = nullptr);
+
+    //===================================================================
+    //= public non-static
+    //===================================================================
+
+    COOTensor(const COOTensor&) = delete;
+    COOTensor& operator=(const COOTensor&) = delete;
+
+    /**
+     * @brief Return the number of values.
+     */
+    uint64_t nnz() const {
+        return nnz_;
+    }
+
+    /**
+     * @brief Return the number of dimensions.
+     */
+    size_t ndim() const {
+        return ndim_;
+    }
+
+    /**
+     * @brief Return the type of `data`.
+     */
+    tiledb_datatype_t data_type() const {
+        return data_type_;
+    }
+
+    /**
+     * @brief Return the `nnz() * ndim()` coordinates, row-major.
+     */
+    tcb::span<int64_t> coords() {
+        return coords_;
+    }
+
+    /**
+     * @brief Return the `nnz()` values, as `data_type()`.
+     */
+    tcb::span<std::byte> data() {
+        return data_view_;
+    }
+
+   private:
+    //===================================================================
+    //= private non-static
+    //===================================================================
+
+    COOTensor() = default;
+
+    uint64_t nnz_ = 0;
+    size_t ndim_ = 0;
+
+    tiledb_datatype_t data_type_ = TILEDB_ANY;
+
+    std::vector<int64_t> coords_;
+
+    // Values: viewed in the column buffer of a single batch, else copied
+    // into data_
+    std::shared_ptr<ColumnBuffer> values_;
+    std::vector<std::byte> data_;
+    tcb::span<std::byte> data_view_;
+};
+
+}  // namespace tiledbsoma
+
+#endif  // SOMA_COO_TENSOR_H
@@ -43,4 +43,25 @@ enum class ResultOrder { automatic = 0, rowmajor, colmajor };
 /** Defines whether the SOMAGroup URI is absolute or relative */
 enum class URIType { automatic = 0, absolute, relative };
 
+/** Defines the aggregate computed by SOMAArray::aggregate */
+enum class AggregateOp { count = 0, sum, mean, min, max };
+
+/** Defines the order in which a PartitionedScan returns its batches */
+enum class ScanOrder { arbitrary = 0, range };
+
+/** Defines the columns read when no columns are selected: all columns, the
+ * attributes only, the dimensions only, or only the number of cells */
+enum class Projection { all = 0, values, coordinates, count };
+
+/** Defines the comparison made by a ValueFilter */
+enum class CompareOp { eq = 0, ne, lt, le, gt, ge };
+
+/** Defines the arithmetic operation computed by a ValueExpr */
+enum class ArithmeticOp { add = 0, sub, mul, div };
+
+/** Defines the Arrow layout of exported string and binary columns: 64-bit
+ * offsets (large_utf8), 32-bit offsets when the data fits (utf8), or views
+ * into the data when it fits (utf8_view) */
+enum class StringLayout { large = 0, compact, view };
+
 #endif  // SOMA_ENUMS
\ No newline at end of file
@@ -33,12 +33,393 @@
 #include "managed_query.h"
 #include <tiledb/array_experimental.h>
 #include <tiledb/attribute_experimental.h>
+#include <tiledb/tiledb_experimental>
+#include <unordered_map>
+#include "../reindexer/reindexer.h"
 #include "../utils/logger.h"
+#include "../utils/stats.h"
+#include "../utils/util.h"
 #include "utils/common.h"
+#include "value_filter.h"
 namespace tiledbsoma {
 
 using namespace tiledb;
 
+namespace {
+
+// Type, variable length and nullability of a dimension or attribute
+struct ColumnInfo {
+    tiledb_datatype_t type;
+    bool is_var;
+    bool is_nullable;
+};
+
+ColumnInfo column_info(const ArraySchema& schema, const std::string& name) {
+    if (schema.has_attribute(name)) {
+        auto attr = schema.attribute(name);
+        bool is_var = attr.cell_val_num() == TILEDB_VAR_NUM;
+        return {attr.type(), is_var, attr.nullable()};
+    }
+    if (schema.domain().has_dimension(name)) {
+        auto dim = schema.domain().dimension(name);
+        bool is_var = dim.cell_val_num() == TILEDB_VAR_NUM ||
+                      dim.type() == TILEDB_STRING_ASCII ||
+                      dim.type() == TILEDB_STRING_UTF8;
+        return {dim.type(), is_var, false};
+    }
+    throw TileDBSOMAError("[ManagedQuery] Column name not found: " + name);
+}
+
+std::string aggregate_name(AggregateOp op) {
+    switch (op) {
+        case AggregateOp::count:
+            return "count";
+        case AggregateOp::sum:
+            return "sum";
+        case AggregateOp::mean:
+            return "mean";
+        case AggregateOp::min:
+            return "min";
+        case AggregateOp::max:
+            return "max";
+    }
+    throw TileDBSOMAError("[ManagedQuery] Unknown aggregate operation");
+}
+
+// Running aggregates of the values of one group
+template <typename T>
+struct Accumulator {
+    // Sums widen like TileDB's sum aggregate
+    using Sum = std::conditional_t<
+        std::is_floating_point_v<T>,
+        double,
+        std::conditional_t<std::is_signed_v<T>, int64_t, uint64_t>>;
+
+    uint64_t num_cells = 0;
+    uint64_t num_values = 0;
+    Sum sum = 0;
+    T min = std::numeric_limits<T>::max();
+    T max = std::numeric_limits<T>::lowest();
+
+    // Integer sums saturate at the limits of their type on overflow and
+    // stay there, as TileDB's sum aggregate does, so that the scan and the
+    // pushed-down aggregate agree
+    bool saturated = false;
+
+    // Means are taken over a float64 total, which does not saturate
+    double total = 0;
+
+    void add(T value) {
+        num_values++;
+        add_to_sum(static_cast<Sum>(value));
+        total += static_cast<double>(value);
+        min = std::min(min, value);
+        max = std::max(max, value);
+    }
+
+    void add_to_sum(Sum value) {
+        if constexpr (std::is_floating_point_v<Sum>) {
+            sum += value;
+        } else {
+            if (saturated) {
+                return;
+            }
+            constexpr Sum sum_max = std::numeric_limits<Sum>::max();
+            if (value > 0 && sum > sum_max - value) {
+                sum = sum_max;
+                saturated = true;
+                return;
+            }
+            if constexpr (std::is_signed_v<Sum>) {
+                constexpr Sum sum_min = std::numeric_limits<Sum>::lowest();
+                if (value < 0 && sum < sum_min - value) {
+                    sum = sum_min;
+                    saturated = true;
+                    return;
+                }
+            }
+            sum += value;
+        }
+    }
+};
+
+// Build a single result column from a value and validity per row
+template <typename V>
+std::shared_ptr<ColumnBuffer> make_column(
+    const std::string& name,
+    tiledb_datatype_t type,
+    std::vector<V>& values,
+    std::optional<std::vector<uint8_t>> validity = std::nullopt) {
+    auto column = std::make_shared<ColumnBuffer>(
+        name,
+        type,
+        values.size(),
+        values.size() * sizeof(V),
+        false,
+        validity.has_value());
+    if (validity) {
+        ColumnBuffer::to_bitmap(*validity);
+        column->set_data(
+            values.size(),
+            values.data(),
+            static_cast<uint64_t*>(nullptr),
+            validity->data());
+    } else {
+        column->set_data(values.size(), values.data());
+    }
+    return column;
+}
+
+// Build the aggregate column from one accumulator per output row
+template <typename T>
+std::shared_ptr<ColumnBuffer> aggregate_column(
+    AggregateOp op,
+    tiledb_datatype_t type,
+    const std::vector<const Accumulator<T>*>& accumulators) {
+    auto name = aggregate_name(op);
+    size_t num_rows = accumulators.size();
+    std::vector<uint8_t> validity(num_rows);
+    for (size_t i = 0; i < num_rows; i++) {
+        validity[i] = accumulators[i]->num_values > 0;
+    }
+
+    switch (op) {
+        case AggregateOp::count: {
+            std::vector<uint64_t> values(num_rows);
+            for (size_t i = 0; i < num_rows; i++) {
+                values[i] = accumulators[i]->num_cells;
+            }
+            return make_column(name, TILEDB_UINT64, values);
+        }
+        case AggregateOp::sum: {
+            using Sum = typename Accumulator<T>::Sum;
+            std::vector<Sum> values(num_rows);
+            for (size_t i = 0; i < num_rows; i++) {
+                values[i] = accumulators[i]->sum;
+            }
+            auto sum_type = std::is_floating_point_v<Sum> ? TILEDB_FLOAT64 :
+                            std::is_signed_v<Sum>         ? TILEDB_INT64 :
+                                                            TILEDB_UINT64;
+            return make_column(name, sum_type, values);
+        }
+        case AggregateOp::mean: {
+            std::vector<double> values(num_rows);
+            for (size_t i = 0; i < num_rows; i++) {
+                values[i] = validity[i] ? accumulators[i]->total /
+                                              accumulators[i]->num_values :
+                                          0;
+            }
+            return make_column(name, TILEDB_FLOAT64, values, validity);
+        }
+        case AggregateOp::min:
+        case AggregateOp::max: {
+            std::vector<T> values(num_rows);
+            for (size_t i = 0; i < num_rows; i++) {
+                if (validity[i]) {
+                    values[i] = op == AggregateOp::min ? accumulators[i]->min :
+                                                         accumulators[i]->max;
+                }
+            }
+            return make_column(name, type, values, validity);
+        }
+    }
+    throw TileDBSOMAError("[ManagedQuery] Unknown aggregate operation");
+}
+
+// Reduce every batch returned by `next_batch` into accumulators
+template <typename T>
+std::shared_ptr<ArrayBuffers> reduce_batches(
+    const std::function<std::shared_ptr<ArrayBuffers>()>& next_batch,
+    const std::string& column,
+    AggregateOp op,
+    tiledb_datatype_t type,
+    const std::optional<std::string>& group_by) {
+    Accumulator<T> total;
+    std::unordered_map<int64_t, Accumulator<T>> groups;
+
+    while (auto batch = next_batch()) {
+        auto buffer = batch->at(column);
+        auto values = buffer->data<T>();
+        std::optional<tcb::span<uint8_t>> validity;
+        if (buffer->is_nullable()) {
+            validity = buffer->validity();
+        }
+        std::optional<tcb::span<int64_t>> keys;
+        if (group_by) {
+            keys = batch->at(*group_by)->data<int64_t>();
+        }
+
+        for (size_t i = 0; i < values.size(); i++) {
+            auto& acc = keys ? groups[(*keys)[i]] : total;
+            acc.num_cells++;
+            if (!validity || (*validity)[i]) {
+                acc.add(values[i]);
+            }
+        }
+    }
+
+    auto results = std::make_shared<ArrayBuffers>();
+    std::vector<const Accumulator<T>*> accumulators;
+    if (group_by) {
+        std::vector<int64_t> keys;
+        keys.reserve(groups.size());
+        for (auto& [key, _] : groups) {
+            keys.push_back(key);
+        }
+        std::sort(keys.begin(), keys.end());
+        for (auto key : keys) {
+            accumulators.push_back(&groups[key]);
+        }
+        results->emplace(*group_by, make_column(*group_by, TILEDB_INT64, keys));
+    } else {
+        accumulators.push_back(&total);
+    }
+    results->emplace(
+        aggregate_name(op), aggregate_column<T>(op, type, accumulators));
+    return results;
+}
+
+// Coalesce sorted, unique points into ranges of consecutive values
+template <typename T>
+std::vector<std::pair<T, T>> coalesce_sorted_points(
+    const std::vector<T>& points) {
+    std::vector<std::pair<T, T>> ranges;
+    for (auto& point : points) {
+        if (!ranges.empty() &&
+            ranges.back().second != std::numeric_limits<T>::max() &&
+            ranges.back().second + 1 == point) {
+            ranges.back().second = point;
+        } else {
+            ranges.emplace_back(point, point);
+        }
+    }
+    return ranges;
+}
+
+// Merge sorted, disjoint ranges across their smallest gaps until at most
+// `max_ranges` remain
+template <typename T>
+std::vector<std::pair<T, T>> merge_ranges(
+    const std::vector<std::pair<T, T>>& ranges, size_t max_ranges) {
+    if (ranges.size() <= std::max<size_t>(max_ranges, 1)) {
+        return ranges;
+    }
+
+    // Keep the max_ranges - 1 widest gaps, close all the others
+    std::vector<size_t> gaps(ranges.size() - 1);
+    for (size_t i = 0; i < gaps.size(); i++) {
+        gaps[i] = i;
+    }
+    auto gap_width = [&ranges](size_t i) {
+        return static_cast<uint64_t>(ranges[i + 1].first) -
+               static_cast<uint64_t>(ranges[i].second);
+    };
+    auto num_kept = std::max<size_t>(max_ranges, 1) - 1;
+    std::nth_element(
+        gaps.begin(),
+        gaps.begin() + num_kept,
+        gaps.end(),
+        [&gap_width](size_t a, size_t b) {
+            return gap_width(a) > gap_width(b);
+        });
+    std::vector<bool> split(ranges.size(), false);
+    for (size_t i = 0; i < num_kept; i++) {
+        split[gaps[i]] = true;
+    }
+
+    std::vector<std::pair<T, T>> merged;
+    merged.push_back(ranges[0]);
+    for (size_t i = 1; i < ranges.size(); i++) {
+        if (split[i - 1]) {
+            merged.push_back(ranges[i]);
+        } else {
+            merged.back().second = ranges[i].second;
+        }
+    }
+    return merged;
+}
+
+}  // namespace
+
+//===================================================================
+//= private classes
+//===================================================================
+
+// The ranges selected on a dimension, as requested rather than as added to
+// the subarray. When the ranges of many points are merged, the results of
+// the dimension are filtered down to these.
+class ManagedQuery::DimSelection {
+   public:
+    virtual ~DimSelection() = default;
+
+    // Clear the keep flag of the result cells outside the selected ranges
+    virtual void filter(ColumnBuffer& buffer, std::vector<uint8_t>& keep) = 0;
+};
+
+// Ranges widened to int64_t or uint64_t, which hold the values of any
+// signed or unsigned integral dimension
+template <typename T>
+class ManagedQuery::TypedDimSelection : public ManagedQuery::DimSelection {
+   public:
+    void add(const std::vector<std::pair<T, T>>& ranges) {
+        ranges_.insert(ranges_.end(), ranges.begin(), ranges.end());
+        is_normalized_ = false;
+    }
+
+    void filter(ColumnBuffer& buffer, std::vector<uint8_t>& keep) override {
+        normalize();
+        util::visit_numeric_type(buffer.type(), [&](auto t) {
+            using V = decltype(t);
+            if constexpr (std::is_integral_v<V>) {
+                auto values = buffer.data<V>();
+                for (size_t i = 0; i < values.size(); i++) {
+                    if (keep[i] && !contains(static_cast<T>(values[i]))) {
+                        keep[i] = 0;
+                    }
+                }
+            } else {
+                throw TileDBSOMAError(fmt::format(
+                    "[ManagedQuery] Cannot filter the non-integral "
+                    "dimension '{}' by its selected ranges",
+                    buffer.name()));
+            }
+        });
+    }
+
+   private:
+    // Sort the ranges and merge the overlapping ones, once per change
+    void normalize() {
+        if (is_normalized_) {
+            return;
+        }
+        std::sort(ranges_.begin(), ranges_.end());
+        std::vector<std::pair<T, T>> merged;
+        for (auto& range : ranges_) {
+            if (!merged.empty() && range.first <= merged.back().second) {
+                merged.back().second = std::max(
+                    merged.back().second, range.second);
+            } else {
+                merged.push_back(range);
+            }
+        }
+        ranges_ = std::move(merged);
+        is_normalized_ = true;
+    }
+
+    bool contains(T value) const {
+        // The last range starting at or before the value
+        auto it = std::upper_bound(
+            ranges_.begin(),
+            ranges_.end(),
+            value,
+            [](T v, const std::pair<T, T>& range) { return v < range.first; });
+        return it != ranges_.begin() && value <= std::prev(it)->second;
+    }
+
+    std::vector<std::pair<T, T>> ranges_;
+    bool is_normalized_ = true;
+};
+
 //===================================================================
 //= public non-static
 //===================================================================
@@ -55,20 +436,50 @@ ManagedQuery::ManagedQuery(
 }
 
 void ManagedQuery::close() {
+    wait_for_submit();
     array_->close();
 }
 
 void ManagedQuery::reset() {
+    wait_for_submit();
     query_ = std::make_unique<Query>(*ctx_, *array_);
     subarray_ = std::make_unique<Subarray>(*ctx_, *array_);
 
+    condition_.reset();
     subarray_range_set_ = false;
     subarray_range_empty_ = {};
     columns_.clear();
+    projection_ = Projection::all;
+    limit_.reset();
+    string_layout_ = StringLayout::large;
     results_complete_ = true;
     total_num_cells_ = 0;
     buffers_.reset();
+    buffer_sizes_.clear();
     query_submitted_ = false;
+    dim_indexers_.clear();
+    dim_selections_.clear();
+    point_filters_.clear();
+    filter_buffers_.reset();
+    value_filter_.reset();
+}
+
+void ManagedQuery::copy_selection(const ManagedQuery& other) {
+    // The subarray is copied into the TileDB query when it is set, so the
+    // two queries can share it
+    subarray_ = std::make_unique<Subarray>(*other.subarray_);
+    subarray_range_set_ = other.subarray_range_set_;
+    subarray_range_empty_ = other.subarray_range_empty_;
+    condition_ = other.condition_;
+    if (condition_) {
+        query_->set_condition(*condition_);
+    }
+    query_->set_layout(other.query_->query_layout());
+    max_ranges_ = other.max_ranges_;
+    dim_selections_ = other.dim_selections_;
+    point_filters_ = other.point_filters_;
+    value_filter_ = other.value_filter_;
+    limit_ = other.limit_;
 }
 
 void ManagedQuery::select_columns(
@@ -93,6 +504,43 @@ void ManagedQuery::select_columns(
     }
 }
 
+void ManagedQuery::set_dim_indexer(
+    const std::string& dim, std::shared_ptr<IntIndexer> indexer) {
+    if (!schema_->domain().has_dimension(dim)) {
+        throw TileDBSOMAError(fmt::format(
+            "[ManagedQuery] [{}] Dimension '{}' does not exist", name_, dim));
+    }
+    if (schema_->domain().dimension(dim).type() != TILEDB_INT64) {
+        throw TileDBSOMAError(fmt::format(
+            "[ManagedQuery] [{}] Dimension '{}' must be int64 to be "
+            "re-indexed",
+            name_,
+            dim));
+    }
+    if (indexer == nullptr) {
+        dim_indexers_.erase(dim);
+    } else if (indexer->size() == 0) {
+        throw TileDBSOMAError(fmt::format(
+            "[ManagedQuery] [{}] The indexer of dimension '{}' has no keys; "
+            "call map_locations before setting it",
+            name_,
+            dim));
+    } else {
+        dim_indexers_[dim] = indexer;
+    }
+}
+
+void ManagedQuery::set_max_ranges(size_t max_ranges) {
+    // Selections made before are neither merged nor recorded for the filter
+    if (subarray_range_set_) {
+        throw TileDBSOMAError(fmt::format(
+            "[ManagedQuery] [{}] The maximum number of ranges must be set "
+            "before selecting ranges or points",
+            name_));
+    }
+    max_ranges_ = max_ranges;
+}
+
 void ManagedQuery::set_column_data(
     std::shared_ptr<ColumnBuffer> column_buffer) {
     auto column_name = std::string(column_buffer->name());
@@ -222,50 +670,250 @@ void ManagedQuery::setup_read() {
         return;
     }
 
-    // If the query is uninitialized, set the subarray for the query
+    init_columns();
+
+    // If the query is uninitialized, set the subarray for the query and
+    // size the buffers for its results
     if (status == Query::Status::UNINITIALIZED) {
-        // Dense array must have a subarray set. If the array is dense and no
-        // ranges have been set, add a range for the array's entire non-empty
-        // domain on dimension 0.
-        if (array_->schema().array_type() == TILEDB_DENSE &&
-            !subarray_range_set_) {
-            auto non_empty_domain = array_->non_empty_domain<int64_t>(0);
-            subarray_->add_range(
-                0, non_empty_domain.first, non_empty_domain.second);
+        init_subarray();
+        init_buffer_sizes();
+    }
 
-            LOG_DEBUG(fmt::format(
-                "[ManagedQuery] Add full NED range to dense subarray = (0, {}, "
-                "{})",
-                non_empty_domain.first,
-                non_empty_domain.second));
-        }
+    alloc_buffers();
+}
 
-        // Set the subarray for range slicing
-        query_->set_subarray(*subarray_);
+std::map<std::string, ResultSizeEstimate>
+ManagedQuery::estimate_result_sizes() {
+    if (query_->query_status() != Query::Status::UNINITIALIZED) {
+        throw TileDBSOMAError(fmt::format(
+            "[ManagedQuery] [{}] Result sizes can only be estimated before "
+            "the query is submitted",
+            name_));
     }
 
-    // If no columns were selected, select all columns.
-    // Add dims and attrs in the same order as specified in the schema
-    if (columns_.empty()) {
-        if (array_->schema().array_type() == TILEDB_SPARSE) {
-            for (const auto& dim : array_->schema().domain().dimensions()) {
-                columns_.push_back(dim.name());
+    init_columns();
+    auto names = columns_;
+    for (auto& name : hidden_filter_columns()) {
+        names.push_back(name);
+    }
+    std::map<std::string, ResultSizeEstimate> estimates;
+    if (is_empty_query()) {
+        for (const auto& name : names) {
+            estimates[name] = ResultSizeEstimate{};
+        }
+        return estimates;
+    }
+
+    init_subarray();
+    for (const auto& name : names) {
+        auto [type, is_var, is_nullable] = column_info(*schema_, name);
+        ResultSizeEstimate estimate;
+        if (is_var) {
+            // Offsets are estimated in bytes, one uint64_t per cell
+            uint64_t offsets_bytes;
+            if (is_nullable) {
+                auto sizes = query_->est_result_size_var_nullable(name);
+                offsets_bytes = sizes[0];
+                estimate.data_bytes = sizes[1];
+            } else {
+                auto sizes = query_->est_result_size_var(name);
+                offsets_bytes = sizes[0];
+                estimate.data_bytes = sizes[1];
             }
+            estimate.num_cells = offsets_bytes / sizeof(uint64_t);
+        } else {
+            estimate.data_bytes = is_nullable ?
+                                      query_->est_result_size_nullable(
+                                          name)[0] :
+                                      query_->est_result_size(name);
+            estimate.num_cells = estimate.data_bytes /
+                                 tiledb::impl::type_size(type);
+        }
+        estimates[name] = estimate;
+    }
+    return estimates;
+}
+
+void ManagedQuery::init_subarray() {
+    // Dense array must have a subarray set. If the array is dense and no
+    // ranges have been set, read the array's entire non-empty domain on
+    // dimension 0. A separate subarray is used so that this may be called
+    // more than once and ranges selected later are not merged with it.
+    if (array_->schema().array_type() == TILEDB_DENSE && !subarray_range_set_) {
+        auto non_empty_domain = array_->non_empty_domain<int64_t>(0);
+        Subarray subarray(*ctx_, *array_);
+        subarray.add_range(0, non_empty_domain.first, non_empty_domain.second);
+
+        LOG_DEBUG(fmt::format(
+            "[ManagedQuery] Add full NED range to dense subarray = (0, {}, "
+            "{})",
+            non_empty_domain.first,
+            non_empty_domain.second));
+
+        query_->set_subarray(subarray);
+        return;
+    }
+
+    // Set the subarray for range slicing
+    query_->set_subarray(*subarray_);
+}
+
+void ManagedQuery::init_columns() {
+    if (!columns_.empty()) {
+        return;
+    }
+
+    // Add dims and attrs in the same order as specified in the schema. Dense
+    // arrays only return coordinates when asked for them.
+    bool add_dims = projection_ == Projection::coordinates ||
+                    (projection_ == Projection::all &&
+                     array_->schema().array_type() == TILEDB_SPARSE);
+    bool add_attrs = projection_ == Projection::all ||
+                     projection_ == Projection::values;
+    if (add_dims) {
+        for (const auto& dim : array_->schema().domain().dimensions()) {
+            columns_.push_back(dim.name());
         }
+    }
+    if (add_attrs) {
         int attribute_num = array_->schema().attribute_num();
         for (int i = 0; i < attribute_num; i++) {
             columns_.push_back(array_->schema().attribute(i).name());
         }
     }
+}
+
+std::vector<std::string> ManagedQuery::hidden_filter_columns() const {
+    std::vector<std::string> filtered(
+        point_filters_.begin(), point_filters_.end());
+    if (value_filter_ != nullptr) {
+        for (auto& name : value_filter_->columns()) {
+            filtered.push_back(name);
+        }
+    }
+    std::vector<std::string> names;
+    for (auto& name : filtered) {
+        if (std::find(columns_.begin(), columns_.end(), name) ==
+                columns_.end() &&
+            std::find(names.begin(), names.end(), name) == names.end()) {
+            names.push_back(name);
+        }
+    }
+    return names;
+}
+
+void ManagedQuery::init_buffer_sizes() {
+    buffer_sizes_.clear();
+
+    auto config = ctx_->config();
+    if (config.contains(CONFIG_KEY_ESTIMATE_BUFFER_SIZES) &&
+        config.get(CONFIG_KEY_ESTIMATE_BUFFER_SIZES) == "false") {
+        return;
+    }
+    if (is_empty_query()) {
+        return;
+    }
+
+    // Fall back to the configured size if TileDB cannot estimate the query
+    std::map<std::string, ResultSizeEstimate> estimates;
+    try {
+        estimates = estimate_result_sizes();
+    } catch (const TileDBError& e) {
+        LOG_DEBUG(fmt::format(
+            "[ManagedQuery] [{}] Result size estimate failed: {}",
+            name_,
+            e.what()));
+        return;
+    }
+
+    // Estimates are clamped to the configured buffer size, which remains
+    // the upper bound on the memory used by each column
+    size_t max_bytes = ColumnBuffer::alloc_bytes(config);
+    size_t min_bytes = std::min(MIN_ESTIMATED_BUFFER_BYTES, max_bytes);
+    for (const auto& [name, estimate] : estimates) {
+        auto [type, is_var, is_nullable] = column_info(*schema_, name);
+        size_t num_bytes = std::clamp<size_t>(
+            estimate.data_bytes, min_bytes, max_bytes);
+
+        // Without filters, a limited read needs no room for more cells
+        size_t type_size = tiledb::impl::type_size(type);
+        if (limit_ && !is_var && point_filters_.empty() &&
+            value_filter_ == nullptr && *limit_ < num_bytes / type_size) {
+            num_bytes = std::max<size_t>(*limit_ * type_size, min_bytes);
+        }
+        size_t num_cells = is_var ?
+                               std::clamp<size_t>(
+                                   estimate.num_cells,
+                                   min_bytes / sizeof(uint64_t),
+                                   max_bytes / sizeof(uint64_t)) :
+                               num_bytes / type_size;
+        buffer_sizes_[name] = {num_cells, num_bytes};
+
+        LOG_DEBUG(fmt::format(
+            "[ManagedQuery] [{}] Estimated buffer for column '{}': cells={} "
+            "bytes={}",
+            name_,
+            name,
+            num_cells,
+            num_bytes));
+    }
+}
+
+bool ManagedQuery::grow_buffer_sizes() {
+    size_t max_bytes = ColumnBuffer::alloc_bytes(ctx_->config());
+    bool grown = false;
+    for (auto& [name, size] : buffer_sizes_) {
+        auto& [num_cells, num_bytes] = size;
+        auto [type, is_var, is_nullable] = column_info(*schema_, name);
+
+        size_t new_bytes = std::min<size_t>(
+            std::max<size_t>(2 * num_bytes, 1), max_bytes);
+        size_t new_cells = is_var ?
+                               std::min<size_t>(
+                                   std::max<size_t>(2 * num_cells, 1),
+                                   max_bytes / sizeof(uint64_t)) :
+                               new_bytes / tiledb::impl::type_size(type);
+        grown |= new_bytes != num_bytes || new_cells != num_cells;
+        num_bytes = new_bytes;
+        num_cells = new_cells;
+    }
+    return grown;
+}
 
-    // Allocate and attach buffers
+void ManagedQuery::alloc_buffers() {
     LOG_TRACE("[ManagedQuery] allocate new buffers");
     buffers_ = std::make_shared<ArrayBuffers>();
+    filter_buffers_ = std::make_shared<ArrayBuffers>();
+    for (auto& name : hidden_filter_columns()) {
+        LOG_DEBUG(fmt::format(
+            "[ManagedQuery] [{}] Adding filter buffer for column '{}'",
+            name_,
+            name));
+        std::optional<std::pair<size_t, size_t>> size = std::nullopt;
+        if (auto it = buffer_sizes_.find(name); it != buffer_sizes_.end()) {
+            size = it->second;
+        }
+        auto buffer = ColumnBuffer::create(array_, name, size);
+        buffer->attach(*query_);
+        filter_buffers_->emplace(name, buffer);
+    }
     for (auto& name : columns_) {
         LOG_DEBUG(fmt::format(
             "[ManagedQuery] [{}] Adding buffer for column '{}'", name_, name));
-        buffers_->emplace(name, ColumnBuffer::create(array_, name));
-        buffers_->at(name)->attach(*query_);
+        std::optional<std::pair<size_t, size_t>> size = std::nullopt;
+        if (auto it = buffer_sizes_.find(name); it != buffer_sizes_.end()) {
+            size = it->second;
+        }
+        auto buffer = ColumnBuffer::create(array_, name, size);
+        buffer->set_string_layout(string_layout_);
+        // Batches of a column share the Arrow export plan of the open array
+        auto& plan = export_plans_[name];
+        if (plan == nullptr) {
+            plan = std::make_shared<ArrowExportPlan>();
+        }
+        buffer->set_export_plan(plan);
+        buffer->attach(*query_);
+        buffers_->emplace(name, buffer);
     }
 }
 
@@ -299,6 +947,14 @@ void ManagedQuery::submit_read() {
     });
 }
 
+void ManagedQuery::wait_for_submit() {
+    // A read submitted but never collected, e.g. by a prefetch, must finish
+    // before the query it uses is replaced
+    if (query_future_.valid()) {
+        query_future_.wait();
+    }
+}
+
 std::shared_ptr<ArrayBuffers> ManagedQuery::results() {
     if (is_empty_query()) {
         return buffers_;
@@ -306,7 +962,10 @@ std::shared_ptr<ArrayBuffers> ManagedQuery::results() {
 
     if (query_future_.valid()) {
         LOG_DEBUG(fmt::format("[ManagedQuery] [{}] Waiting for query", name_));
-        query_future_.wait();
+        {
+            stats::ScopedTimer timer("soma.managed_query.submit_wait");
+            query_future_.wait();
+        }
         LOG_DEBUG(
             fmt::format("[ManagedQuery] [{}] Done waiting for query", name_));
 
@@ -330,52 +989,450 @@ std::shared_ptr<ArrayBuffers> ManagedQuery::results() {
             fmt::format("[ManagedQuery] [{}] Query FAILED", name_));
     }
 
+    // Update ColumnBuffer size to match query results
+    auto update_sizes = [&]() {
+        size_t num_cells = 0;
+        for (auto& name : filter_buffers_->names()) {
+            num_cells = filter_buffers_->at(name)->update_size(*query_);
+        }
+        for (auto& name : buffers_->names()) {
+            num_cells = buffers_->at(name)->update_size(*query_);
+            LOG_DEBUG(fmt::format(
+                "[ManagedQuery] [{}] Buffer {} cells={}",
+                name_,
+                name,
+                num_cells));
+        }
+        return num_cells;
+    };
+    size_t num_cells = update_sizes();
+
+    // Buffers sized from an estimate may be too small to hold a single
+    // cell. Grow them, up to the configured size, and resubmit.
+    while (status == Query::Status::INCOMPLETE && !num_cells &&
+           grow_buffer_sizes()) {
+        LOG_DEBUG(fmt::format(
+            "[ManagedQuery] [{}] Retrying with larger buffers", name_));
+        stats::add_counter("soma.managed_query.buffer_retries");
+        alloc_buffers();
+        query_->submit();
+        status = query_->query_status();
+        num_cells = update_sizes();
+    }
+
     // If the query was ever incomplete, the result buffers contents are not
     // complete.
     if (status == Query::Status::INCOMPLETE) {
         results_complete_ = false;
+        stats::add_counter("soma.managed_query.incomplete_reads");
     } else if (status == Query::Status::COMPLETE) {
         results_complete_ = true;
     }
 
-    // Update ColumnBuffer size to match query results
-    size_t num_cells = 0;
-    for (auto& name : buffers_->names()) {
-        num_cells = buffers_->at(name)->update_size(*query_);
-        LOG_DEBUG(fmt::format(
-            "[ManagedQuery] [{}] Buffer {} cells={}", name_, name, num_cells));
+    if (stats::is_enabled()) {
+        uint64_t num_bytes = 0;
+        for (auto& [name, sizes] : query_->result_buffer_elements()) {
+            auto [num_offsets, num_elements] = sizes;
+            auto type_size = tiledb::impl::type_size(
+                std::get<0>(column_info(*schema_, name)));
+            num_bytes += num_offsets * sizeof(uint64_t) +
+                         num_elements * type_size;
+        }
+        stats::add_counter("soma.managed_query.reads");
+        stats::add_counter("soma.managed_query.cells_read", num_cells);
+        stats::add_counter("soma.managed_query.bytes_read", num_bytes);
     }
-    total_num_cells_ += num_cells;
 
-    // TODO: retry the query with larger buffers
     if (status == Query::Status::INCOMPLETE && !num_cells) {
+        stats::add_counter("soma.managed_query.buffers_too_small");
         throw TileDBSOMAError(
             fmt::format("[ManagedQuery] [{}] Buffers are too small.", name_));
     }
 
-    // Visit all attributes and retrieve enumeration vectors
-    auto attribute_map = schema_->attributes();
-    for (auto& nmit : attribute_map) {
-        auto attrname = nmit.first;
-        auto attribute = nmit.second;
-        auto enumname = AttributeExperimental::get_enumeration_name(
-            *ctx_, attribute);
-        if (enumname != std::nullopt) {
-            auto enumeration = ArrayExperimental::get_enumeration(
-                *ctx_, *array_, enumname.value());
-            auto enumvec = enumeration.as_vector<std::string>();
-            if (!buffers_->contains(attrname)) {
-                continue;
+    if (!point_filters_.empty() || value_filter_ != nullptr) {
+        num_cells = filter_results();
+    }
+    if (limit_ && total_num_cells_ + num_cells > *limit_) {
+        num_cells = truncate_results(*limit_ - total_num_cells_);
+    }
+    total_num_cells_ += num_cells;
+
+    // Re-index the coordinates while they are still hot in cache
+    reindex_results();
+
+    return buffers_;
+}
+
+std::vector<std::pair<int64_t, int64_t>> ManagedQuery::coalesce_points(
+    const std::string& dim, std::vector<int64_t> points) {
+    return coalesce_points_impl(dim, std::move(points));
+}
+
+std::vector<std::pair<uint64_t, uint64_t>> ManagedQuery::coalesce_points(
+    const std::string& dim, std::vector<uint64_t> points) {
+    return coalesce_points_impl(dim, std::move(points));
+}
+
+template <typename T>
+std::vector<std::pair<T, T>> ManagedQuery::coalesce_points_impl(
+    const std::string& dim, std::vector<T> points) {
+    auto size = points.size();
+    std::sort(points.begin(), points.end());
+    points.erase(std::unique(points.begin(), points.end()), points.end());
+
+    auto ranges = coalesce_sorted_points(points);
+    LOG_DEBUG(fmt::format(
+        "[ManagedQuery] [{}] Coalesced {} points on '{}' into {} ranges",
+        name_,
+        size,
+        dim,
+        ranges.size()));
+    record_selection(dim, ranges);
+    if (max_ranges_ > 0 && ranges.size() > max_ranges_) {
+        point_filters_.insert(dim);
+        return merge_ranges(ranges, max_ranges_);
+    }
+    return ranges;
+}
+
+void ManagedQuery::record_ranges(
+    const std::string& dim,
+    const std::vector<std::pair<int64_t, int64_t>>& ranges) {
+    record_ranges_impl(dim, ranges);
+}
+
+void ManagedQuery::record_ranges(
+    const std::string& dim,
+    const std::vector<std::pair<uint64_t, uint64_t>>& ranges) {
+    record_ranges_impl(dim, ranges);
+}
+
+template <typename T>
+void ManagedQuery::record_ranges_impl(
+    const std::string& dim, const std::vector<std::pair<T, T>>& ranges) {
+    auto& selection = dim_selections_[dim];
+    if (selection == nullptr) {
+        selection = std::make_shared<TypedDimSelection<T>>();
+    }
+    auto typed = std::dynamic_pointer_cast<TypedDimSelection<T>>(selection);
+    if (typed == nullptr) {
+        throw TileDBSOMAError(fmt::format(
+            "[ManagedQuery] [{}] Signed and unsigned ranges selected on "
+            "dimension '{}'",
+            name_,
+            dim));
+    }
+    typed->add(ranges);
+}
+
+size_t ManagedQuery::filter_results() {
+    size_t num_cells = buffers_->num_rows();
+    std::vector<uint8_t> keep(num_cells, 1);
+    for (auto& dim : point_filters_) {
+        // Columns which were not selected are read into filter buffers
+        auto buffer = buffers_->contains(dim) ? buffers_->at(dim) :
+                                                filter_buffers_->at(dim);
+        dim_selections_.at(dim)->filter(*buffer, keep);
+    }
+    if (value_filter_ != nullptr) {
+        stats::ScopedTimer timer("soma.managed_query.value_filter");
+        if (filter_buffers_->names().empty()) {
+            value_filter_->apply(*buffers_, keep);
+        } else {
+            // The filter sees the selected and the hidden columns
+            ArrayBuffers batch;
+            for (auto& name : buffers_->names()) {
+                batch.emplace(name, buffers_->at(name));
             }
-            auto colbuf = buffers_->at(attrname);
-            colbuf->add_enumeration(enumvec);
-            LOG_DEBUG(fmt::format(
-                "[ManagedQuery] got Enumeration '{}' for attribute '{}'",
-                enumname.value(),
-                attrname));
+            for (auto& name : filter_buffers_->names()) {
+                batch.emplace(name, filter_buffers_->at(name));
+            }
+            value_filter_->apply(batch, keep);
         }
     }
-    return buffers_;
+    for (auto& name : buffers_->names()) {
+        num_cells = buffers_->at(name)->compact(keep);
+    }
+    LOG_DEBUG(fmt::format(
+        "[ManagedQuery] [{}] Filters kept {} of {} cells",
+        name_,
+        num_cells,
+        keep.size()));
+    return num_cells;
+}
+
+size_t ManagedQuery::truncate_results(size_t num_cells) {
+    LOG_DEBUG(fmt::format(
+        "[ManagedQuery] [{}] Limit reached after {} of {} cells",
+        name_,
+        num_cells,
+        buffers_->num_rows()));
+    stats::add_counter("soma.managed_query.limited_reads");
+
+    std::vector<uint8_t> keep(buffers_->num_rows(), 0);
+    std::fill_n(keep.begin(), num_cells, 1);
+    for (auto& name : buffers_->names()) {
+        buffers_->at(name)->compact(keep);
+    }
+    return num_cells;
+}
+
+void ManagedQuery::reindex_results() {
+    for (auto& [dim, indexer] : dim_indexers_) {
+        if (!buffers_->contains(dim)) {
+            continue;
+        }
+        // The lookup reads and writes each element at the same position, so
+        // the coordinates can be overwritten in place.
+        auto coords = buffers_->at(dim)->data<int64_t>();
+        LOG_DEBUG(fmt::format(
+            "[ManagedQuery] [{}] Re-indexing {} cells of '{}'",
+            name_,
+            coords.size(),
+            dim));
+        indexer->lookup(coords.data(), coords.data(), coords.size());
+    }
+}
+
+std::shared_ptr<ArrayBuffers> ManagedQuery::aggregate(
+    const std::string& column,
+    AggregateOp op,
+    std::optional<std::string> group_by) {
+    tiledb_datatype_t type;
+    bool is_nullable = false;
+    if (schema_->has_attribute(column)) {
+        auto attr = schema_->attribute(column);
+        if (AttributeExperimental::get_enumeration_name(*ctx_, attr)) {
+            throw TileDBSOMAError(fmt::format(
+                "[ManagedQuery] [{}] Cannot aggregate enumerated column '{}'",
+                name_,
+                column));
+        }
+        type = attr.type();
+        is_nullable = attr.nullable();
+    } else if (schema_->domain().has_dimension(column)) {
+        type = schema_->domain().dimension(column).type();
+    } else {
+        throw TileDBSOMAError(fmt::format(
+            "[ManagedQuery] [{}] Column '{}' does not exist", name_, column));
+    }
+
+    if (group_by) {
+        if (!schema_->domain().has_dimension(*group_by) ||
+            schema_->domain().dimension(*group_by).type() != TILEDB_INT64) {
+            throw TileDBSOMAError(fmt::format(
+                "[ManagedQuery] [{}] Can only group by an int64 dimension, not "
+                "'{}'",
+                name_,
+                *group_by));
+        }
+    }
+
+    // Validate the type up front, before any work is done
+    try {
+        util::visit_numeric_type(type, [](auto) { return 0; });
+    } catch (const std::invalid_argument& e) {
+        throw TileDBSOMAError(fmt::format(
+            "[ManagedQuery] [{}] Cannot aggregate column '{}': {}",
+            name_,
+            column,
+            e.what()));
+    }
+
+    if (!group_by && array_->schema().array_type() == TILEDB_SPARSE &&
+        type != TILEDB_BOOL && point_filters_.empty() &&
+        value_filter_ == nullptr && !limit_ && !is_empty_query()) {
+        return aggregate_pushdown(column, op, type, is_nullable);
+    }
+
+    // Also read the columns the filters are evaluated on
+    columns_ = {column};
+    if (group_by) {
+        columns_.push_back(*group_by);
+    }
+    for (auto& dim : point_filters_) {
+        columns_.push_back(dim);
+    }
+    if (value_filter_ != nullptr) {
+        for (auto& name : value_filter_->columns()) {
+            columns_.push_back(name);
+        }
+    }
+    std::vector<std::string> unique_columns;
+    for (auto& name : columns_) {
+        if (std::find(unique_columns.begin(), unique_columns.end(), name) ==
+            unique_columns.end()) {
+            unique_columns.push_back(name);
+        }
+    }
+
+    // The scan reads only these columns, and aggregates the coordinates as
+    // stored rather than re-indexed: restore the caller's columns and
+    // indexers afterwards
+    auto saved_columns = std::exchange(columns_, std::move(unique_columns));
+    auto saved_indexers = std::exchange(dim_indexers_, {});
+    auto restore = [&]() {
+        columns_ = std::move(saved_columns);
+        dim_indexers_ = std::move(saved_indexers);
+    };
+    try {
+        auto results = util::visit_numeric_type(type, [&](auto t) {
+            using T = decltype(t);
+            return reduce_batches<T>(
+                [this]() { return next_scan_batch(); },
+                column,
+                op,
+                type,
+                group_by);
+        });
+        restore();
+        return results;
+    } catch (...) {
+        restore();
+        throw;
+    }
+}
+
+std::shared_ptr<ArrayBuffers> ManagedQuery::count_cells() {
+    if (array_->schema().array_type() != TILEDB_SPARSE) {
+        throw TileDBSOMAError(fmt::format(
+            "[ManagedQuery] [{}] Counting cells requires a sparse array",
+            name_));
+    }
+
+    // Cells rejected by the point or value filters, or past the limit, are
+    // only dropped by reading the filtered columns
+    if (!point_filters_.empty() || value_filter_ != nullptr || limit_) {
+        auto column = point_filters_.empty() ?
+                          schema_->domain().dimension(0).name() :
+                          *point_filters_.begin();
+        return aggregate(column, AggregateOp::count);
+    }
+
+    if (is_empty_query()) {
+        auto name = aggregate_name(AggregateOp::count);
+        std::vector<uint64_t> values = {0};
+        auto results = std::make_shared<ArrayBuffers>();
+        results->emplace(name, make_column(name, TILEDB_UINT64, values));
+        return results;
+    }
+
+    // The count does not depend on a column
+    return aggregate_pushdown("", AggregateOp::count, TILEDB_UINT64, false);
+}
+
+std::shared_ptr<ArrayBuffers> ManagedQuery::aggregate_pushdown(
+    const std::string& column,
+    AggregateOp op,
+    tiledb_datatype_t type,
+    bool is_nullable) {
+    auto name = aggregate_name(op);
+    LOG_DEBUG(fmt::format(
+        "[ManagedQuery] [{}] Pushing down {} of '{}'", name_, name, column));
+
+    init_subarray();
+    query_->set_layout(TILEDB_UNORDERED);
+
+    tiledb_datatype_t result_type = type;
+    auto channel = QueryExperimental::get_default_channel(*query_);
+    switch (op) {
+        case AggregateOp::count:
+            channel.apply_aggregate(name, CountOperation());
+            result_type = TILEDB_UINT64;
+            break;
+        case AggregateOp::sum:
+            channel.apply_aggregate(
+                name,
+                QueryExperimental::create_unary_aggregate<SumOperator>(
+                    *query_, column));
+            result_type = util::visit_numeric_type(type, [](auto t) {
+                using T = decltype(t);
+                return std::is_floating_point_v<T> ? TILEDB_FLOAT64 :
+                       std::is_signed_v<T>         ? TILEDB_INT64 :
+                                                     TILEDB_UINT64;
+            });
+            break;
+        case AggregateOp::mean:
+            channel.apply_aggregate(
+                name,
+                QueryExperimental::create_unary_aggregate<MeanOperator>(
+                    *query_, column));
+            result_type = TILEDB_FLOAT64;
+            break;
+        case AggregateOp::min:
+            channel.apply_aggregate(
+                name,
+                QueryExperimental::create_unary_aggregate<MinOperator>(
+                    *query_, column));
+            break;
+        case AggregateOp::max:
+            channel.apply_aggregate(
+                name,
+                QueryExperimental::create_unary_aggregate<MaxOperator>(
+                    *query_, column));
+            break;
+    }
+
+    // Bind a buffer of the result type, so the value is read back in the
+    // host's byte order whatever the width of the type
+    bool has_validity = is_nullable && op != AggregateOp::count;
+    return util::visit_numeric_type(result_type, [&](auto t) {
+        using V = decltype(t);
+        std::vector<V> values = {0};
+        uint8_t validity = 1;
+        query_->set_data_buffer(name, values.data(), 1);
+        if (has_validity) {
+            query_->set_validity_buffer(name, &validity, 1);
+        }
+
+        {
+            stats::ScopedTimer timer("soma.managed_query.aggregate_pushdown");
+            query_->submit();
+        }
+        if (query_->query_status() != Query::Status::COMPLETE) {
+            throw TileDBSOMAError(fmt::format(
+                "[ManagedQuery] [{}] Aggregate query did not complete",
+                name_));
+        }
+
+        // Empty selections produce no value for min, max and mean
+        auto num_values = query_->result_buffer_elements()[name].second;
+        bool is_valid = num_values > 0 && (!has_validity || validity);
+        if (!is_valid) {
+            values[0] = 0;
+        }
+
+        auto results = std::make_shared<ArrayBuffers>();
+        switch (op) {
+            case AggregateOp::count:
+            case AggregateOp::sum:
+                // A sum of no values is zero
+                results->emplace(name, make_column(name, result_type, values));
+                break;
+            default:
+                results->emplace(
+                    name,
+                    make_column(
+                        name,
+                        result_type,
+                        values,
+                        std::vector<uint8_t>{is_valid}));
+                break;
+        }
+        return results;
+    });
+}
+
+std::shared_ptr<ArrayBuffers> ManagedQuery::next_scan_batch() {
+    if (is_complete(true)) {
+        return nullptr;
+    }
+    setup_read();
+    if (is_empty_query()) {
+        return nullptr;
+    }
+    submit_read();
+    return results();
 }
 
 void ManagedQuery::check_column_name(const std::string& name) {
@@ -33,7 +33,11 @@
 #ifndef MANAGED_QUERY_H
 #define MANAGED_QUERY_H
 
+#include <algorithm>
+#include <functional>
 #include <future>
+#include <limits>
+#include <set>
 #include <stdexcept>  // for windows: error C2039: 'runtime_error': is not a member of 'std'
 #include <unordered_set>
 
@@ -42,9 +46,14 @@
 #include "../utils/common.h"
 #include "array_buffers.h"
 #include "column_buffer.h"
+#include "enums.h"
+#include "logger_public.h"
 
 namespace tiledbsoma {
 
+class IntIndexer;
+class ValueFilter;
+
 using namespace tiledb;
 
 // Probably we should just use a std::tuple here
@@ -67,8 +76,25 @@ class StatusAndException {
     std::string message_;
 };
 
+/** TileDB's estimate of the size of a read's results for one column */
+struct ResultSizeEstimate {
+    // Number of cells
+    uint64_t num_cells = 0;
+
+    // Number of bytes of data, excluding offsets and validity
+    uint64_t data_bytes = 0;
+};
+
 class ManagedQuery {
    public:
+    /**
+     * Config key which, when "false", allocates read buffers of
+     * `soma.init_buffer_bytes` rather than sizing them from TileDB's
+     * estimate of the result size.
+     */
+    static inline const std::string CONFIG_KEY_ESTIMATE_BUFFER_SIZES =
+        "soma.estimate_buffer_sizes";
+
     //===================================================================
     //= public non-static
     //===================================================================
@@ -95,13 +121,25 @@ class ManagedQuery {
         , schema_(other.schema_)
         , query_(std::make_unique<Query>(*other.ctx_, *other.array_))
         , subarray_(std::make_unique<Subarray>(*other.ctx_, *other.array_))
+        , condition_(other.condition_)
         , subarray_range_set_(other.subarray_range_set_)
         , subarray_range_empty_(other.subarray_range_empty_)
         , columns_(other.columns_)
+        , projection_(other.projection_)
+        , limit_(other.limit_)
+        , string_layout_(other.string_layout_)
         , results_complete_(other.results_complete_)
         , total_num_cells_(other.total_num_cells_)
         , buffers_(other.buffers_)
-        , query_submitted_(other.query_submitted_) {
+        , buffer_sizes_(other.buffer_sizes_)
+        , query_submitted_(other.query_submitted_)
+        , dim_indexers_(other.dim_indexers_)
+        , max_ranges_(other.max_ranges_)
+        , dim_selections_(other.dim_selections_)
+        , point_filters_(other.point_filters_)
+        , filter_buffers_(other.filter_buffers_)
+        , value_filter_(other.value_filter_)
+        , export_plans_(other.export_plans_) {
     }
 
     ~ManagedQuery() = default;
@@ -132,6 +170,16 @@ class ManagedQuery {
     void select_columns(
         const std::vector<std::string>& names, bool if_not_empty = false);
 
+    /**
+     * @brief Select the same cells as another query over the same array: copy
+     * its ranges and points, query condition, layout, point and value filters
+     * and limit. The columns, projection, dimension indexers and results are
+     * not copied. Call this before the query is submitted.
+     *
+     * @param other Query to copy the selection of
+     */
+    void copy_selection(const ManagedQuery& other);
+
     /**
      * @brief Returns the column names set by the query.
      *
@@ -141,6 +189,95 @@ class ManagedQuery {
         return columns_;
     }
 
+    /**
+     * @brief Clear the column selection, so that the columns of the
+     * projection are read unless others are selected.
+     */
+    void reset_columns() {
+        columns_.clear();
+    }
+
+    /**
+     * @brief Set the columns read when none are selected with
+     * `select_columns`:
+     *
+     * - `Projection::all` reads the dimensions of sparse arrays and all
+     *   attributes
+     * - `Projection::values` reads the attributes only, e.g. `soma_data`
+     * - `Projection::coordinates` reads the dimensions only
+     * - `Projection::count` reads no columns; see `count_cells`
+     *
+     * Columns selected with `select_columns` take precedence over any
+     * projection, including `Projection::count`.
+     *
+     * @param projection Projection
+     */
+    void set_projection(Projection projection) {
+        projection_ = projection;
+    }
+
+    /**
+     * @brief Return the columns read when none are selected.
+     *
+     * @return Projection
+     */
+    Projection projection() const {
+        return projection_;
+    }
+
+    /**
+     * @brief Return true if reads return the number of selected cells
+     * instead of columns: the projection is `Projection::count` and no
+     * columns were selected, since selected columns take precedence over
+     * any projection.
+     */
+    bool counts_cells() const {
+        return projection_ == Projection::count && columns_.empty();
+    }
+
+    /**
+     * @brief Return at most `limit` cells in total, counted after the
+     * filters. The batch reaching the limit is truncated, after which the
+     * query is complete and is not resubmitted, so the remaining cells are
+     * never read. Without filters, the result buffers of fixed-size columns
+     * are sized for the limit. A limit of 0 makes the query empty, so it
+     * returns a single batch without cells.
+     *
+     * @param limit Maximum number of cells, or std::nullopt for no limit
+     */
+    void set_limit(std::optional<uint64_t> limit) {
+        limit_ = limit;
+    }
+
+    /**
+     * @brief Return the maximum number of cells returned, if set.
+     *
+     * @return std::optional<uint64_t>
+     */
+    std::optional<uint64_t> limit() const {
+        return limit_;
+    }
+
+    /**
+     * @brief Set the Arrow layout of the string and binary columns of the
+     * result buffers, applied when they are exported. Batches whose data
+     * does not fit the layout are exported with 64-bit offsets.
+     *
+     * @param layout Layout
+     */
+    void set_string_layout(StringLayout layout) {
+        string_layout_ = layout;
+    }
+
+    /**
+     * @brief Return the Arrow layout of the string and binary columns.
+     *
+     * @return StringLayout
+     */
+    StringLayout string_layout() const {
+        return string_layout_;
+    }
+
     /**
      * @brief Select dimension ranges to query.
      *
@@ -157,6 +294,7 @@ class ManagedQuery {
             subarray_->add_range(dim, start, stop);
             subarray_range_empty_[dim] = false;
         }
+        record_selection(dim, ranges);
     }
 
     /**
@@ -168,12 +306,7 @@ class ManagedQuery {
      */
     template <typename T>
     void select_points(const std::string& dim, const std::vector<T>& points) {
-        subarray_range_set_ = true;
-        subarray_range_empty_[dim] = true;
-        for (auto& point : points) {
-            subarray_->add_range(dim, point, point);
-            subarray_range_empty_[dim] = false;
-        }
+        add_points(dim, points.data(), points.size());
     }
 
     /**
@@ -185,14 +318,24 @@ class ManagedQuery {
      */
     template <typename T>
     void select_points(const std::string& dim, const tcb::span<T> points) {
-        subarray_range_set_ = true;
-        subarray_range_empty_[dim] = true;
-        for (auto& point : points) {
-            subarray_->add_range(dim, point, point);
-            subarray_range_empty_[dim] = false;
-        }
+        add_points(dim, points.data(), points.size());
     }
 
+    /**
+     * @brief Limit the number of ranges each `select_points` call adds to the
+     * subarray of a sparse array. When the coalesced points need more ranges
+     * than this, the ranges separated by the smallest gaps are merged and
+     * the extra cells read from the gaps are filtered out of the results.
+     * The dimension is read for the filter even if it is not selected, and
+     * the filter keeps the cells of every point and range selected on the
+     * dimension. Zero (the default) means no limit. Set it before selecting
+     * any ranges or points.
+     *
+     * @param max_ranges Maximum number of ranges added by one
+     * `select_points` call
+     */
+    void set_max_ranges(size_t max_ranges);
+
     /**
      * @brief Select dimension point to query.
      *
@@ -205,6 +348,7 @@ class ManagedQuery {
         subarray_->add_range(dim, point, point);
         subarray_range_set_ = true;
         subarray_range_empty_[dim] = false;
+        record_selection(dim, std::vector<std::pair<T, T>>{{point, point}});
     }
 
     /**
@@ -214,6 +358,19 @@ class ManagedQuery {
      */
     void set_condition(const QueryCondition& qc) {
         query_->set_condition(qc);
+        condition_ = qc;
+    }
+
+    /**
+     * @brief Return true if anything besides the selected columns and the
+     * layout restricts or transforms the cells read: dimension ranges or
+     * points, a query condition, dimension indexers, a value filter, a limit
+     * or a projection other than `Projection::all`.
+     */
+    bool has_selection() const {
+        return subarray_range_set_ || condition_.has_value() ||
+               !dim_indexers_.empty() || value_filter_ != nullptr ||
+               limit_.has_value() || projection_ != Projection::all;
     }
 
     /**
@@ -225,6 +382,94 @@ class ManagedQuery {
         query_->set_layout(layout);
     }
 
+    /**
+     * @brief Return the query result order (layout).
+     *
+     * @return tiledb_layout_t
+     */
+    tiledb_layout_t layout() const {
+        return query_->query_layout();
+    }
+
+    /**
+     * @brief Re-index the coordinates of an int64 dimension as part of the
+     * read. After each submit, the values of the dimension's ColumnBuffer are
+     * replaced in place with their positions in the indexer (-1 if not
+     * found), before the results are returned to the caller. The indexer
+     * must have keys mapped by `map_locations`.
+     *
+     * @param dim Dimension name
+     * @param indexer IntIndexer mapping coordinates to positions
+     */
+    void set_dim_indexer(
+        const std::string& dim, std::shared_ptr<IntIndexer> indexer);
+
+    /**
+     * @brief Filter the results of each read with a predicate that TileDB
+     * query conditions cannot express, such as membership in a large set
+     * of labels or arithmetic between columns. Rejected cells are compacted
+     * out of the result buffers before they are returned, and before the
+     * dimension indexers are applied. The columns read by the filter are
+     * read even if they are not selected, and left out of the results.
+     *
+     * @param filter Filter, or nullptr to remove the filter
+     */
+    void set_value_filter(std::shared_ptr<ValueFilter> filter) {
+        value_filter_ = std::move(filter);
+    }
+
+    /**
+     * @brief Return the value filter, or nullptr if none is set.
+     *
+     * @return std::shared_ptr<ValueFilter>
+     */
+    std::shared_ptr<ValueFilter> value_filter() const {
+        return value_filter_;
+    }
+
+    /**
+     * @brief Aggregate a numeric column over the selected cells (dimension
+     * ranges and query condition). Like a read, this consumes the query;
+     * call `reset` before reading again.
+     *
+     * Ungrouped aggregates of sparse arrays without a value filter or a
+     * limit are pushed down to TileDB aggregate channels. Otherwise the
+     * column is read batch by batch and reduced in place, without exporting
+     * it to Arrow.
+     *
+     * The results hold one column named after the aggregate ("count",
+     * "sum", "mean", "min" or "max"). With `group_by`, they hold one row per
+     * distinct value of that int64 dimension, in ascending order, in a column
+     * named after the dimension followed by the aggregate column. `count` is
+     * the number of cells. `sum` is int64, uint64 or float64 depending on the
+     * column type, ignores nulls and saturates at the limits of its type on
+     * overflow, on both paths. `mean` (float64), `min` and `max` are null if
+     * there are no non-null values.
+     *
+     * Dimension values are aggregated and grouped as stored: dimension
+     * indexers are not applied. The column selection is left unchanged.
+     *
+     * @param column Attribute or dimension to aggregate
+     * @param op Aggregate operation
+     * @param group_by Optional int64 dimension to group by
+     * @return std::shared_ptr<ArrayBuffers> Aggregate results
+     */
+    std::shared_ptr<ArrayBuffers> aggregate(
+        const std::string& column,
+        AggregateOp op,
+        std::optional<std::string> group_by = std::nullopt);
+
+    /**
+     * @brief Count the selected cells of a sparse array without attaching
+     * any column buffers: TileDB counts the cells with an aggregate channel.
+     * With point ranges that were merged, a value filter or a limit, the
+     * filtered columns are read instead to drop the cells they reject. Like
+     * a read, this consumes the query.
+     *
+     * @return std::shared_ptr<ArrayBuffers> A single uint64 "count" column
+     */
+    std::shared_ptr<ArrayBuffers> count_cells();
+
     /**
      * @brief Set column data for write query.
      *
@@ -237,9 +482,25 @@ class ManagedQuery {
     /**
      * @brief Configure query and allocate result buffers for reads.
      *
+     * Unless `soma.estimate_buffer_sizes` is "false", the buffers are sized
+     * from TileDB's estimate of the result size, at least 64 KiB and at most
+     * `soma.init_buffer_bytes` per column. The sizes are estimated once, when
+     * the query is first set up.
      */
     void setup_read();
 
+    /**
+     * @brief Return TileDB's estimate of the result size of each column
+     * read by the query, for the ranges selected so far. Callers may use it
+     * to plan the number of batches of a read.
+     *
+     * The estimate is only available before the query is submitted.
+     *
+     * @return std::map<std::string, ResultSizeEstimate> Column name ->
+     * estimate
+     */
+    std::map<std::string, ResultSizeEstimate> estimate_result_sizes();
+
     /**
      * @brief Check if the query is complete.
      *
@@ -250,11 +511,15 @@ class ManagedQuery {
      * is complete or if the query is empty (no ranges have been added to the
      * query).
      *
+     * In both modes, the query is complete once a nonzero limit has been
+     * reached. A limit of 0 makes the query empty instead.
+     *
      * @param query_status_only Query complete mode.
      * @return true if the query is complete, as described above
      */
     bool is_complete(bool query_status_only = false) {
         return query_->query_status() == Query::Status::COMPLETE ||
+               (limit_ && *limit_ > 0 && total_num_cells_ >= *limit_) ||
                (!query_status_only && is_empty_query());
     }
 
@@ -355,11 +620,15 @@ class ManagedQuery {
     }
 
     /**
-     * @brief Return true if the only ranges selected were empty.
+     * @brief Return true if the only ranges selected were empty, or the
+     * limit is 0.
      *
-     * @return true if the query contains only empty ranges.
+     * @return true if the query cannot return any cells.
      */
     bool is_empty_query() {
+        if (limit_ && *limit_ == 0) {
+            return true;
+        }
         bool has_empty = false;
         for (auto subdim : subarray_range_empty_) {
             if (subdim.second == true) {
@@ -380,6 +649,20 @@ class ManagedQuery {
     }
 
    private:
+    //===================================================================
+    //= private static
+    //===================================================================
+
+    // Smallest data buffer allocated from an estimate. Estimates may be
+    // exact for small reads, and a floor keeps the number of retries low
+    // when they are not.
+    static constexpr size_t MIN_ESTIMATED_BUFFER_BYTES = 1 << 16;
+
+    // The ranges selected on a dimension, defined in managed_query.cc
+    class DimSelection;
+    template <typename T>
+    class TypedDimSelection;
+
     //===================================================================
     //= private non-static
     //===================================================================
@@ -391,6 +674,174 @@ class ManagedQuery {
      */
     void check_column_name(const std::string& name);
 
+    /**
+     * @brief Set the query subarray on the first submit, adding the full
+     * non-empty domain of dimension 0 for dense arrays without ranges.
+     */
+    void init_subarray();
+
+    /**
+     * @brief Select the columns of the projection, in schema order, if none
+     * were selected.
+     */
+    void init_columns();
+
+    /**
+     * @brief Size the read buffers from TileDB's estimate of the result
+     * size, unless disabled in the config.
+     */
+    void init_buffer_sizes();
+
+    /**
+     * @brief Double the read buffer sizes, up to `soma.init_buffer_bytes`.
+     *
+     * @return true if any buffer size changed
+     */
+    bool grow_buffer_sizes();
+
+    /**
+     * @brief Allocate the read buffers and attach them to the query.
+     */
+    void alloc_buffers();
+
+    /**
+     * @brief Return the dimensions filtered by their selected ranges and the
+     * columns read by the value filter which are not among the selected
+     * columns. They are read into filter buffers and left out of the
+     * results.
+     */
+    std::vector<std::string> hidden_filter_columns() const;
+
+    /**
+     * @brief Compute an ungrouped aggregate with a TileDB aggregate channel.
+     */
+    std::shared_ptr<ArrayBuffers> aggregate_pushdown(
+        const std::string& column,
+        AggregateOp op,
+        tiledb_datatype_t type,
+        bool is_nullable);
+
+    /**
+     * @brief Read the next batch of results for an internal scan, or return
+     * nullptr when the query is complete.
+     */
+    std::shared_ptr<ArrayBuffers> next_scan_batch();
+
+    /**
+     * @brief Apply the dimension indexers to the result buffers in place.
+     */
+    void reindex_results();
+
+    /**
+     * @brief Drop the result cells rejected by the point and value filters.
+     *
+     * @return size_t Number of cells kept
+     */
+    size_t filter_results();
+
+    /**
+     * @brief Keep only the first `num_cells` result cells.
+     *
+     * @return size_t Number of cells kept
+     */
+    size_t truncate_results(size_t num_cells);
+
+    /**
+     * @brief Wait for a read submitted with `submit_read` to finish.
+     */
+    void wait_for_submit();
+
+    /**
+     * @brief Add dimension points to the subarray. For sparse arrays and
+     * integral dimensions, the points are sorted, deduplicated and coalesced
+     * into ranges of consecutive values, so TileDB processes one range per
+     * run rather than one per point. Dense arrays keep one range per point
+     * since their results follow the order (and multiplicity) of the ranges.
+     */
+    template <typename T>
+    void add_points(const std::string& dim, const T* points, size_t size) {
+        subarray_range_set_ = true;
+        subarray_range_empty_[dim] = size == 0;
+
+        if constexpr (std::is_integral_v<T> && !std::is_same_v<T, bool>) {
+            if (schema_->array_type() == TILEDB_SPARSE) {
+                using Wide = std::
+                    conditional_t<std::is_signed_v<T>, int64_t, uint64_t>;
+                auto ranges = coalesce_points(
+                    dim, std::vector<Wide>(points, points + size));
+                for (auto& [start, stop] : ranges) {
+                    subarray_->add_range(
+                        dim, static_cast<T>(start), static_cast<T>(stop));
+                }
+                return;
+            }
+        }
+
+        for (size_t i = 0; i < size; i++) {
+            subarray_->add_range(dim, points[i], points[i]);
+        }
+    }
+
+    /**
+     * @brief Coalesce the points selected on an integral dimension of a
+     * sparse array into ranges of consecutive values, merged down to
+     * `max_ranges_` if set.
+     *
+     * @param dim Dimension name
+     * @param points Points, widened to 64 bits
+     * @return The ranges to add to the subarray
+     */
+    std::vector<std::pair<int64_t, int64_t>> coalesce_points(
+        const std::string& dim, std::vector<int64_t> points);
+    std::vector<std::pair<uint64_t, uint64_t>> coalesce_points(
+        const std::string& dim, std::vector<uint64_t> points);
+
+    /**
+     * @brief Record the ranges selected on an integral dimension of a sparse
+     * array, which filter its results if its ranges are merged. Nothing is
+     * recorded unless `max_ranges_` is set.
+     */
+    template <typename T>
+    void record_selection(
+        const std::string& dim, const std::vector<std::pair<T, T>>& ranges) {
+        if constexpr (std::is_integral_v<T> && !std::is_same_v<T, bool>) {
+            if (max_ranges_ == 0 || schema_->array_type() != TILEDB_SPARSE) {
+                return;
+            }
+            using Wide = std::
+                conditional_t<std::is_signed_v<T>, int64_t, uint64_t>;
+            record_ranges(
+                dim,
+                std::vector<std::pair<Wide, Wide>>(
+                    ranges.begin(), ranges.end()));
+        }
+    }
+
+    /**
+     * @brief Add ranges, widened to 64 bits, to the selection recorded for a
+     * dimension.
+     */
+    void record_ranges(
+        const std::string& dim,
+        const std::vector<std::pair<int64_t, int64_t>>& ranges);
+    void record_ranges(
+        const std::string& dim,
+        const std::vector<std::pair<uint64_t, uint64_t>>& ranges);
+
+    /**
+     * @brief Shared implementation of the `coalesce_points` overloads.
+     */
+    template <typename T>
+    std::vector<std::pair<T, T>> coalesce_points_impl(
+        const std::string& dim, std::vector<T> points);
+
+    /**
+     * @brief Shared implementation of the `record_ranges` overloads.
+     */
+    template <typename T>
+    void record_ranges_impl(
+        const std::string& dim, const std::vector<std::pair<T, T>>& ranges);
+
     // TileDB array being queried.
     std::shared_ptr<Array> array_;
 
@@ -409,15 +860,28 @@ class ManagedQuery {
     // TileDB subarray containing the ranges for slicing.
     std::unique_ptr<Subarray> subarray_;
 
+    // Query condition, if one has been set
+    std::optional<QueryCondition> condition_;
+
     // True if a range has been added to the subarray
     bool subarray_range_set_ = false;
 
     // Map whether the dimension is empty (true) or not
     std::map<std::string, bool> subarray_range_empty_ = {};
 
-    // Set of column names to read (dim and attr). If empty, query all columns.
+    // Set of column names to read (dim and attr). If empty, query the
+    // columns of the projection.
     std::vector<std::string> columns_;
 
+    // Columns read when none are selected
+    Projection projection_ = Projection::all;
+
+    // Maximum number of cells returned by the query
+    std::optional<uint64_t> limit_;
+
+    // Arrow layout of the string and binary columns of the results
+    StringLayout string_layout_ = StringLayout::large;
+
     // Results in the buffers are complete (the query was never incomplete)
     bool results_complete_ = true;
 
@@ -427,11 +891,41 @@ class ManagedQuery {
     // A collection of ColumnBuffers attached to the query
     std::shared_ptr<ArrayBuffers> buffers_;
 
+    // Map: column name -> number of cells and data bytes to allocate for
+    // reads. Columns not in the map use `soma.init_buffer_bytes`.
+    std::map<std::string, std::pair<size_t, size_t>> buffer_sizes_;
+
     // True if the query has been submitted
     bool query_submitted_ = false;
 
     // Future for asyncronous query
     std::future<StatusAndException> query_future_;
+
+    // Map: dimension name -> indexer applied to the dimension's results
+    std::map<std::string, std::shared_ptr<IntIndexer>> dim_indexers_;
+
+    // Maximum number of ranges added by one select_points call on a sparse
+    // array, 0 for no limit
+    size_t max_ranges_ = 0;
+
+    // Map: dimension name -> ranges selected on the dimension, recorded for
+    // the integral dimensions of sparse arrays when max_ranges_ is set
+    std::map<std::string, std::shared_ptr<DimSelection>> dim_selections_;
+
+    // Dimensions whose selected ranges were merged: their results are
+    // filtered down to their selection
+    std::set<std::string> point_filters_;
+
+    // Buffers of the filtered columns which were not selected, read only to
+    // filter the results
+    std::shared_ptr<ArrayBuffers> filter_buffers_;
+
+    // Filter applied to the results after the point filters
+    std::shared_ptr<ValueFilter> value_filter_;
+
+    // Map: column name -> Arrow export plan shared by the column's batches,
+    // derived on the first export and kept across resets
+    std::map<std::string, std::shared_ptr<ArrowExportPlan>> export_plans_;
 };
 };  // namespace tiledbsoma
 
@@ -0,0 +1,312 @@
+/**
+ * @file   partitioned_scan.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2024 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *   This file defines the PartitionedScan class.
+ */
+
+#include "partitioned_scan.h"
+#include <thread_pool/thread_pool.h>
+#include <algorithm>
+#include <limits>
+#include "../utils/logger.h"
+#include "../utils/stats.h"
+#include "soma_context.h"
+
+namespace tiledbsoma {
+
+//===================================================================
+//= public static
+//===================================================================
+
+std::vector<std::pair<int64_t, int64_t>> PartitionedScan::split_domain(
+    const std::vector<FragmentExtent>& fragments, size_t num_partitions) {
+    std::vector<std::pair<int64_t, int64_t>> ranges;
+    if (fragments.empty() || num_partitions == 0) {
+        return ranges;
+    }
+
+    int64_t lo = std::numeric_limits<int64_t>::max();
+    int64_t hi = std::numeric_limits<int64_t>::min();
+    double total = 0;
+    for (const auto& fragment : fragments) {
+        lo = std::min(lo, fragment.lo);
+        hi = std::max(hi, fragment.hi);
+        total += static_cast<double>(fragment.cell_num);
+    }
+
+    // Estimated number of cells at or below `x`. Extents are computed in
+    // floating point since they may span most of the int64 domain.
+    auto cells_up_to = [&](int64_t x) {
+        double cells = 0;
+        for (const auto& fragment : fragments) {
+            if (x >= fragment.hi) {
+                cells += static_cast<double>(fragment.cell_num);
+            } else if (x >= fragment.lo) {
+                double extent = static_cast<double>(fragment.hi) -
+                                static_cast<double>(fragment.lo) + 1;
+                double covered = static_cast<double>(x) -
+                                 static_cast<double>(fragment.lo) + 1;
+                cells += static_cast<double>(fragment.cell_num) * covered /
+                         extent;
+            }
+        }
+        return cells;
+    };
+
+    int64_t start = lo;
+    for (size_t i = 1; i < num_partitions && start < hi; i++) {
+        double target = total * static_cast<double>(i) /
+                        static_cast<double>(num_partitions);
+
+        // Find the smallest end in [start, hi] reaching the target
+        int64_t left = start;
+        int64_t right = hi;
+        while (left < right) {
+            int64_t mid = left + static_cast<int64_t>(
+                                     (static_cast<uint64_t>(right) -
+                                      static_cast<uint64_t>(left)) /
+                                     2);
+            if (cells_up_to(mid) >= target) {
+                right = mid;
+            } else {
+                left = mid + 1;
+            }
+        }
+        if (left >= hi) {
+            break;
+        }
+        ranges.emplace_back(start, left);
+        start = left + 1;
+    }
+    ranges.emplace_back(start, hi);
+
+    return ranges;
+}
+
+//===================================================================
+//= public non-static
+//===================================================================
+
+PartitionedScan::PartitionedScan(
+    std::shared_ptr<SOMAContext> ctx,
+    std::shared_ptr<Array> array,
+    std::string_view name,
+    const std::vector<std::string>& column_names,
+    tiledb_layout_t layout,
+    std::vector<std::pair<int64_t, int64_t>> partitions,
+    ScanOrder order,
+    size_t max_queued_batches)
+    : name_(name)
+    , pool_(ctx->thread_pool())
+    , order_(order)
+    , max_queued_batches_(
+          max_queued_batches > 0 ? max_queued_batches :
+                                   2 * partitions.size())
+    , ranges_(std::move(partitions)) {
+    auto dim_name = array->schema().domain().dimension(0).name();
+
+    parts_.resize(ranges_.size());
+    for (size_t i = 0; i < ranges_.size(); i++) {
+        auto mq = std::make_unique<ManagedQuery>(
+            array, ctx->tiledb_ctx(), name);
+        mq->set_layout(layout);
+        if (!column_names.empty()) {
+            mq->select_columns(column_names);
+        }
+        mq->select_ranges<int64_t>(dim_name, {ranges_[i]});
+        parts_[i].mq = std::move(mq);
+
+        LOG_DEBUG(fmt::format(
+            "[PartitionedScan] [{}] Partition {} = [{}, {}]",
+            name_,
+            i,
+            ranges_[i].first,
+            ranges_[i].second));
+    }
+
+    // Start reading ahead of the first call to read_next
+    if (pool_ != nullptr) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        launch(lock);
+    }
+}
+
+PartitionedScan::~PartitionedScan() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this]() { return num_reading_ == 0; });
+}
+
+std::optional<std::shared_ptr<ArrayBuffers>> PartitionedScan::read_next() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        if (error_) {
+            std::rethrow_exception(error_);
+        }
+        if (auto batch = pop_ready()) {
+            // Refill the slot freed by this batch
+            launch(lock);
+            return batch;
+        }
+        if (finished()) {
+            return std::nullopt;
+        }
+        launch(lock);
+        if (num_reading_ > 0) {
+            cv_.wait(lock);
+        }
+    }
+}
+
+//===================================================================
+//= private non-static
+//===================================================================
+
+void PartitionedScan::launch(std::unique_lock<std::mutex>& lock) {
+    if (error_) {
+        return;
+    }
+
+    std::vector<size_t> to_read;
+    for (size_t i = current_; i < parts_.size(); i++) {
+        auto& part = parts_[i];
+        if (part.reading || part.done) {
+            continue;
+        }
+        // In range order, the partition being returned is always read, even
+        // if the queue is full of batches of later partitions
+        bool is_current = order_ == ScanOrder::range && i == current_;
+        if (!is_current &&
+            num_queued_ + num_reading_ >= max_queued_batches_) {
+            break;
+        }
+        part.reading = true;
+        num_reading_++;
+        to_read.push_back(i);
+
+        // Without a thread pool, read one batch at a time on the caller
+        if (pool_ == nullptr) {
+            break;
+        }
+    }
+    if (to_read.empty()) {
+        return;
+    }
+
+    lock.unlock();
+    for (auto i : to_read) {
+        ThreadPool::Task task;
+        if (pool_ != nullptr) {
+            task = pool_->execute([this, i]() {
+                read_batch(i);
+                return Status::Ok();
+            });
+        }
+        if (!task.valid()) {
+            read_batch(i);
+        }
+    }
+    lock.lock();
+}
+
+void PartitionedScan::read_batch(size_t index) {
+    // Only one read of a partition is in flight at a time, so its query may
+    // be used without holding the mutex
+    auto& mq = *parts_[index].mq;
+
+    std::shared_ptr<ArrayBuffers> batch;
+    bool done = true;
+    std::exception_ptr error = nullptr;
+    try {
+        mq.setup_read();
+        if (!mq.is_empty_query()) {
+            mq.submit_read();
+            batch = mq.results();
+            done = mq.is_complete(true);
+        }
+    } catch (...) {
+        error = std::current_exception();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& part = parts_[index];
+    part.reading = false;
+    num_reading_--;
+    if (done) {
+        part.done = true;
+        num_done_++;
+    }
+    if (error && !error_) {
+        error_ = error;
+    }
+    if (batch && batch->num_rows() > 0) {
+        part.batches.push_back(batch);
+        if (order_ == ScanOrder::arbitrary) {
+            ready_order_.push_back(index);
+        }
+        num_queued_++;
+        stats::max_counter("soma.partitioned_scan.max_queued", num_queued_);
+    }
+
+    // Notify while holding the mutex: once `num_reading_` drops to zero the
+    // destructor may run as soon as the mutex is released
+    cv_.notify_all();
+}
+
+std::shared_ptr<ArrayBuffers> PartitionedScan::pop_ready() {
+    size_t index;
+    if (order_ == ScanOrder::range) {
+        while (current_ < parts_.size() && parts_[current_].done &&
+               parts_[current_].batches.empty()) {
+            current_++;
+        }
+        if (current_ == parts_.size() || parts_[current_].batches.empty()) {
+            return nullptr;
+        }
+        index = current_;
+    } else {
+        if (ready_order_.empty()) {
+            return nullptr;
+        }
+        index = ready_order_.front();
+        ready_order_.pop_front();
+    }
+
+    auto& batches = parts_[index].batches;
+    auto batch = batches.front();
+    batches.pop_front();
+    num_queued_--;
+    stats::add_counter("soma.partitioned_scan.batches");
+    return batch;
+}
+
+bool PartitionedScan::finished() const {
+    return num_done_ == parts_.size() && num_queued_ == 0;
+}
+
+}  // namespace tiledbsoma
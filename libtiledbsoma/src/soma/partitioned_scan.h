@@ -0,0 +1,223 @@
+/**
+ * @file   partitioned_scan.h
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2024 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *   This declares the PartitionedScan class, which reads a SOMAArray with
+ *   several concurrent queries over disjoint ranges of dimension 0.
+ */
+
+#ifndef SOMA_PARTITIONED_SCAN_H
+#define SOMA_PARTITIONED_SCAN_H
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <tiledb/tiledb>
+
+#include "enums.h"
+#include "managed_query.h"
+
+namespace tiledbsoma {
+
+class SOMAContext;
+class ThreadPool;
+
+using namespace tiledb;
+
+class PartitionedScan {
+   public:
+    //===================================================================
+    //= public static
+    //===================================================================
+
+    /** The extent of one fragment on dimension 0, used to plan partitions */
+    struct FragmentExtent {
+        int64_t lo;
+        int64_t hi;
+        uint64_t cell_num;
+    };
+
+    /**
+     * @brief Split the union of the fragment extents into at most
+     * `num_partitions` disjoint, contiguous ranges holding roughly the same
+     * number of cells. Cells are assumed to be spread uniformly over each
+     * fragment's extent.
+     *
+     * @param fragments Fragment extents on dimension 0
+     * @param num_partitions Maximum number of ranges
+     * @return Inclusive ranges in increasing order, empty if there are no
+     * fragments
+     */
+    static std::vector<std::pair<int64_t, int64_t>> split_domain(
+        const std::vector<FragmentExtent>& fragments, size_t num_partitions);
+
+    //===================================================================
+    //= public non-static
+    //===================================================================
+
+    /**
+     * @brief Start scanning the array, one ManagedQuery per partition.
+     * Queries are submitted on the context thread pool whenever there is
+     * room in the batch queue, starting before the first call to
+     * `read_next`. Without a thread pool, `read_next` reads the partitions
+     * one batch at a time on the calling thread.
+     *
+     * @param ctx SOMAContext providing the thread pool
+     * @param array Array opened in read mode
+     * @param name Name of the array, for logging
+     * @param column_names Columns to read, or all columns if empty
+     * @param layout Result order within each partition
+     * @param partitions Inclusive ranges of dimension 0 to read
+     * @param order Order in which batches are returned
+     * @param max_queued_batches Maximum number of batches read ahead of the
+     * caller. Defaults to twice the number of partitions if 0.
+     */
+    PartitionedScan(
+        std::shared_ptr<SOMAContext> ctx,
+        std::shared_ptr<Array> array,
+        std::string_view name,
+        const std::vector<std::string>& column_names,
+        tiledb_layout_t layout,
+        std::vector<std::pair<int64_t, int64_t>> partitions,
+        ScanOrder order = ScanOrder::arbitrary,
+        size_t max_queued_batches = 0);
+
+    PartitionedScan() = delete;
+    PartitionedScan(const PartitionedScan&) = delete;
+    PartitionedScan(PartitionedScan&&) = delete;
+
+    /**
+     * @brief Wait for the reads in flight to finish. Batches that were not
+     * returned are discarded.
+     */
+    ~PartitionedScan();
+
+    /**
+     * @brief Return the next batch of results, or `std::nullopt` once every
+     * partition has been read. Empty batches are not returned.
+     *
+     * With `ScanOrder::range`, all batches of a partition are returned
+     * before those of the next one. With `ScanOrder::arbitrary`, batches
+     * are returned in the order the reads complete.
+     *
+     * An exception thrown by a read is rethrown here.
+     *
+     * @return std::optional<std::shared_ptr<ArrayBuffers>>
+     */
+    std::optional<std::shared_ptr<ArrayBuffers>> read_next();
+
+    /**
+     * @brief Return the ranges of dimension 0 read by each query.
+     */
+    const std::vector<std::pair<int64_t, int64_t>>& partitions() const {
+        return ranges_;
+    }
+
+   private:
+    //===================================================================
+    //= private non-static
+    //===================================================================
+
+    struct Partition {
+        std::unique_ptr<ManagedQuery> mq;
+
+        // A read of this partition is in flight
+        bool reading = false;
+
+        // All batches of this partition have been read
+        bool done = false;
+
+        // Batches read but not yet returned, in read order
+        std::deque<std::shared_ptr<ArrayBuffers>> batches;
+    };
+
+    // Submit reads of idle partitions while there is room in the queue.
+    // Called with `lock` held, which is released while submitting.
+    void launch(std::unique_lock<std::mutex>& lock);
+
+    // Read one batch of a partition and queue it
+    void read_batch(size_t index);
+
+    // Pop the next batch in scan order, if one is ready. Called with the
+    // mutex held.
+    std::shared_ptr<ArrayBuffers> pop_ready();
+
+    // Return true if every batch has been returned. Called with the mutex
+    // held.
+    bool finished() const;
+
+    // Name of the array, for logging
+    std::string name_;
+
+    // Thread pool running the reads, or nullptr to read on the caller
+    std::shared_ptr<ThreadPool> pool_;
+
+    // Order in which batches are returned
+    ScanOrder order_;
+
+    // Maximum number of batches queued or being read
+    size_t max_queued_batches_;
+
+    // Ranges of dimension 0, one per partition
+    std::vector<std::pair<int64_t, int64_t>> ranges_;
+
+    // Guards everything below
+    std::mutex mutex_;
+
+    // Notified when a read completes
+    std::condition_variable cv_;
+
+    std::vector<Partition> parts_;
+
+    // Partitions in the order their batches were queued, for
+    // ScanOrder::arbitrary
+    std::deque<size_t> ready_order_;
+
+    // First partition with batches left to return, for ScanOrder::range
+    size_t current_ = 0;
+
+    // Number of queued batches and of reads in flight
+    size_t num_queued_ = 0;
+    size_t num_reading_ = 0;
+
+    // Number of partitions completely read
+    size_t num_done_ = 0;
+
+    // First exception thrown by a read
+    std::exception_ptr error_ = nullptr;
+};
+
+}  // namespace tiledbsoma
+
+#endif  // SOMA_PARTITIONED_SCAN_H
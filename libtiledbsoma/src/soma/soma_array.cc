@@ -32,11 +32,40 @@
 
 #include "soma_array.h"
 #include <tiledb/array_experimental.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 #include "../utils/logger.h"
+#include "../utils/stats.h"
 #include "../utils/util.h"
+#include "array_stream.h"
+#include "batch_exporter.h"
+#include "compressed_matrix.h"
+#include "coo_tensor.h"
+#include "partitioned_scan.h"
+#include "value_filter.h"
 namespace tiledbsoma {
 using namespace tiledb;
 
+namespace {
+
+// Copy the rows listed as (index into `sources`, row) pairs into new buffers
+std::shared_ptr<ArrayBuffers> gather_rows(
+    const std::vector<ArrayBuffers*>& sources,
+    const std::vector<std::pair<size_t, uint64_t>>& rows) {
+    auto result = std::make_shared<ArrayBuffers>();
+    for (auto& name : sources.front()->names()) {
+        std::vector<ColumnBuffer*> columns;
+        for (auto source : sources) {
+            columns.push_back(source->at(name).get());
+        }
+        result->emplace(name, ColumnBuffer::gather(columns, rows));
+    }
+    return result;
+}
+
+}  // namespace
+
 //===================================================================
 //= public static
 //===================================================================
@@ -279,11 +308,26 @@ void SOMAArray::reset(
 }
 
 std::optional<std::shared_ptr<ArrayBuffers>> SOMAArray::read_next() {
+    // Return the results of a read submitted by `prefetch_next`
+    if (submitted_) {
+        submitted_ = false;
+        return mq_->results();
+    }
+
     // If the query is complete, return `std::nullopt`
     if (mq_->is_complete(true)) {
         return std::nullopt;
     }
 
+    // A count-only read returns the number of cells in a single batch
+    if (mq_->counts_cells()) {
+        if (!first_read_next_) {
+            return std::nullopt;
+        }
+        first_read_next_ = false;
+        return mq_->count_cells();
+    }
+
     // Configure query and allocate result buffers
     mq_->setup_read();
 
@@ -305,14 +349,272 @@ std::optional<std::shared_ptr<ArrayBuffers>> SOMAArray::read_next() {
     return mq_->results();
 }
 
+std::optional<ArrowTable> SOMAArray::read_next_arrow() {
+    auto batch = read_next();
+    if (!batch) {
+        return std::nullopt;
+    }
+    if (batch_exporter_ == nullptr) {
+        batch_exporter_ = std::make_shared<BatchExporter>();
+    }
+    return batch_exporter_->export_batch(*batch);
+}
+
+void SOMAArray::prefetch_next() {
+    // Empty queries and counts are not submitted by read_next either
+    if (submitted_ || mq_->is_complete(true) ||
+        mq_->counts_cells() || mq_->is_empty_query()) {
+        return;
+    }
+    mq_->setup_read();
+    first_read_next_ = false;
+    mq_->submit_read();
+    submitted_ = true;
+}
+
+void SOMAArray::to_arrow_stream(
+    struct ArrowArrayStream* stream, bool prefetch) {
+    ArrayStream::export_to(this, stream, prefetch);
+}
+
+std::shared_ptr<ArrayBuffers> SOMAArray::read_top_k(
+    const std::string& column, uint64_t k, bool largest) {
+    if (mq_->counts_cells()) {
+        throw TileDBSOMAError(
+            "[SOMAArray] read_top_k cannot rank the rows of a count");
+    }
+    auto key = ValueExpr::column(column);
+
+    // A ranked row: its value, its position in `best` (source 0) or in the
+    // current batch (source 1), and its read order, which breaks ties. The
+    // values of a column all hold the same alternative, so they compare in
+    // its type.
+    struct Candidate {
+        std::variant<int64_t, uint64_t, double> value;
+        size_t source;
+        uint64_t row;
+        uint64_t seq;
+    };
+
+    // Used as the heap comparison, this keeps the lowest ranked candidate
+    // on top, ready to be evicted
+    auto ranks_before = [largest](const Candidate& a, const Candidate& b) {
+        if (a.value != b.value) {
+            return largest ? a.value > b.value : a.value < b.value;
+        }
+        return a.seq < b.seq;
+    };
+
+    // The best rows read so far, and a heap of their candidates
+    std::shared_ptr<ArrayBuffers> best;
+    std::vector<Candidate> heap;
+
+    uint64_t seq = 0;
+    ValueExpr::Values values;
+    std::vector<uint8_t> valid;
+    while (auto batch = read_next()) {
+        auto& buffers = **batch;
+        if (!buffers.contains(column)) {
+            throw TileDBSOMAError(fmt::format(
+                "[SOMAArray] Cannot rank rows by column '{}' which was not "
+                "selected",
+                column));
+        }
+        if (best == nullptr) {
+            best = gather_rows({&buffers}, {});
+        }
+
+        auto num_rows = buffers.num_rows();
+        key->eval(buffers, values, valid);
+        bool changed = false;
+        std::visit(
+            [&](const auto& column_values) {
+                for (uint64_t row = 0; row < num_rows; row++, seq++) {
+                    auto value = column_values[row];
+                    if (!valid[row]) {
+                        continue;
+                    }
+                    if constexpr (std::is_floating_point_v<decltype(value)>) {
+                        if (std::isnan(value)) {
+                            continue;
+                        }
+                    }
+                    Candidate candidate{value, 1, row, seq};
+                    if (heap.size() < k) {
+                        heap.push_back(candidate);
+                        std::push_heap(
+                            heap.begin(), heap.end(), ranks_before);
+                    } else if (
+                        k > 0 && ranks_before(candidate, heap.front())) {
+                        std::pop_heap(heap.begin(), heap.end(), ranks_before);
+                        heap.back() = candidate;
+                        std::push_heap(
+                            heap.begin(), heap.end(), ranks_before);
+                    } else {
+                        continue;
+                    }
+                    changed = true;
+                }
+            },
+            values);
+        if (!changed) {
+            continue;
+        }
+
+        // Copy the surviving rows, so that the batch can be released
+        std::vector<std::pair<size_t, uint64_t>> rows;
+        rows.reserve(heap.size());
+        for (const auto& candidate : heap) {
+            rows.emplace_back(candidate.source, candidate.row);
+        }
+        best = gather_rows({best.get(), &buffers}, rows);
+        for (size_t i = 0; i < heap.size(); i++) {
+            heap[i].source = 0;
+            heap[i].row = i;
+        }
+    }
+
+    if (best == nullptr) {
+        return std::make_shared<ArrayBuffers>();
+    }
+
+    // Return the rows in rank order
+    std::sort_heap(heap.begin(), heap.end(), ranks_before);
+    std::vector<std::pair<size_t, uint64_t>> rows;
+    rows.reserve(heap.size());
+    for (const auto& candidate : heap) {
+        rows.emplace_back(0, candidate.row);
+    }
+    LOG_DEBUG(fmt::format(
+        "[SOMAArray] Ranked {} of {} rows by '{}'", rows.size(), seq, column));
+    return gather_rows({best.get()}, rows);
+}
+
+std::shared_ptr<CompressedMatrix> SOMAArray::read_compressed_matrix(
+    const std::string& major_dim,
+    const std::string& minor_dim,
+    const std::string& value_column,
+    uint64_t n_major,
+    uint64_t n_minor,
+    std::shared_ptr<IntIndexer> major_indexer,
+    std::shared_ptr<IntIndexer> minor_indexer) {
+    if (mq_->counts_cells()) {
+        throw TileDBSOMAError(
+            "[SOMAArray] read_compressed_matrix cannot read a count");
+    }
+
+    // Each batch has its own buffers, so they can all be held at once
+    std::vector<std::shared_ptr<ArrayBuffers>> batches;
+    while (auto batch = read_next()) {
+        batches.push_back(*batch);
+    }
+    if (batches.empty()) {
+        throw TileDBSOMAError(
+            "[SOMAArray] read_compressed_matrix found the query already "
+            "complete; call reset before reading again");
+    }
+    return CompressedMatrix::from_coo(
+        batches,
+        major_dim,
+        minor_dim,
+        value_column,
+        n_major,
+        n_minor,
+        major_indexer,
+        minor_indexer,
+        ctx_);
+}
+
+std::optional<std::shared_ptr<COOTensor>> SOMAArray::read_next_coo_tensor(
+    const std::vector<std::string>& dims, const std::string& value_column) {
+    if (mq_->counts_cells()) {
+        throw TileDBSOMAError(
+            "[SOMAArray] read_next_coo_tensor cannot read a count");
+    }
+    auto batch = read_next();
+    if (!batch) {
+        return std::nullopt;
+    }
+    return COOTensor::from_batches({*batch}, dims, value_column, ctx_);
+}
+
+std::shared_ptr<COOTensor> SOMAArray::read_coo_tensor(
+    const std::vector<std::string>& dims, const std::string& value_column) {
+    if (mq_->counts_cells()) {
+        throw TileDBSOMAError(
+            "[SOMAArray] read_coo_tensor cannot read a count");
+    }
+
+    // Each batch has its own buffers, so they can all be held at once
+    std::vector<std::shared_ptr<ArrayBuffers>> batches;
+    while (auto batch = read_next()) {
+        batches.push_back(*batch);
+    }
+    if (batches.empty()) {
+        throw TileDBSOMAError(
+            "[SOMAArray] read_coo_tensor found the query already complete; "
+            "call reset before reading again");
+    }
+    return COOTensor::from_batches(batches, dims, value_column, ctx_);
+}
+
+std::unique_ptr<PartitionedScan> SOMAArray::partitioned_scan(
+    size_t num_partitions, ScanOrder order, size_t max_queued_batches) {
+    if (num_partitions == 0) {
+        throw TileDBSOMAError(
+            "[SOMAArray] partitioned_scan requires at least one partition");
+    }
+    if (mq_->has_selection()) {
+        throw TileDBSOMAError(
+            "[SOMAArray] partitioned_scan reads the whole array and cannot "
+            "apply the ranges, query condition, indexers, filters, limit or "
+            "projection set on it; call reset() first");
+    }
+    auto dim = arr_->schema().domain().dimension(0);
+    if (dim.type() != TILEDB_INT64) {
+        throw TileDBSOMAError(fmt::format(
+            "[SOMAArray] partitioned_scan requires an int64 first dimension, "
+            "not '{}'",
+            dim.name()));
+    }
+
+    // Plan the partitions from the fragments visible at the read timestamp
+    FragmentInfo fragment_info(*ctx_->tiledb_ctx(), uri_);
+    fragment_info.load();
+
+    std::vector<PartitionedScan::FragmentExtent> fragments;
+    for (uint32_t fid = 0; fid < fragment_info.fragment_num(); fid++) {
+        auto frag_ts = fragment_info.timestamp_range(fid);
+        if (timestamp_ && (frag_ts.first > timestamp_->second ||
+                           frag_ts.second < timestamp_->first)) {
+            continue;
+        }
+        int64_t non_empty_domain[2];
+        fragment_info.get_non_empty_domain(fid, 0, non_empty_domain);
+        fragments.push_back(
+            {non_empty_domain[0],
+             non_empty_domain[1],
+             fragment_info.cell_num(fid)});
+    }
+
+    return std::make_unique<PartitionedScan>(
+        ctx_,
+        arr_,
+        name_,
+        mq_->column_names(),
+        mq_->layout(),
+        PartitionedScan::split_domain(fragments, num_partitions),
+        order,
+        max_queued_batches);
+}
+
 bool SOMAArray::_extend_enumeration(
     ArrowSchema* value_schema,
     ArrowArray* value_array,
     ArrowSchema* index_schema,
     ArrowArray* index_array,
     ArraySchemaEvolution se) {
-    auto enmr = ArrayExperimental::get_enumeration(
-        *ctx_->tiledb_ctx(), *arr_, index_schema->name);
+    auto enmr = _get_enumeration(index_schema->name);
     auto value_type = enmr.type();
 
     switch (value_type) {
@@ -321,10 +623,26 @@ bool SOMAArray::_extend_enumeration(
         case TILEDB_CHAR:
             return SOMAArray::_extend_and_evolve_schema_str(
                 value_schema, value_array, index_schema, index_array, se);
-        case TILEDB_BOOL:
-            _cast_bit_to_uint8(value_schema, value_array);
-            return SOMAArray::_extend_and_evolve_schema<uint8_t>(
-                value_array, index_schema, index_array, se);
+        case TILEDB_BOOL: {
+            // Unpack the bits of the dictionary, which belongs to the
+            // caller, into a copy
+            ArrowArray unpacked = *value_array;
+            std::vector<const void*> buffers(
+                value_array->buffers,
+                value_array->buffers + value_array->n_buffers);
+            unpacked.buffers = buffers.data();
+            _cast_bit_to_uint8(&unpacked);
+            auto bits = unpacked.buffers[unpacked.n_buffers - 1];
+            try {
+                auto extended = SOMAArray::_extend_and_evolve_schema<uint8_t>(
+                    &unpacked, index_schema, index_array, se);
+                free((void*)bits);
+                return extended;
+            } catch (...) {
+                free((void*)bits);
+                throw;
+            }
+        }
         case TILEDB_INT8:
             return SOMAArray::_extend_and_evolve_schema<uint8_t>(
                 value_array, index_schema, index_array, se);
@@ -396,8 +714,7 @@ bool SOMAArray::_extend_and_evolve_schema_str(
     }
 
     std::string column_name = index_schema->name;
-    auto enmr = ArrayExperimental::get_enumeration(
-        *ctx_->tiledb_ctx(), *arr_, column_name);
+    auto enmr = _get_enumeration(column_name);
     std::vector<std::string> extend_values;
     auto enums_existing = enmr.as_vector<std::string>();
     for (auto enum_val : enums_in_write) {
@@ -420,6 +737,7 @@ bool SOMAArray::_extend_and_evolve_schema_str(
 
         auto extended_enmr = enmr.extend(extend_values);
         se.extend_enumeration(extended_enmr);
+        extended_enumerations_.insert_or_assign(column_name, extended_enmr);
 
         SOMAArray::_remap_indexes(
             column_name,
@@ -428,8 +746,9 @@ bool SOMAArray::_extend_and_evolve_schema_str(
             index_schema,
             index_array);
 
-        index_schema->format = ArrowAdapter::to_arrow_format(disk_index_type)
-                                   .data();
+        free((void*)index_schema->format);
+        index_schema->format = strdup(
+            ArrowAdapter::to_arrow_format(disk_index_type).data());
         return true;
     } else {
         // Example:
@@ -446,6 +765,15 @@ bool SOMAArray::_extend_and_evolve_schema_str(
     return false;
 }
 
+Enumeration SOMAArray::_get_enumeration(const std::string& column_name) {
+    auto it = extended_enumerations_.find(column_name);
+    if (it != extended_enumerations_.end()) {
+        return it->second;
+    }
+    return ArrayExperimental::get_enumeration(
+        *ctx_->tiledb_ctx(), *arr_, column_name);
+}
+
 uint64_t SOMAArray::_get_max_capacity(tiledb_datatype_t index_type) {
     switch (index_type) {
         case TILEDB_INT8:
@@ -534,9 +862,33 @@ void SOMAArray::set_array_data(
         array_buffer_ = std::make_shared<ArrayBuffers>();
     }
 
+    _set_array_data(
+        *mq_, *array_buffer_, std::move(arrow_schema), std::move(arrow_array));
+};
+
+void SOMAArray::_set_array_data(
+    ManagedQuery& mq,
+    ArrayBuffers& buffers,
+    std::unique_ptr<ArrowSchema> arrow_schema,
+    std::unique_ptr<ArrowArray> arrow_array) {
     auto [casted_array, casted_schema] = SOMAArray::_cast_table(
         std::move(arrow_schema), std::move(arrow_array));
 
+    // The column buffers copy the cast columns, which are freed on return,
+    // also when a column cannot be set
+    std::unique_ptr<ArrowArray, void (*)(ArrowArray*)> array_guard(
+        casted_array.get(), [](ArrowArray* a) {
+            if (a->release != nullptr) {
+                a->release(a);
+            }
+        });
+    std::unique_ptr<ArrowSchema, void (*)(ArrowSchema*)> schema_guard(
+        casted_schema.get(), [](ArrowSchema* s) {
+            if (s->release != nullptr) {
+                s->release(s);
+            }
+        });
+
     for (auto i = 0; i < casted_schema->n_children; ++i) {
         auto arrow_sch_ = casted_schema->children[i];
         auto arrow_arr_ = casted_array->children[i];
@@ -573,14 +925,14 @@ void SOMAArray::set_array_data(
                 static_cast<uint64_t*>(nullptr),
                 validities);
         }
-        // Keep the ColumnBuffer alive by attaching it to the ArrayBuffers class
-        // member. Otherwise, the data held by the ColumnBuffer will be garbage
+        // Keep the ColumnBuffer alive by attaching it to the ArrayBuffers.
+        // Otherwise, the data held by the ColumnBuffer will be garbage
         // collected before it is submitted to the write query
-        array_buffer_->emplace(std::string(arrow_sch_->name), column);
+        buffers.emplace(std::string(arrow_sch_->name), column);
 
-        mq_->set_column_data(column);
+        mq.set_column_data(column);
     }
-};
+}
 
 template <>
 void SOMAArray::_cast_dictionary_values<std::string>(
@@ -590,8 +942,11 @@ void SOMAArray::_cast_dictionary_values<std::string>(
     auto value_schema = orig_column_schema->dictionary;
     auto value_array = orig_column_array->dictionary;
 
+    // The index buffers allocated by _create_column are replaced by string
+    // buffers
+    delete[] new_column_array->buffers;
     new_column_array->n_buffers = 3;
-    new_column_array->buffers = new const void*[3];
+    new_column_array->buffers = new const void*[3]();
 
     uint64_t num_elems = value_array->length;
 
@@ -721,14 +1076,19 @@ ArrowTable SOMAArray::_cast_table(
     std::unique_ptr<ArrowSchema> arrow_schema,
     std::unique_ptr<ArrowArray> arrow_array) {
     // Create the new ArrowSchema and ArrowArray for the ArrowTable that we
-    // will deep copy to
+    // will deep copy to. The children are zeroed, so that a table cast only
+    // in part can be released.
     auto casted_arrow_schema = std::make_unique<ArrowSchema>();
     casted_arrow_schema->format = strdup("+s");
+    casted_arrow_schema->name = nullptr;
+    casted_arrow_schema->metadata = nullptr;
+    casted_arrow_schema->flags = 0;
     casted_arrow_schema->n_children = arrow_schema->n_children;
     casted_arrow_schema->dictionary = nullptr;
-    casted_arrow_schema->release = &ArrowAdapter::release_schema;
-    casted_arrow_schema->children = (ArrowSchema**)malloc(
-        arrow_schema->n_children * sizeof(ArrowSchema*));
+    casted_arrow_schema->release = &SOMAArray::_release_cast_schema;
+    casted_arrow_schema->private_data = nullptr;
+    casted_arrow_schema->children = (ArrowSchema**)calloc(
+        arrow_schema->n_children, sizeof(ArrowSchema*));
 
     auto casted_arrow_array = std::make_unique<ArrowArray>();
     casted_arrow_array->length = 0;
@@ -737,37 +1097,95 @@ ArrowTable SOMAArray::_cast_table(
     casted_arrow_array->n_buffers = 0;
     casted_arrow_array->buffers = nullptr;
     casted_arrow_array->n_children = arrow_array->n_children;
-    casted_arrow_array->release = &ArrowAdapter::release_array;
-    casted_arrow_array->children = (ArrowArray**)malloc(
-        arrow_array->n_children * sizeof(ArrowArray*));
-
-    // Go through all columns in the ArrowTable and cast the values to what is
-    // in the ArraySchema on disk
-    ArraySchemaEvolution se = _make_se();
-    bool evolve_schema = false;
-    for (auto i = 0; i < arrow_schema->n_children; ++i) {
-        auto orig_arrow_sch_ = arrow_schema->children[i];
-        auto orig_arrow_arr_ = arrow_array->children[i];
-        auto new_arrow_sch_ = casted_arrow_schema
-                                  ->children[i] = new ArrowSchema;
-        auto new_arrow_arr_ = casted_arrow_array->children[i] = new ArrowArray;
-
-        bool enmr_extended = SOMAArray::_create_and_cast_column(
-            orig_arrow_sch_,
-            orig_arrow_arr_,
-            new_arrow_sch_,
-            new_arrow_arr_,
-            se);
-        evolve_schema = evolve_schema || enmr_extended;
-    }
-    if (evolve_schema) {
-        se.array_evolve(uri_);
+    casted_arrow_array->dictionary = nullptr;
+    casted_arrow_array->release = &SOMAArray::_release_cast_array;
+    casted_arrow_array->private_data = nullptr;
+    casted_arrow_array->children = (ArrowArray**)calloc(
+        arrow_array->n_children, sizeof(ArrowArray*));
+
+    std::map<std::string, Enumeration> enumerations;
+    try {
+        // Go through all columns in the ArrowTable and cast the values to
+        // what is in the ArraySchema on disk
+        // Extensions are forgotten if the schema is not evolved
+        enumerations = extended_enumerations_;
+        ArraySchemaEvolution se = _make_se();
+        bool evolve_schema = false;
+        for (auto i = 0; i < arrow_schema->n_children; ++i) {
+            auto orig_arrow_sch_ = arrow_schema->children[i];
+            auto orig_arrow_arr_ = arrow_array->children[i];
+            auto new_arrow_sch_ = casted_arrow_schema
+                                      ->children[i] = new ArrowSchema;
+            auto new_arrow_arr_ = casted_arrow_array
+                                      ->children[i] = new ArrowArray;
+
+            bool enmr_extended = SOMAArray::_create_and_cast_column(
+                orig_arrow_sch_,
+                orig_arrow_arr_,
+                new_arrow_sch_,
+                new_arrow_arr_,
+                se);
+            evolve_schema = evolve_schema || enmr_extended;
+        }
+        if (evolve_schema) {
+            se.array_evolve(uri_);
+        }
+    } catch (...) {
+        extended_enumerations_ = std::move(enumerations);
+        casted_arrow_array->release(casted_arrow_array.get());
+        casted_arrow_schema->release(casted_arrow_schema.get());
+        throw;
     }
 
     return ArrowTable(
         std::move(casted_arrow_array), std::move(casted_arrow_schema));
 }
 
+void SOMAArray::_release_cast_schema(ArrowSchema* schema) {
+    free((void*)schema->format);
+    free((void*)schema->name);
+    if (schema->children != nullptr) {
+        for (int64_t i = 0; i < schema->n_children; i++) {
+            auto child = schema->children[i];
+            if (child != nullptr) {
+                if (child->release != nullptr) {
+                    child->release(child);
+                }
+                delete child;
+            }
+        }
+        free(schema->children);
+    }
+    schema->release = nullptr;
+}
+
+void SOMAArray::_release_cast_array(ArrowArray* array) {
+    static stats::AtomicCounter released(
+        "soma.array.cast_columns_released");
+
+    // Buffer 0 is the validity of the input column
+    if (array->buffers != nullptr) {
+        for (int64_t i = 1; i < array->n_buffers; i++) {
+            free((void*)array->buffers[i]);
+        }
+        delete[] array->buffers;
+    }
+    if (array->children != nullptr) {
+        for (int64_t i = 0; i < array->n_children; i++) {
+            auto child = array->children[i];
+            if (child != nullptr) {
+                if (child->release != nullptr) {
+                    child->release(child);
+                }
+                delete child;
+                released.add();
+            }
+        }
+        free(array->children);
+    }
+    array->release = nullptr;
+}
+
 bool SOMAArray::_create_and_cast_column(
     ArrowSchema* orig_column_schema,
     ArrowArray* orig_column_array,
@@ -834,25 +1252,34 @@ void SOMAArray::_create_column(
         disk_type = tiledb_schema()->domain().dimension(name).type();
     }
 
-    // Create the new ArrowSchema and ArrowArray for the column
+    static stats::AtomicCounter cast_columns("soma.array.cast_columns");
+    cast_columns.add();
+
+    // Create the new ArrowSchema and ArrowArray for the column. The
+    // dictionary and the validity buffer are borrowed from the input column;
+    // the other buffers are allocated by the cast.
     new_column_schema->format = strdup(
         ArrowAdapter::to_arrow_format(disk_type).data());
     new_column_schema->name = strdup(orig_column_schema->name);
+    new_column_schema->metadata = nullptr;
+    new_column_schema->flags = orig_column_schema->flags;
     new_column_schema->n_children = orig_column_schema->n_children;
-    new_column_schema->release = &ArrowAdapter::release_schema;
-    new_column_schema->children = (ArrowSchema**)malloc(
-        orig_column_schema->n_children * sizeof(ArrowSchema*));
+    new_column_schema->release = &SOMAArray::_release_cast_schema;
+    new_column_schema->private_data = nullptr;
+    new_column_schema->children = (ArrowSchema**)calloc(
+        orig_column_schema->n_children, sizeof(ArrowSchema*));
     new_column_schema->dictionary = orig_column_schema->dictionary;
 
     new_column_array->length = orig_column_array->length;
     new_column_array->null_count = orig_column_array->null_count;
     new_column_array->offset = 0;
     new_column_array->n_buffers = orig_column_array->n_buffers;
-    new_column_array->buffers = new const void*[orig_column_array->n_buffers];
+    new_column_array->buffers = new const void*[orig_column_array->n_buffers]();
     new_column_array->n_children = orig_column_array->n_children;
-    new_column_array->release = &ArrowAdapter::release_array;
-    new_column_array->children = (ArrowArray**)malloc(
-        orig_column_array->n_children * sizeof(ArrowArray*));
+    new_column_array->release = &SOMAArray::_release_cast_array;
+    new_column_array->private_data = nullptr;
+    new_column_array->children = (ArrowArray**)calloc(
+        orig_column_array->n_children, sizeof(ArrowArray*));
     new_column_array->dictionary = orig_column_array->dictionary;
 }
 
@@ -904,25 +1331,15 @@ void SOMAArray::_cast_column(
             break;
         }
         case TILEDB_BOOL: {
-            new_column_array->buffers[0] = orig_column_array->buffers[0];
-            auto sz = orig_column_array->length +
-                      (orig_column_array->length % 8 == 0 ? 0 : 1);
-
-            if (orig_column_array->n_buffers == 3) {
-                new_column_array->buffers[2] = malloc(sz);
-                std::memcpy(
-                    (void*)new_column_array->buffers[2],
-                    orig_column_array->buffers[2],
-                    sz);
-            } else {
-                new_column_array->buffers[1] = malloc(sz);
-                std::memcpy(
-                    (void*)new_column_array->buffers[1],
-                    orig_column_array->buffers[1],
-                    sz);
+            // The bits are read from the input column and unpacked into a
+            // buffer of the cast column
+            for (int64_t i = 0; i < orig_column_array->n_buffers; i++) {
+                new_column_array->buffers[i] = orig_column_array->buffers[i];
             }
+            _cast_bit_to_uint8(new_column_array);
 
-            _cast_bit_to_uint8(new_column_schema, new_column_array);
+            free((void*)new_column_schema->format);
+            new_column_schema->format = strdup("C");
             break;
         }
         case TILEDB_INT8:
@@ -995,8 +1412,7 @@ void SOMAArray::_cast_column(
     }
 }
 
-void SOMAArray::_cast_bit_to_uint8(
-    ArrowSchema* arrow_schema, ArrowArray* arrow_array) {
+void SOMAArray::_cast_bit_to_uint8(ArrowArray* arrow_array) {
     const void* data;
     if (arrow_array->n_buffers == 3) {
         data = arrow_array->buffers[2];
@@ -1014,7 +1430,6 @@ void SOMAArray::_cast_bit_to_uint8(
         }
     }
 
-    arrow_schema->format = "C";
     if (arrow_array->n_buffers == 3) {
         arrow_array->buffers[2] = malloc(sizeof(uint8_t) * sz);
         std::memcpy(
@@ -1040,6 +1455,133 @@ void SOMAArray::write(bool sort_coords) {
     array_buffer_ = nullptr;
 }
 
+uint64_t SOMAArray::write_stream(
+    struct ArrowArrayStream* stream, bool sort_coords) {
+    // The stream is released on return, including when a write fails
+    std::unique_ptr<ArrowArrayStream, void (*)(ArrowArrayStream*)>
+        stream_guard(stream, [](ArrowArrayStream* s) {
+            if (s->release != nullptr) {
+                s->release(s);
+            }
+        });
+
+    if (mq_->query_type() != TILEDB_WRITE) {
+        throw TileDBSOMAError("[SOMAArray] array must be opened in write mode");
+    }
+    if (arr_->schema().array_type() != TILEDB_SPARSE) {
+        throw TileDBSOMAError(
+            "[SOMAArray] write_stream requires a sparse array");
+    }
+
+    auto check = [&](int code, std::string_view what) {
+        if (code != 0) {
+            auto message = stream->get_last_error(stream);
+            throw TileDBSOMAError(fmt::format(
+                "[SOMAArray] Cannot {} of the stream: {}",
+                what,
+                message != nullptr ? message : std::strerror(code)));
+        }
+    };
+
+    ArrowSchema schema;
+    check(stream->get_schema(stream, &schema), "get the schema");
+    std::unique_ptr<ArrowSchema, void (*)(ArrowSchema*)> schema_guard(
+        &schema, [](ArrowSchema* s) {
+            if (s->release != nullptr) {
+                s->release(s);
+            }
+        });
+
+    // Check the columns once, rather than failing on a later batch after
+    // some fragments were written
+    auto tiledb_schema = arr_->schema();
+    bool has_dictionary = false;
+    for (int64_t i = 0; i < schema.n_children; i++) {
+        auto child = schema.children[i];
+        has_dictionary = has_dictionary || child->dictionary != nullptr;
+        std::string name(child->name);
+        if (!tiledb_schema.has_attribute(name) &&
+            !tiledb_schema.domain().has_dimension(name)) {
+            throw TileDBSOMAError(fmt::format(
+                "[SOMAArray] Stream column '{}' is not in the schema of '{}'",
+                name,
+                uri_));
+        }
+        // Throws if the Arrow type cannot be stored
+        ArrowAdapter::to_tiledb_format(child->format);
+    }
+
+    // A batch being written. The future is declared last, so that it is
+    // destroyed, waiting for the write, before the query.
+    struct Write {
+        std::unique_ptr<ManagedQuery> mq;
+        std::shared_ptr<ArrayBuffers> buffers;
+        std::future<void> done;
+    };
+    std::optional<Write> in_flight;
+
+    uint64_t num_cells = 0;
+    uint64_t num_batches = 0;
+    while (true) {
+        ArrowArray batch;
+        check(stream->get_next(stream, &batch), "read a batch");
+        if (batch.release == nullptr) {
+            break;
+        }
+        std::unique_ptr<ArrowArray, void (*)(ArrowArray*)> batch_guard(
+            &batch, [](ArrowArray* a) {
+                if (a->release != nullptr) {
+                    a->release(a);
+                }
+            });
+        if (batch.length == 0) {
+            continue;
+        }
+
+        // A batch with new dictionary values evolves the schema, which
+        // must not happen while the previous batch is written
+        if (has_dictionary && in_flight) {
+            in_flight->done.get();
+            in_flight.reset();
+        }
+
+        // Cast this batch while the previous one is written. The column
+        // buffers hold copies of the data, so the batch is released here.
+        Write write{
+            std::make_unique<ManagedQuery>(arr_, ctx_->tiledb_ctx(), name_),
+            std::make_shared<ArrayBuffers>(),
+            {}};
+        _set_array_data(
+            *write.mq,
+            *write.buffers,
+            std::make_unique<ArrowSchema>(schema),
+            std::make_unique<ArrowArray>(batch));
+        num_cells += batch.length;
+        batch_guard.reset();
+
+        // Fragments are written in stream order
+        if (in_flight) {
+            in_flight->done.get();
+        }
+        in_flight = std::move(write);
+        in_flight->done = std::async(
+            std::launch::async, [mq = in_flight->mq.get(), sort_coords]() {
+                mq->submit_write(sort_coords);
+            });
+        num_batches++;
+    }
+    if (in_flight) {
+        in_flight->done.get();
+    }
+
+    LOG_DEBUG(fmt::format(
+        "[SOMAArray] Wrote {} cells in {} batches to '{}'",
+        num_cells,
+        num_batches,
+        uri_));
+    return num_cells;
+}
+
 void SOMAArray::consolidate_and_vacuum(std::vector<std::string> modes) {
     for (auto mode : modes) {
         auto cfg = ctx_->tiledb_ctx()->config();
@@ -1175,6 +1717,26 @@ uint64_t SOMAArray::nnz_slow() {
     return total_cell_num;
 }
 
+std::unique_ptr<ArrowSchema> SOMAArray::arrow_schema() const {
+    if (arrow_schema_ == nullptr) {
+        arrow_schema_ = std::shared_ptr<ArrowSchema>(
+            ArrowAdapter::arrow_schema_from_tiledb_array(
+                ctx_->tiledb_ctx(), arr_)
+                .release(),
+            [](ArrowSchema* schema) {
+                schema->release(schema);
+                delete schema;
+            });
+    }
+
+    auto schema = std::make_unique<ArrowSchema>();
+    if (ArrowSchemaDeepCopy(arrow_schema_.get(), schema.get()) !=
+        NANOARROW_OK) {
+        throw TileDBSOMAError("[SOMAArray] Cannot copy the Arrow schema");
+    }
+    return schema;
+}
+
 std::vector<int64_t> SOMAArray::shape() {
     // There are two reasons for this:
     // * Transitional, non-monolithic, phased, careful development for the
@@ -1392,6 +1954,9 @@ void SOMAArray::validate(
         } else {
             arr_ = std::make_shared<Array>(*ctx_->tiledb_ctx(), uri_, tdb_mode);
         }
+        arrow_schema_ = nullptr;
+        batch_exporter_ = nullptr;
+        extended_enumerations_.clear();
         LOG_TRACE(fmt::format("[SOMAArray] loading enumerations"));
         ArrayExperimental::load_all_enumerations(
             *ctx_->tiledb_ctx(), *(arr_.get()));
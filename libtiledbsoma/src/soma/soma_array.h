@@ -48,6 +48,11 @@
 namespace tiledbsoma {
 using namespace tiledb;
 
+class BatchExporter;
+class CompressedMatrix;
+class COOTensor;
+class PartitionedScan;
+
 class SOMAArray : public SOMAObject {
    public:
     //===================================================================
@@ -178,6 +183,7 @@ class SOMAArray : public SOMAObject {
         , mq_(std::make_unique<ManagedQuery>(
               other.arr_, other.ctx_->tiledb_ctx(), other.name_))
         , arr_(other.arr_)
+        , arrow_schema_(other.arrow_schema_)
         , meta_cache_arr_(other.meta_cache_arr_)
         , first_read_next_(other.first_read_next_)
         , submitted_(other.submitted_)
@@ -377,6 +383,34 @@ class SOMAArray : public SOMAObject {
         mq_->set_condition(qc);
     }
 
+    /**
+     * @brief Re-index the coordinates of an int64 dimension as they are read.
+     * Each batch returned by `read_next` holds the indexer positions of the
+     * coordinates instead of the coordinates themselves, which avoids a
+     * separate pass over the results after they are exported.
+     *
+     * @param dim Dimension name
+     * @param indexer IntIndexer already populated with `map_locations`, or
+     * nullptr to stop re-indexing the dimension
+     */
+    void set_dim_indexer(
+        const std::string& dim, std::shared_ptr<IntIndexer> indexer) {
+        mq_->set_dim_indexer(dim, indexer);
+    }
+
+    /**
+     * @brief Limit the number of subarray ranges added by each
+     * `set_dim_points` call. Points are coalesced into runs of consecutive
+     * values; if more runs than `max_ranges` remain, nearby runs are merged
+     * and the cells read in between are filtered out of the results. Set it
+     * before any `set_dim_*` call.
+     *
+     * @param max_ranges Maximum number of ranges, or 0 for no limit
+     */
+    void set_max_ranges(size_t max_ranges) {
+        mq_->set_max_ranges(max_ranges);
+    }
+
     /**
      * @brief Select columns names to query (dim and attr). If the
      * `if_not_empty` parameter is `true`, the column will be selected iff
@@ -411,6 +445,188 @@ class SOMAArray : public SOMAObject {
         return result_order_;
     }
 
+    /**
+     * @brief Aggregate a numeric column over the current selection, without
+     * exporting the cells to Arrow. Ungrouped aggregates of sparse arrays are
+     * computed by TileDB; others are reduced batch by batch as the column is
+     * read. Like `read_next`, this consumes the query: call `reset` before
+     * reading again. See ManagedQuery::aggregate for the result columns.
+     *
+     * @param column Attribute or dimension to aggregate
+     * @param op Aggregate operation
+     * @param group_by Optional int64 dimension to group by
+     * @return std::shared_ptr<ArrayBuffers> Aggregate results
+     */
+    std::shared_ptr<ArrayBuffers> aggregate(
+        const std::string& column,
+        AggregateOp op,
+        std::optional<std::string> group_by = std::nullopt) {
+        return mq_->aggregate(column, op, group_by);
+    }
+
+    /**
+     * @brief Set the columns read when none are selected, e.g. only
+     * `soma_data` (`Projection::values`) or only the coordinates
+     * (`Projection::coordinates`) of a sparse array. With
+     * `Projection::count`, `read_next` attaches no column buffers and
+     * returns a single batch with the uint64 "count" of selected cells.
+     * Explicitly selected columns take precedence over the projection,
+     * including `Projection::count`. The projection is cleared by `reset`.
+     *
+     * @param projection Projection
+     */
+    void set_projection(Projection projection) {
+        mq_->set_projection(projection);
+    }
+
+    /**
+     * @brief Filter the results of each read with a predicate evaluated in
+     * C++ on the result buffers, so rejected cells are never exported. See
+     * ManagedQuery::set_value_filter.
+     *
+     * @param filter Filter, or nullptr to remove the filter
+     */
+    void set_value_filter(std::shared_ptr<ValueFilter> filter) {
+        mq_->set_value_filter(std::move(filter));
+    }
+
+    /**
+     * @brief Return at most `limit` rows in total from `read_next`, counted
+     * after the filters. Once the limit is reached the query is complete and
+     * the rest of the array is not read, which makes previews of large
+     * arrays cheap. A limit of 0 returns a single batch without rows, which
+     * still has the selected columns. The limit is cleared by `reset`.
+     *
+     * @param limit Maximum number of rows, or std::nullopt for no limit
+     */
+    void set_limit(std::optional<uint64_t> limit) {
+        mq_->set_limit(limit);
+    }
+
+    /**
+     * @brief Export the string and binary columns of the batches returned
+     * by `read_next` as Arrow large_utf8 (the default), as utf8 with 32-bit
+     * offsets, or as utf8_view, so that consumers expecting those types get
+     * them without a conversion. The offsets are narrowed, or the views
+     * built, when a column is exported; the string data itself is never
+     * copied. Batches whose data exceeds 2 GiB keep 64-bit offsets, which
+     * fails a stream of `to_arrow_stream` once its schema is set. The
+     * layout is cleared by `reset`.
+     *
+     * @param layout Layout
+     */
+    void set_string_layout(StringLayout layout) {
+        mq_->set_string_layout(layout);
+    }
+
+    /**
+     * @brief Read the `k` rows with the largest (or smallest) values of a
+     * numeric column over the current selection, in order. Batches are read
+     * one at a time and a heap of the best `k` rows is kept across them, so
+     * memory is bounded by one batch plus `k` rows. Integral values are
+     * compared exactly, as int64 or uint64, and floating-point values as
+     * doubles; rows with a null or NaN value are skipped, and ties keep the
+     * row read first. Like `read_next`, this consumes the query: call
+     * `reset` before reading again.
+     *
+     * @param column Attribute or dimension to rank the rows by, which must
+     * be selected
+     * @param k Number of rows
+     * @param largest Return the largest values if true, else the smallest
+     * @return std::shared_ptr<ArrayBuffers> At most `k` rows
+     */
+    std::shared_ptr<ArrayBuffers> read_top_k(
+        const std::string& column, uint64_t k, bool largest = true);
+
+    /**
+     * @brief Read the rest of the query into a CSR or CSC matrix of the
+     * values of a column, indexed by two int64 dimensions. All batches are
+     * read before the matrix is built with a parallel counting sort on the
+     * context thread pool, so memory is bounded by the query results. Like
+     * `read_next`, this consumes the query: call `reset` before reading
+     * again.
+     *
+     * The major dimension gives the rows of a CSR matrix, or the columns of
+     * a CSC matrix. Coordinates are mapped through the indexers if set, and
+     * must fall within the extents of the matrix.
+     *
+     * @param major_dim Dimension giving the major index
+     * @param minor_dim Dimension giving the minor index
+     * @param value_column Fixed-size, non-nullable column giving the values
+     * @param n_major Extent of the major axis
+     * @param n_minor Extent of the minor axis
+     * @param major_indexer Indexer applied to the major coordinates, or
+     * nullptr
+     * @param minor_indexer Indexer applied to the minor coordinates, or
+     * nullptr
+     * @return std::shared_ptr<CompressedMatrix>
+     */
+    std::shared_ptr<CompressedMatrix> read_compressed_matrix(
+        const std::string& major_dim,
+        const std::string& minor_dim,
+        const std::string& value_column,
+        uint64_t n_major,
+        uint64_t n_minor,
+        std::shared_ptr<IntIndexer> major_indexer = nullptr,
+        std::shared_ptr<IntIndexer> minor_indexer = nullptr);
+
+    /**
+     * @brief Read the next batch into a sparse tensor in coordinate format,
+     * with the dimensions interleaved into one coordinate matrix on the
+     * context thread pool. The values are viewed in the batch without a
+     * copy.
+     *
+     * @param dims Non-nullable int64 dimensions, in tensor axis order
+     * @param value_column Fixed-size, non-nullable column giving the values
+     * @return std::optional<std::shared_ptr<COOTensor>> The tensor, or
+     * std::nullopt if the query is complete
+     */
+    std::optional<std::shared_ptr<COOTensor>> read_next_coo_tensor(
+        const std::vector<std::string>& dims, const std::string& value_column);
+
+    /**
+     * @brief Read the rest of the query into one sparse tensor in coordinate
+     * format. Like `read_next`, this consumes the query: call `reset` before
+     * reading again.
+     *
+     * @param dims Non-nullable int64 dimensions, in tensor axis order
+     * @param value_column Fixed-size, non-nullable column giving the values
+     * @return std::shared_ptr<COOTensor>
+     */
+    std::shared_ptr<COOTensor> read_coo_tensor(
+        const std::vector<std::string>& dims, const std::string& value_column);
+
+    /**
+     * @brief Start a scan of the whole array with several concurrent
+     * queries. The non-empty domain of dimension 0, which must be int64, is
+     * split into up to `num_partitions` ranges holding roughly the same
+     * number of cells, estimated from the fragment non-empty domains. Each
+     * range is read by its own query on the context thread pool.
+     *
+     * The scan reads the selected columns in the current result order, and
+     * the managed query is left untouched. The scan always covers the whole
+     * array: it throws if the array has a selection that the partitions
+     * would not apply, i.e. dimension ranges or points, a query condition,
+     * dimension indexers, a value filter, a limit or a projection. Call
+     * `reset` first to clear them.
+     *
+     *   auto scan = array->partitioned_scan(8);
+     *   while (auto batch = scan->read_next()) {
+     *       ...process batch ...
+     *   }
+     *
+     * @param num_partitions Maximum number of partitions
+     * @param order Whether batches are returned in partition order or as
+     * soon as they are read
+     * @param max_queued_batches Maximum number of batches read ahead of the
+     * caller. Defaults to twice the number of partitions if 0.
+     * @return std::unique_ptr<PartitionedScan>
+     */
+    std::unique_ptr<PartitionedScan> partitioned_scan(
+        size_t num_partitions,
+        ScanOrder order = ScanOrder::arbitrary,
+        size_t max_queued_batches = 0);
+
     /**
      * @brief Read the next chunk of results from the query. If all results
      * have already been read, std::nullopt is returned.
@@ -426,6 +642,41 @@ class SOMAArray : public SOMAObject {
      */
     std::optional<std::shared_ptr<ArrayBuffers>> read_next();
 
+    /**
+     * @brief Read the next chunk of results and export it as an Arrow struct
+     * array, i.e. a record batch, with a copy of its schema. The schema is
+     * built from the first batch and reused while later batches have the
+     * same columns, so those only export their arrays. See BatchExporter.
+     * If all results have already been read, std::nullopt is returned.
+     *
+     * @return std::optional<ArrowTable>
+     */
+    std::optional<ArrowTable> read_next_arrow();
+
+    /**
+     * @brief Submit the read of the next batch without waiting for it, so
+     * that TileDB reads it while the caller processes the previous batch.
+     * The next call to `read_next` returns its results. This holds the
+     * buffers of two batches at once. Does nothing if the query is complete
+     * or a read is already in flight.
+     */
+    void prefetch_next();
+
+    /**
+     * @brief Export the reads of the current query as an Arrow C stream of
+     * record batches, which pyarrow, nanoarrow, DuckDB or Polars consume
+     * without per-column conversions. Each call to `get_next` returns the
+     * next non-empty batch of `read_next` as a struct array. See
+     * ArrayStream.
+     *
+     * The array must stay open, and must not be read otherwise, until the
+     * stream is released.
+     *
+     * @param stream Uninitialized stream
+     * @param prefetch Read the next batch while the current one is consumed
+     */
+    void to_arrow_stream(struct ArrowArrayStream* stream, bool prefetch = true);
+
     /**
      * @brief Set the write buffers for a single column.
      *
@@ -486,6 +737,24 @@ class SOMAArray : public SOMAObject {
      */
     void write(bool sort_coords = true);
 
+    /**
+     * @brief Write every record batch of an Arrow C stream, one fragment
+     * per non-empty batch, in stream order. The stream schema is checked
+     * against the array schema once, before anything is written. Each batch
+     * is cast to the on-disk types while the previous one is written by
+     * TileDB, so at most two batches are held at once.
+     *
+     * Only sparse arrays are supported, since dense writes need a subarray
+     * per batch. The stream is released, even if a write fails.
+     *
+     * @param stream Stream of struct arrays, one field per column
+     * @param sort_coords Whether the coordinates of each batch need to be
+     * sorted, as in `write`
+     * @return uint64_t Number of cells written
+     */
+    uint64_t write_stream(
+        struct ArrowArrayStream* stream, bool sort_coords = true);
+
     /**
      * @brief Consolidates and vacuums fragment metadata and commit files.
      *
@@ -533,6 +802,18 @@ class SOMAArray : public SOMAObject {
         return mq_->total_num_cells();
     }
 
+    /**
+     * @brief Return TileDB's estimate of the result size of each column of
+     * the next read, for the ranges selected so far. Only available before
+     * the first call to `read_next`.
+     *
+     * @return std::map<std::string, ResultSizeEstimate> Column name ->
+     * estimate
+     */
+    std::map<std::string, ResultSizeEstimate> estimate_result_sizes() {
+        return mq_->estimate_result_sizes();
+    }
+
     /**
      * @brief Return whether next read is the initial read, or a subsequent
      * read of a previous incomplete query.
@@ -561,14 +842,12 @@ class SOMAArray : public SOMAObject {
     }
 
     /**
-     * @brief Get the Arrow schema of the array.
+     * @brief Get the Arrow schema of the array. It is derived once per open
+     * array, and each call returns a copy owned by the caller.
      *
      * @return std::unique_ptr<ArrowSchema> Schema
      */
-    std::unique_ptr<ArrowSchema> arrow_schema() const {
-        return ArrowAdapter::arrow_schema_from_tiledb_array(
-            ctx_->tiledb_ctx(), arr_);
-    }
+    std::unique_ptr<ArrowSchema> arrow_schema() const;
 
     /**
      * @brief Get the current capacity of each dimension.
@@ -796,6 +1075,27 @@ class SOMAArray : public SOMAObject {
      */
     std::optional<TimestampRange> timestamp();
 
+   protected:
+    //===================================================================
+    //= protected non-static
+    //===================================================================
+
+    /**
+     * Return the open TileDB array, for subclasses that issue queries
+     * of their own alongside the managed query.
+     */
+    std::shared_ptr<Array> tiledb_array() const {
+        return arr_;
+    }
+
+    /**
+     * Return the managed query, for subclasses that read in several
+     * phases.
+     */
+    ManagedQuery& managed_query() {
+        return *mq_;
+    }
+
    private:
     //===================================================================
     //= private non-static
@@ -849,8 +1149,7 @@ class SOMAArray : public SOMAObject {
         ArraySchemaEvolution se) {
         std::string column_name = index_schema->name;
         auto disk_index_type = tiledb_schema()->attribute(column_name).type();
-        auto enmr = ArrayExperimental::get_enumeration(
-            *ctx_->tiledb_ctx(), *arr_, column_name);
+        auto enmr = _get_enumeration(column_name);
         uint64_t max_capacity = SOMAArray::_get_max_capacity(disk_index_type);
 
         const void* data;
@@ -881,6 +1180,8 @@ class SOMAArray : public SOMAObject {
             }
             auto extended_enmr = enmr.extend(extend_values);
             se.extend_enumeration(extended_enmr);
+            extended_enumerations_.insert_or_assign(
+                column_name, extended_enmr);
             SOMAArray::_remap_indexes(
                 column_name,
                 extended_enmr,
@@ -888,14 +1189,24 @@ class SOMAArray : public SOMAObject {
                 index_schema,
                 index_array);
 
-            index_schema->format = ArrowAdapter::to_arrow_format(
-                                       disk_index_type)
-                                       .data();
+            free((void*)index_schema->format);
+            index_schema->format = strdup(
+                ArrowAdapter::to_arrow_format(disk_index_type).data());
             return true;
         }
         return false;
     }
 
+    /**
+     * @brief Return the enumeration of a column, as extended by the previous
+     * writes of this handle. arr_ is not reopened after a schema evolution,
+     * so its enumerations lack the values added since it was opened.
+     *
+     * @param column_name Name of the enumerated column
+     * @return Enumeration
+     */
+    Enumeration _get_enumeration(const std::string& column_name);
+
     bool _extend_and_evolve_schema_str(
         ArrowSchema* value_schema,
         ArrowArray* value_array,
@@ -1159,6 +1470,9 @@ class SOMAArray : public SOMAObject {
             casted_indexes.push_back(i);
         }
 
+        // The cast column owns the index buffer being replaced
+        free((void*)index_array->buffers[index_array->n_buffers - 1]);
+
         if (index_array->n_buffers == 3) {
             index_array->buffers[2] = malloc(
                 sizeof(DiskIndexType) * casted_indexes.size());
@@ -1269,8 +1583,10 @@ class SOMAArray : public SOMAObject {
         }
     }
 
-    // Helper function to cast Boolean of bits (Arrow) to uint8 (TileDB)
-    void _cast_bit_to_uint8(ArrowSchema* arrow_schema, ArrowArray* arrow_array);
+    // Helper function to cast Boolean of bits (Arrow) to uint8 (TileDB). The
+    // bits are replaced by a buffer allocated with malloc, and the previous
+    // buffer is left to its owner.
+    void _cast_bit_to_uint8(ArrowArray* arrow_array);
 
     // Helper function for set_column_data
     std::shared_ptr<ColumnBuffer> _setup_column_data(std::string_view name);
@@ -1278,11 +1594,26 @@ class SOMAArray : public SOMAObject {
     // Fills the metadata cache upon opening the array.
     void fill_metadata_cache();
 
-    // Helper function for set_array_data
+    // Helper function for set_array_data. The release callbacks of the cast
+    // table free it with _release_cast_schema and _release_cast_array.
     ArrowTable _cast_table(
         std::unique_ptr<ArrowSchema> arrow_schema,
         std::unique_ptr<ArrowArray> arrow_array);
 
+    // Release a table or column cast by _cast_table. Cast columns borrow the
+    // validity buffers and dictionaries of the input columns, so only the
+    // buffers, strings and structs allocated by the cast are freed.
+    static void _release_cast_schema(ArrowSchema* schema);
+    static void _release_cast_array(ArrowArray* array);
+
+    // Cast a table and set the write buffers of `mq` to its columns, which
+    // `buffers` holds until they are written
+    void _set_array_data(
+        ManagedQuery& mq,
+        ArrayBuffers& buffers,
+        std::unique_ptr<ArrowSchema> arrow_schema,
+        std::unique_ptr<ArrowArray> arrow_array);
+
     // SOMAArray URI
     std::string uri_;
 
@@ -1310,6 +1641,16 @@ class SOMAArray : public SOMAObject {
     // Array associated with mq_
     std::shared_ptr<Array> arr_;
 
+    // Enumerations extended by writes since arr_ was opened, by column name
+    std::map<std::string, Enumeration> extended_enumerations_;
+
+    // Arrow schema of arr_, derived on the first call to arrow_schema()
+    mutable std::shared_ptr<ArrowSchema> arrow_schema_;
+
+    // Exporter of the batches of read_next_arrow(), created on its first
+    // call
+    std::shared_ptr<BatchExporter> batch_exporter_;
+
     // Array associated with metadata_. Metadata values need to be
     // accessible in write mode as well. We need to keep this read-mode
     // array alive in order for the metadata value pointers in the cache to
@@ -1319,7 +1660,8 @@ class SOMAArray : public SOMAObject {
     // True if this is the first call to read_next()
     bool first_read_next_ = true;
 
-    // True if the query was submitted
+    // True if a read was submitted by `prefetch_next` and its results not
+    // yet returned by `read_next`
     bool submitted_ = false;
 
     // Unoptimized method for computing nnz() (issue `count_cells` query)
@@ -31,9 +31,113 @@
  */
 #include "soma_context.h"
 #include <thread_pool/thread_pool.h>
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <exception>
+#include <thread>
+#include "../utils/common.h"
+#include "../utils/logger.h"
+
+#ifdef __linux__
+#include <sched.h>
+#endif
 
 namespace tiledbsoma {
 
+namespace {
+
+// CPUs that fit in an affinity mask
+#ifdef __linux__
+constexpr size_t MAX_CPUS = CPU_SETSIZE;
+#else
+constexpr size_t MAX_CPUS = 1024;
+#endif
+
+// Parse one CPU number of a CPU list, rejecting signs, spaces and any
+// trailing characters that std::stoul would skip or ignore
+size_t parse_cpu(const std::string& text) {
+    if (text.empty() ||
+        !std::all_of(text.begin(), text.end(), [](unsigned char c) {
+            return std::isdigit(c);
+        })) {
+        throw std::invalid_argument(text);
+    }
+    size_t pos;
+    size_t cpu = std::stoul(text, &pos);
+    if (pos != text.size()) {
+        throw std::invalid_argument(text);
+    }
+    return cpu;
+}
+
+// Parse a CPU list such as "0-3,8,10-11"
+std::vector<size_t> parse_cpu_list(const std::string& cpu_list) {
+    std::vector<size_t> cpus;
+    size_t start = 0;
+    while (true) {
+        // Split on commas by hand: std::getline drops a trailing empty item
+        auto comma = cpu_list.find(',', start);
+        auto item = cpu_list.substr(start, comma - start);
+        try {
+            auto dash = item.find('-');
+            size_t first = parse_cpu(item.substr(0, dash));
+            size_t last = first;
+            if (dash != std::string::npos) {
+                last = parse_cpu(item.substr(dash + 1));
+            }
+            if (last < first) {
+                throw std::invalid_argument(item);
+            }
+            if (last >= MAX_CPUS) {
+                throw TileDBSOMAError(fmt::format(
+                    "[SOMAContext] CPU {} of '{}' for {} is beyond the {} "
+                    "CPUs an affinity mask can hold",
+                    last,
+                    cpu_list,
+                    SOMAContext::CONFIG_KEY_THREAD_POOL_CPU_AFFINITY,
+                    MAX_CPUS));
+            }
+            for (size_t cpu = first; cpu <= last; cpu++) {
+                cpus.push_back(cpu);
+            }
+        } catch (const std::logic_error&) {
+            throw TileDBSOMAError(
+                "[SOMAContext] Invalid CPU list '" + cpu_list + "' for " +
+                SOMAContext::CONFIG_KEY_THREAD_POOL_CPU_AFFINITY);
+        }
+        if (comma == std::string::npos) {
+            break;
+        }
+        start = comma + 1;
+    }
+    return cpus;
+}
+
+}  // namespace
+
+void SOMAContext::init_cpu_affinity() {
+    auto cfg = tiledb_config();
+    auto it = cfg.find(CONFIG_KEY_THREAD_POOL_CPU_AFFINITY);
+    if (it == cfg.end()) {
+        return;
+    }
+    cpu_affinity_ = parse_cpu_list(it->second);
+
+    // Workers cannot run on CPUs that are not online
+    size_t num_cpus = std::thread::hardware_concurrency();
+    auto max_cpu = *std::max_element(
+        cpu_affinity_.begin(), cpu_affinity_.end());
+    if (num_cpus > 0 && max_cpu >= num_cpus) {
+        LOG_WARN(fmt::format(
+            "[SOMAContext] CPU {} of {} is not among the {} online CPUs and "
+            "will not be used",
+            max_cpu,
+            CONFIG_KEY_THREAD_POOL_CPU_AFFINITY,
+            num_cpus));
+    }
+}
+
 std::shared_ptr<ThreadPool>& SOMAContext::thread_pool() {
     const std::lock_guard<std::mutex> lock(thread_pool_mutex_);
     // The first thread that gets here will create the context thread pool
@@ -45,9 +149,92 @@ std::shared_ptr<ThreadPool>& SOMAContext::thread_pool() {
         }
         int thread_count = std::max(1, concurrency / 2);
         if (thread_count > 1) {
-            thread_pool_ = std::make_shared<ThreadPool>(thread_count);
+            bool pin_workers = false;
+            if (auto it = cfg.find(CONFIG_KEY_THREAD_POOL_PIN_WORKERS);
+                it != cfg.end()) {
+                pin_workers = it->second == "true";
+            }
+            thread_pool_ = std::make_shared<ThreadPool>(
+                thread_count, cpu_affinity_, pin_workers);
         }
     }
     return thread_pool_;
 }
+
+void SOMAContext::parallel_for(
+    size_t begin,
+    size_t end,
+    size_t grain_size,
+    const std::function<void(size_t, size_t)>& fn,
+    size_t max_concurrency) {
+    if (end <= begin) {
+        return;
+    }
+    size_t size = end - begin;
+    grain_size = std::max<size_t>(grain_size, 1);
+
+    // Serial cutoff
+    std::shared_ptr<ThreadPool> pool = thread_pool();
+    size_t concurrency = pool == nullptr ? 1 : pool->concurrency_level();
+    if (max_concurrency > 0) {
+        concurrency = std::min(concurrency, max_concurrency);
+    }
+    if (concurrency <= 1 || size <= grain_size) {
+        fn(begin, end);
+        return;
+    }
+
+    // Aim for a few chunks per thread so that threads which finish early can
+    // pick up the slack, but never go below the grain size.
+    size_t chunk_size = std::max(grain_size, size / (4 * concurrency));
+    size_t num_chunks = (size + chunk_size - 1) / chunk_size;
+    size_t num_tasks = std::min(concurrency, num_chunks);
+
+    std::atomic<size_t> cursor{begin};
+    std::atomic<bool> failed{false};
+    std::exception_ptr error = nullptr;
+    std::mutex error_mutex;
+
+    auto drain = [&]() {
+        while (!failed.load(std::memory_order_relaxed)) {
+            size_t chunk_begin = cursor.fetch_add(chunk_size);
+            if (chunk_begin >= end) {
+                break;
+            }
+            size_t chunk_end = std::min(end, chunk_begin + chunk_size);
+            try {
+                fn(chunk_begin, chunk_end);
+            } catch (...) {
+                const std::lock_guard<std::mutex> lock(error_mutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+                failed.store(true);
+            }
+        }
+    };
+
+    // The calling thread is one of the workers
+    std::vector<ThreadPool::Task> tasks;
+    tasks.reserve(num_tasks - 1);
+    for (size_t i = 1; i < num_tasks; i++) {
+        tasks.emplace_back(pool->execute([&drain]() {
+            drain();
+            return Status::Ok();
+        }));
+    }
+    drain();
+
+    // Every task must be waited on before returning, since they reference
+    // this frame. A task the pool failed to run, e.g. after shutdown, means
+    // the pool is broken: report it rather than carry on silently.
+    auto status = pool->wait_all(tasks);
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    if (!status.ok()) {
+        throw TileDBSOMAError(
+            "[SOMAContext] parallel_for task failed: " + status.to_string());
+    }
+}
 }  // namespace tiledbsoma
@@ -33,10 +33,12 @@
 #ifndef SOMA_CONTEXT
 #define SOMA_CONTEXT
 
+#include <functional>
 #include <map>
 #include <mutex>
 #include <string>
 #include <tiledb/tiledb>
+#include <vector>
 
 namespace tiledbsoma {
 class ThreadPool;
@@ -45,6 +47,20 @@ using namespace tiledb;
 
 class SOMAContext {
    public:
+    /**
+     * Config key listing the CPUs the SOMA thread pool workers may run on,
+     * e.g. "0-7,16-23". Unset means no pinning.
+     */
+    static inline const std::string CONFIG_KEY_THREAD_POOL_CPU_AFFINITY =
+        "soma.thread_pool.cpu_affinity";
+
+    /**
+     * Config key which, when "true", pins each worker to a single CPU of the
+     * affinity list (round robin) rather than to the whole list.
+     */
+    static inline const std::string CONFIG_KEY_THREAD_POOL_PIN_WORKERS =
+        "soma.thread_pool.pin_workers";
+
     //===================================================================
     //= public non-static
     //===================================================================
@@ -52,9 +68,16 @@ class SOMAContext {
         : ctx_(std::make_shared<Context>(Config({})))
         , thread_pool_mutex_(){};
 
+    /**
+     * @brief Create a context from a TileDB config. The `soma.thread_pool.*`
+     * keys are validated here, so a malformed value fails immediately rather
+     * than on first use of the thread pool.
+     */
     SOMAContext(std::map<std::string, std::string> tiledb_config)
         : ctx_(std::make_shared<Context>(Config(tiledb_config)))
-        , thread_pool_mutex_(){};
+        , thread_pool_mutex_() {
+        init_cpu_affinity();
+    };
 
     bool operator==(const SOMAContext& other) const {
         return ctx_ == other.ctx_;
@@ -71,16 +94,54 @@ class SOMAContext {
         return cfg;
     }
 
+    /**
+     * @brief Return the context thread pool, creating it on first use. The
+     * pool has half of `sm.compute_concurrency_level` threads, placed
+     * according to the `soma.thread_pool.*` config keys. Returns nullptr if
+     * the pool would have a single thread.
+     */
     std::shared_ptr<ThreadPool>& thread_pool();
 
+    /**
+     * @brief Call `fn(chunk_begin, chunk_end)` over disjoint chunks covering
+     * [begin, end), in parallel on the context thread pool.
+     *
+     * Chunks hold at least `grain_size` elements and are claimed dynamically
+     * from a shared cursor, so skewed chunks balance across threads. The
+     * calling thread takes part in the work. Ranges of at most `grain_size`
+     * elements, or contexts without a thread pool, run serially on the
+     * calling thread. The first exception thrown by `fn` is rethrown after
+     * all chunks have finished; a task the pool failed to run raises a
+     * TileDBSOMAError.
+     *
+     * @param begin First index of the range
+     * @param end One past the last index of the range
+     * @param grain_size Minimum number of elements per chunk
+     * @param fn Callable invoked once per chunk
+     * @param max_concurrency Maximum number of chunks processed at once, for
+     * chunks holding large resources, or 0 for the pool's concurrency level
+     */
+    void parallel_for(
+        size_t begin,
+        size_t end,
+        size_t grain_size,
+        const std::function<void(size_t, size_t)>& fn,
+        size_t max_concurrency = 0);
+
    private:
     //===================================================================
     //= private non-static
     //===================================================================
 
+    // Parse the CPU affinity list of the config into `cpu_affinity_`
+    void init_cpu_affinity();
+
     // TileDB context
     std::shared_ptr<Context> ctx_;
 
+    // CPUs the thread pool workers may run on, empty for no pinning
+    std::vector<size_t> cpu_affinity_;
+
     // Threadpool
     std::shared_ptr<ThreadPool> thread_pool_ = nullptr;
 
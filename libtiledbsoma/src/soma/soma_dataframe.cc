@@ -31,6 +31,9 @@
  */
 
 #include "soma_dataframe.h"
+#include "../utils/logger.h"
+#include "../utils/stats.h"
+#include "value_filter.h"
 
 namespace tiledbsoma {
 using namespace tiledb;
@@ -94,4 +97,83 @@ uint64_t SOMADataFrame::count() {
     return this->nnz();
 }
 
+std::vector<std::shared_ptr<ArrayBuffers>>
+SOMADataFrame::read_late_materialized(std::vector<std::string> column_names) {
+    const std::string joinid = "soma_joinid";
+    auto array = tiledb_array();
+    auto schema = array->schema();
+    if (!schema.domain().has_dimension(joinid)) {
+        throw TileDBSOMAError(fmt::format(
+            "[SOMADataFrame] [{}] Late materialization requires '{}' to be "
+            "an index column",
+            uri(),
+            joinid));
+    }
+
+    auto& mq = managed_query();
+    if (column_names.empty()) {
+        column_names = mq.column_names();
+    }
+    if (column_names.empty()) {
+        for (const auto& dim : schema.domain().dimensions()) {
+            column_names.push_back(dim.name());
+        }
+        for (uint32_t i = 0; i < schema.attribute_num(); i++) {
+            column_names.push_back(schema.attribute(i).name());
+        }
+    }
+
+    // Phase 1: find the soma_joinid of the matching rows
+    std::vector<std::string> filter_columns = {joinid};
+    if (auto filter = mq.value_filter()) {
+        for (auto& name : filter->columns()) {
+            if (name != joinid) {
+                filter_columns.push_back(name);
+            }
+        }
+    }
+
+    // On a query of its own, so the caller's column selection is kept
+    ManagedQuery filter_mq(array, ctx()->tiledb_ctx(), uri());
+    filter_mq.copy_selection(mq);
+    filter_mq.select_columns(filter_columns);
+
+    std::vector<int64_t> joinids;
+    do {
+        filter_mq.setup_read();
+        if (filter_mq.is_empty_query()) {
+            break;
+        }
+        filter_mq.submit_read();
+        auto values = filter_mq.results()->at(joinid)->data<int64_t>();
+        joinids.insert(joinids.end(), values.begin(), values.end());
+    } while (!filter_mq.is_complete(true));
+    stats::add_counter("soma.dataframe.late_materialized_rows", joinids.size());
+    LOG_DEBUG(fmt::format(
+        "[SOMADataFrame] [{}] Late materializing {} rows",
+        uri(),
+        joinids.size()));
+
+    // Phase 2: read the requested columns of the matching rows. When the
+    // rows form more runs than the ranges selected, the query filters
+    // soma_joinid itself, reading it even if it was not requested.
+    ManagedQuery rows_mq(array, ctx()->tiledb_ctx(), uri());
+    rows_mq.set_layout(mq.layout());
+    rows_mq.select_columns(column_names);
+    rows_mq.set_max_ranges(LATE_MATERIALIZATION_MAX_RANGES);
+    rows_mq.select_points(joinid, joinids);
+
+    std::vector<std::shared_ptr<ArrayBuffers>> batches;
+    do {
+        rows_mq.setup_read();
+        if (rows_mq.is_empty_query()) {
+            batches.push_back(rows_mq.results());
+            break;
+        }
+        rows_mq.submit_read();
+        batches.push_back(rows_mq.results());
+    } while (!rows_mq.is_complete(true));
+    return batches;
+}
+
 }  // namespace tiledbsoma
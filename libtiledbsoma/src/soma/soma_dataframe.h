@@ -163,6 +163,34 @@ class SOMADataFrame : public SOMAArray {
      * @return int64_t
      */
     uint64_t count();
+
+    /**
+     * @brief Read the rows matching the current selection in two phases.
+     * The first phase reads only `soma_joinid` and the columns of the value
+     * filter, applying the ranges, query condition and value filter set on
+     * the array. The second phase reads `column_names` for the matching
+     * `soma_joinid` values only, coalesced into ranges. For selective
+     * predicates over wide dataframes, this avoids reading the other
+     * columns of the rows that do not match.
+     *
+     * Both phases run on queries of their own, which copy the selection of
+     * the array's query: its columns are left as they were and it can still
+     * be read with `read_next`. `soma_joinid` must be an index column.
+     *
+     * @param column_names Columns to return. Defaults to the selected
+     * columns, or all columns if none are selected.
+     * @return std::vector<std::shared_ptr<ArrayBuffers>> Batches of results
+     */
+    std::vector<std::shared_ptr<ArrayBuffers>> read_late_materialized(
+        std::vector<std::string> column_names = {});
+
+   private:
+    /*
+     * Maximum number of ranges the matching soma_joinid values are coalesced
+     * into. Closer ranges are merged and the rows between them are filtered
+     * out of the results.
+     */
+    static constexpr size_t LATE_MATERIALIZATION_MAX_RANGES = 1 << 12;
 };
 }  // namespace tiledbsoma
 
@@ -30,6 +30,8 @@
  *   This file defines the SOMADenseNDArray class.
  */
 #include "soma_dense_ndarray.h"
+#include "../utils/logger.h"
+#include "../utils/stats.h"
 
 namespace tiledbsoma {
 using namespace tiledb;
@@ -123,4 +125,114 @@ std::unique_ptr<ArrowSchema> SOMADenseNDArray::schema() const {
     return this->arrow_schema();
 }
 
+void SOMADenseNDArray::read_into(
+    const std::vector<std::pair<int64_t, int64_t>>& ranges,
+    void* data,
+    uint64_t nbytes,
+    const std::vector<int64_t>& strides) {
+    if (mode() != OpenMode::read) {
+        throw TileDBSOMAError(
+            "[SOMADenseNDArray] read_into requires the array to be opened in "
+            "read mode");
+    }
+
+    auto schema = tiledb_schema();
+    auto ndim = schema->domain().ndim();
+    if (ranges.size() != ndim || strides.size() != ndim) {
+        throw TileDBSOMAError(fmt::format(
+            "[SOMADenseNDArray] read_into expects {} ranges and strides, got "
+            "{} and {}",
+            ndim,
+            ranges.size(),
+            strides.size()));
+    }
+
+    // Strides of a contiguous buffer, in row-major and column-major order
+    auto cell_size = static_cast<int64_t>(
+        tiledb::impl::type_size(schema->attribute("soma_data").type()));
+    std::vector<int64_t> shape(ndim);
+    std::vector<int64_t> row_major(ndim);
+    std::vector<int64_t> col_major(ndim);
+    uint64_t num_cells = 1;
+    for (uint32_t i = 0; i < ndim; i++) {
+        auto [lo, hi] = ranges[i];
+        if (hi < lo) {
+            throw TileDBSOMAError(fmt::format(
+                "[SOMADenseNDArray] Invalid range [{}, {}] for dimension {}",
+                lo,
+                hi,
+                i));
+        }
+        shape[i] = hi - lo + 1;
+        num_cells *= shape[i];
+    }
+    int64_t stride = cell_size;
+    for (uint32_t i = ndim; i-- > 0;) {
+        row_major[i] = stride;
+        stride *= shape[i];
+    }
+    stride = cell_size;
+    for (uint32_t i = 0; i < ndim; i++) {
+        col_major[i] = stride;
+        stride *= shape[i];
+    }
+
+    auto matches = [&](const std::vector<int64_t>& expected) {
+        for (uint32_t i = 0; i < ndim; i++) {
+            if (shape[i] > 1 && strides[i] != expected[i]) {
+                return false;
+            }
+        }
+        return true;
+    };
+    tiledb_layout_t layout;
+    if (matches(row_major)) {
+        layout = TILEDB_ROW_MAJOR;
+    } else if (matches(col_major)) {
+        layout = TILEDB_COL_MAJOR;
+    } else {
+        throw TileDBSOMAError(
+            "[SOMADenseNDArray] read_into requires a contiguous row-major or "
+            "column-major buffer of the soma_data type");
+    }
+
+    if (nbytes < num_cells * cell_size) {
+        throw TileDBSOMAError(fmt::format(
+            "[SOMADenseNDArray] Output buffer of {} bytes is too small for {} "
+            "cells of {} bytes",
+            nbytes,
+            num_cells,
+            cell_size));
+    }
+
+    stats::ScopedTimer timer("soma.dense_ndarray.read_into");
+
+    auto ctx = this->ctx()->tiledb_ctx();
+    auto array = tiledb_array();
+    Subarray subarray(*ctx, *array);
+    for (uint32_t i = 0; i < ndim; i++) {
+        subarray.add_range(i, ranges[i].first, ranges[i].second);
+    }
+
+    Query query(*ctx, *array);
+    query.set_subarray(subarray)
+        .set_layout(layout)
+        .set_data_buffer("soma_data", data, num_cells);
+    query.submit();
+
+    // The buffer holds every cell of the subarray, so the read always
+    // completes in one submit
+    if (query.query_status() != Query::Status::COMPLETE) {
+        throw TileDBSOMAError(
+            "[SOMADenseNDArray] read_into did not complete in one submit");
+    }
+
+    LOG_DEBUG(fmt::format(
+        "[SOMADenseNDArray] Read {} cells of '{}' into caller buffer",
+        num_cells,
+        uri()));
+    stats::add_counter(
+        "soma.dense_ndarray.read_into_bytes", num_cells * cell_size);
+}
+
 }  // namespace tiledbsoma
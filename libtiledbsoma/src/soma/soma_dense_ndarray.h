@@ -166,6 +166,27 @@ class SOMADenseNDArray : public SOMAArray {
      * @return std::string_view Arrow format string.
      */
     std::string_view soma_data_type();
+
+    /**
+     * @brief Read `soma_data` for a box of coordinates directly into a
+     * caller-owned buffer, with a single query and no intermediate
+     * ColumnBuffers or Arrow conversion. Cells that were never written
+     * hold the fill value of `soma_data`.
+     *
+     * The buffer must be contiguous, in either row-major or column-major
+     * order, which selects the query layout. Strides of dimensions with a
+     * single coordinate are ignored, as they do not affect the layout.
+     *
+     * @param ranges One inclusive coordinate range per dimension
+     * @param data Output buffer
+     * @param nbytes Size of the output buffer in bytes
+     * @param strides Stride in bytes of each dimension of the buffer
+     */
+    void read_into(
+        const std::vector<std::pair<int64_t, int64_t>>& ranges,
+        void* data,
+        uint64_t nbytes,
+        const std::vector<int64_t>& strides);
 };
 }  // namespace tiledbsoma
 
@@ -31,10 +31,58 @@
  */
 
 #include "soma_sparse_ndarray.h"
+#include <mutex>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include "../reindexer/reindexer.h"
+#include "../utils/logger.h"
+#include "../utils/stats.h"
+#include "../utils/util.h"
 
 namespace tiledbsoma {
 using namespace tiledb;
 
+namespace {
+
+// Add the values of one result batch to the sums and counts at the
+// positions held by the batch coordinates, less `offset`
+template <typename T, typename Sum>
+void accumulate_batch(
+    tcb::span<const int64_t> positions,
+    tcb::span<const T> values,
+    int64_t offset,
+    std::vector<Sum>& sums,
+    std::vector<int64_t>& counts) {
+    const int64_t size = static_cast<int64_t>(sums.size());
+    for (size_t i = 0; i < positions.size(); i++) {
+        int64_t pos = positions[i] - offset;
+        // Coordinates missing from the indexer are looked up as -1
+        if (pos < 0 || pos >= size) {
+            continue;
+        }
+        sums[pos] += static_cast<Sum>(values[i]);
+        counts[pos]++;
+    }
+}
+
+// Build an int64 or float64 result column
+template <typename V>
+std::shared_ptr<ColumnBuffer> reduce_column(
+    const std::string& name, std::vector<V>& values) {
+    auto column = std::make_shared<ColumnBuffer>(
+        name,
+        std::is_floating_point_v<V> ? TILEDB_FLOAT64 : TILEDB_INT64,
+        values.size(),
+        values.size() * sizeof(V),
+        false,
+        false);
+    column->set_data(values.size(), values.data());
+    return column;
+}
+
+}  // namespace
+
 //===================================================================
 //= public static
 //===================================================================
@@ -123,4 +171,141 @@ std::string_view SOMASparseNDArray::soma_data_type() {
 std::unique_ptr<ArrowSchema> SOMASparseNDArray::schema() const {
     return this->arrow_schema();
 }
+
+std::shared_ptr<ArrayBuffers> SOMASparseNDArray::reduce_by_dim(
+    const std::string& dim_name, std::shared_ptr<IntIndexer> indexer) {
+    if (mode() != OpenMode::read) {
+        throw TileDBSOMAError(
+            "[SOMASparseNDArray] reduce_by_dim requires the array to be "
+            "opened in read mode");
+    }
+    auto domain = tiledb_schema()->domain();
+    if (!domain.has_dimension(dim_name) ||
+        domain.dimension(dim_name).type() != TILEDB_INT64) {
+        throw TileDBSOMAError(fmt::format(
+            "[SOMASparseNDArray] Can only reduce onto an int64 dimension, not "
+            "'{}'",
+            dim_name));
+    }
+
+    stats::ScopedTimer timer("soma.sparse_ndarray.reduce_by_dim");
+
+    auto array = tiledb_array();
+    auto type = tiledb_schema()->attribute("soma_data").type();
+    uint64_t num_cells = nnz();
+    bool is_empty = num_cells == 0;
+    // Not a structured binding, which lambdas cannot capture in C++17
+    int64_t lo = 0;
+    int64_t hi = -1;
+    if (!is_empty) {
+        std::tie(lo, hi) = array->non_empty_domain<int64_t>(dim_name);
+    }
+    size_t num_coords = is_empty ? 0 :
+                                   static_cast<uint64_t>(hi) -
+                                       static_cast<uint64_t>(lo) + 1;
+
+    // Accumulate into vectors indexed by the indexer positions, or by the
+    // offsets into the non-empty domain when it is dense enough. Otherwise
+    // each query accumulates into a hash map of the coordinates it reads.
+    bool is_dense = indexer != nullptr ||
+                    num_coords / REDUCE_DENSE_FACTOR <= num_cells;
+    size_t num_positions = indexer != nullptr ? indexer->size() :
+                           is_dense           ? num_coords :
+                                                0;
+    int64_t offset = indexer != nullptr ? 0 : lo;
+
+    return util::visit_numeric_type(type, [&](auto t) {
+        using T = decltype(t);
+        using Sum = std::
+            conditional_t<std::is_floating_point_v<T>, double, int64_t>;
+
+        std::vector<Sum> sums(num_positions, 0);
+        std::vector<int64_t> counts(num_positions, 0);
+
+        // Coordinate, sum and count of each coordinate of a sparse domain
+        std::vector<std::tuple<int64_t, Sum, int64_t>> entries;
+        std::mutex entries_mutex;
+
+        // Offsets into [lo, hi] are split into disjoint coordinate ranges,
+        // each read by a query of its own. At most REDUCE_MAX_QUERIES run at
+        // once, since each holds its own read buffers.
+        ctx()->parallel_for(
+            0,
+            num_coords,
+            REDUCE_GRAIN_SIZE,
+            [&](size_t begin, size_t end) {
+                ManagedQuery mq(array, ctx()->tiledb_ctx(), uri());
+                mq.set_layout(TILEDB_UNORDERED);
+                mq.select_columns({dim_name, "soma_data"});
+                mq.select_ranges<int64_t>(
+                    dim_name,
+                    {{lo + static_cast<int64_t>(begin),
+                      lo + static_cast<int64_t>(end - 1)}});
+                mq.set_dim_indexer(dim_name, indexer);
+
+                std::unordered_map<int64_t, std::pair<Sum, int64_t>> local;
+                do {
+                    mq.setup_read();
+                    mq.submit_read();
+                    auto batch = mq.results();
+                    auto coords = batch->at(dim_name)->data<int64_t>();
+                    auto values = batch->at("soma_data")->data<T>();
+                    if (is_dense) {
+                        accumulate_batch<T, Sum>(
+                            coords, values, offset, sums, counts);
+                        continue;
+                    }
+                    for (size_t i = 0; i < coords.size(); i++) {
+                        auto& [sum, count] = local[coords[i]];
+                        sum += static_cast<Sum>(values[i]);
+                        count++;
+                    }
+                } while (!mq.is_complete(true));
+
+                if (!local.empty()) {
+                    const std::lock_guard<std::mutex> lock(entries_mutex);
+                    for (auto& [coord, acc] : local) {
+                        entries.emplace_back(coord, acc.first, acc.second);
+                    }
+                }
+            },
+            REDUCE_MAX_QUERIES);
+
+        LOG_DEBUG(fmt::format(
+            "[SOMASparseNDArray] Reduced {} coordinates of '{}' ({})",
+            num_coords,
+            dim_name,
+            is_dense ? "dense" : "sparse"));
+
+        auto buffers = std::make_shared<ArrayBuffers>();
+        if (indexer != nullptr) {
+            buffers->emplace("sum", reduce_column("sum", sums));
+            buffers->emplace("count", reduce_column("count", counts));
+            return buffers;
+        }
+
+        // Without an indexer, keep the coordinates holding values
+        if (is_dense) {
+            for (size_t i = 0; i < num_positions; i++) {
+                if (counts[i] > 0) {
+                    entries.emplace_back(
+                        lo + static_cast<int64_t>(i), sums[i], counts[i]);
+                }
+            }
+        } else {
+            std::sort(entries.begin(), entries.end());
+        }
+        std::vector<int64_t> coord_values(entries.size());
+        std::vector<Sum> sum_values(entries.size());
+        std::vector<int64_t> count_values(entries.size());
+        for (size_t i = 0; i < entries.size(); i++) {
+            std::tie(coord_values[i], sum_values[i], count_values[i]) =
+                entries[i];
+        }
+        buffers->emplace(dim_name, reduce_column(dim_name, coord_values));
+        buffers->emplace("sum", reduce_column("sum", sum_values));
+        buffers->emplace("count", reduce_column("count", count_values));
+        return buffers;
+    });
+}
 }  // namespace tiledbsoma
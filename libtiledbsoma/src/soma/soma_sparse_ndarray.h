@@ -40,6 +40,7 @@
 namespace tiledbsoma {
 
 class ArrayBuffers;
+class IntIndexer;
 
 using namespace tiledb;
 
@@ -165,6 +166,56 @@ class SOMASparseNDArray : public SOMAArray {
      * @return std::string_view Arrow format string.
      */
     std::string_view soma_data_type();
+
+    /**
+     * @brief Compute the sum and the number of stored values of `soma_data`
+     * for each coordinate of one dimension, e.g. the per-row (`soma_dim_0`)
+     * or per-column (`soma_dim_1`) marginals of a matrix.
+     *
+     * The array is scanned on the context thread pool, one query per
+     * disjoint range of `dim_name` coordinates and at most
+     * `REDUCE_MAX_QUERIES` queries at a time. Since the ranges map to
+     * disjoint result positions, the queries accumulate into shared vectors
+     * without locking. The managed query and its selection are not
+     * used or modified.
+     *
+     * Without an indexer, the result holds one row per coordinate storing
+     * at least one value, in ascending order, with the coordinates in a
+     * `dim_name` column. The sums are accumulated in vectors spanning the
+     * dimension's non-empty domain when it holds at least one cell per
+     * `REDUCE_DENSE_FACTOR` coordinates, and in hash maps otherwise. With
+     * an indexer, result row `i` is indexer position `i` and cells whose
+     * coordinate is not in the indexer are skipped.
+     *
+     * @param dim_name Dimension to reduce onto
+     * @param indexer Optional map from coordinates to result positions
+     * @return ArrayBuffers with the int64 `dim_name` column (without an
+     * indexer), a `sum` column (int64 for integral `soma_data`, float64
+     * otherwise) and an int64 `count` column
+     */
+    std::shared_ptr<ArrayBuffers> reduce_by_dim(
+        const std::string& dim_name,
+        std::shared_ptr<IntIndexer> indexer = nullptr);
+
+   private:
+    /*
+     * Minimum number of coordinates scanned by one query of
+     * reduce_by_dim. Each query has a fixed setup cost, so narrower
+     * ranges are not worth splitting across threads.
+     */
+    static constexpr size_t REDUCE_GRAIN_SIZE = 1 << 12;
+
+    /*
+     * Maximum number of queries of reduce_by_dim run at once. Each holds
+     * read buffers of up to `soma.init_buffer_bytes` per column.
+     */
+    static constexpr size_t REDUCE_MAX_QUERIES = 4;
+
+    /*
+     * Largest number of coordinates per stored cell for which reduce_by_dim
+     * accumulates into vectors spanning the non-empty domain.
+     */
+    static constexpr uint64_t REDUCE_DENSE_FACTOR = 4;
 };
 }  // namespace tiledbsoma
 
@@ -0,0 +1,532 @@
+/**
+ * @file   value_filter.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2024 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *   This file defines the ValueExpr and ValueFilter classes.
+ */
+
+#include "value_filter.h"
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include "../utils/logger.h"
+#include "../utils/util.h"
+#include "array_buffers.h"
+
+namespace tiledbsoma {
+
+using namespace tiledb;
+
+namespace {
+
+// Call `fn` with a value of the C++ type of a numeric column
+template <typename Fn>
+auto visit_column(ColumnBuffer& buffer, Fn&& fn) {
+    try {
+        return util::visit_numeric_type(buffer.type(), std::forward<Fn>(fn));
+    } catch (const std::invalid_argument& e) {
+        throw TileDBSOMAError(fmt::format(
+            "[ValueFilter] Column '{}' is not numeric: {}",
+            buffer.name(),
+            e.what()));
+    }
+}
+
+// Copy the validity of a column, or set every cell valid
+void column_validity(
+    ColumnBuffer& buffer, size_t num_rows, std::vector<uint8_t>& valid) {
+    if (buffer.is_nullable()) {
+        auto validity = buffer.validity();
+        valid.assign(validity.begin(), validity.begin() + num_rows);
+    } else {
+        valid.assign(num_rows, 1);
+    }
+}
+
+using Values = ValueExpr::Values;
+
+// The largest uint64 that is also an int64
+constexpr uint64_t INT64_RANGE_MAX = static_cast<uint64_t>(
+    std::numeric_limits<int64_t>::max());
+
+// The type a column of type T is evaluated in: double for floating-point
+// columns, uint64 for uint64 columns, and int64 for the other integers
+template <typename T>
+using eval_type_t = std::conditional_t<
+    std::is_floating_point_v<T>,
+    double,
+    std::conditional_t<std::is_same_v<T, uint64_t>, uint64_t, int64_t>>;
+
+// Convert values to type T in place, returning them
+template <typename T>
+std::vector<T>& promote(Values& values) {
+    if (!std::holds_alternative<std::vector<T>>(values)) {
+        std::vector<T> converted;
+        std::visit(
+            [&](const auto& from) {
+                converted.resize(from.size());
+                for (size_t i = 0; i < from.size(); i++) {
+                    converted[i] = static_cast<T>(from[i]);
+                }
+            },
+            values);
+        values = std::move(converted);
+    }
+    return std::get<std::vector<T>>(values);
+}
+
+// Convert two operands to their common type, double if either is
+// floating-point, else uint64 if either is uint64, else int64, and call `fn`
+// with them. The common type is the later of the two in `Values`.
+template <typename Fn>
+void visit_common(Values& lhs, Values& rhs, Fn&& fn) {
+    switch (std::max(lhs.index(), rhs.index())) {
+        case 0:
+            fn(promote<int64_t>(lhs), promote<int64_t>(rhs));
+            break;
+        case 1:
+            fn(promote<uint64_t>(lhs), promote<uint64_t>(rhs));
+            break;
+        default:
+            fn(promote<double>(lhs), promote<double>(rhs));
+            break;
+    }
+}
+
+// Integers are combined as uint64, so that overflow wraps around rather than
+// being undefined
+template <typename T, typename Op>
+void combine(std::vector<T>& values, const std::vector<T>& rhs, Op op) {
+    for (size_t i = 0; i < values.size(); i++) {
+        if constexpr (std::is_integral_v<T>) {
+            values[i] = static_cast<T>(op(
+                static_cast<uint64_t>(values[i]),
+                static_cast<uint64_t>(rhs[i])));
+        } else {
+            values[i] = op(values[i], rhs[i]);
+        }
+    }
+}
+
+// Compare two values exactly. An int64 and a uint64 are compared by sign
+// first; a floating-point operand makes the comparison a double one.
+template <typename L, typename R, typename Op>
+bool compare_value(L lhs, R rhs, Op op) {
+    if constexpr (std::is_same_v<L, R>) {
+        return op(lhs, rhs);
+    } else if constexpr (
+        std::is_floating_point_v<L> || std::is_floating_point_v<R>) {
+        return op(static_cast<double>(lhs), static_cast<double>(rhs));
+    } else if constexpr (std::is_signed_v<L>) {
+        return lhs < 0 ? op(0, 1) : op(static_cast<uint64_t>(lhs), rhs);
+    } else {
+        return rhs < 0 ? op(1, 0) : op(lhs, static_cast<uint64_t>(rhs));
+    }
+}
+
+template <typename Op>
+void compare_values(
+    const Values& lhs,
+    const Values& rhs,
+    std::vector<uint8_t>& match,
+    Op op) {
+    std::visit(
+        [&](const auto& lhs_values, const auto& rhs_values) {
+            for (size_t i = 0; i < match.size(); i++) {
+                match[i] &= compare_value(lhs_values[i], rhs_values[i], op);
+            }
+        },
+        lhs,
+        rhs);
+}
+
+void check_filters(const std::vector<std::shared_ptr<ValueFilter>>& filters) {
+    for (const auto& filter : filters) {
+        if (filter == nullptr) {
+            throw TileDBSOMAError("[ValueFilter] Missing filter operand");
+        }
+    }
+}
+
+}  // namespace
+
+//===================================================================
+//= ValueExpr
+//===================================================================
+
+std::shared_ptr<ValueExpr> ValueExpr::column(const std::string& name) {
+    std::shared_ptr<ValueExpr> expr(new ValueExpr(Kind::column));
+    expr->name_ = name;
+    return expr;
+}
+
+std::shared_ptr<ValueExpr> ValueExpr::literal(double value) {
+    std::shared_ptr<ValueExpr> expr(new ValueExpr(Kind::literal));
+    expr->value_ = value;
+    return expr;
+}
+
+std::shared_ptr<ValueExpr> ValueExpr::literal(int64_t value) {
+    std::shared_ptr<ValueExpr> expr(new ValueExpr(Kind::literal));
+    expr->value_ = value;
+    return expr;
+}
+
+std::shared_ptr<ValueExpr> ValueExpr::literal(uint64_t value) {
+    // Keep constants in the int64 range signed, so that they combine with
+    // signed columns as int64
+    if (value <= INT64_RANGE_MAX) {
+        return literal(static_cast<int64_t>(value));
+    }
+    std::shared_ptr<ValueExpr> expr(new ValueExpr(Kind::literal));
+    expr->value_ = value;
+    return expr;
+}
+
+std::shared_ptr<ValueExpr> ValueExpr::arithmetic(
+    ArithmeticOp op,
+    std::shared_ptr<ValueExpr> lhs,
+    std::shared_ptr<ValueExpr> rhs) {
+    if (lhs == nullptr || rhs == nullptr) {
+        throw TileDBSOMAError("[ValueFilter] Missing arithmetic operand");
+    }
+    std::shared_ptr<ValueExpr> expr(new ValueExpr(Kind::arithmetic));
+    expr->op_ = op;
+    expr->lhs_ = std::move(lhs);
+    expr->rhs_ = std::move(rhs);
+    return expr;
+}
+
+void ValueExpr::eval(
+    ArrayBuffers& batch, Values& values, std::vector<uint8_t>& valid) const {
+    size_t num_rows = batch.num_rows();
+
+    switch (kind_) {
+        case Kind::column: {
+            auto buffer = batch.at(name_);
+            visit_column(*buffer, [&](auto t) {
+                using T = decltype(t);
+                auto data = buffer->data<T>();
+                std::vector<eval_type_t<T>> column_values(num_rows);
+                for (size_t i = 0; i < num_rows; i++) {
+                    column_values[i] = static_cast<eval_type_t<T>>(data[i]);
+                }
+                values = std::move(column_values);
+                return 0;
+            });
+            column_validity(*buffer, num_rows, valid);
+            break;
+        }
+        case Kind::literal:
+            std::visit(
+                [&](auto value) {
+                    values = std::vector<decltype(value)>(num_rows, value);
+                },
+                value_);
+            valid.assign(num_rows, 1);
+            break;
+        case Kind::arithmetic: {
+            Values rhs;
+            std::vector<uint8_t> rhs_valid;
+            lhs_->eval(batch, values, valid);
+            rhs_->eval(batch, rhs, rhs_valid);
+            for (size_t i = 0; i < num_rows; i++) {
+                valid[i] &= rhs_valid[i];
+            }
+            if (op_ == ArithmeticOp::div) {
+                // Division by zero yields inf or nan, which only match `ne`
+                // comparisons
+                combine(
+                    promote<double>(values),
+                    promote<double>(rhs),
+                    std::divides<>());
+                break;
+            }
+            visit_common(values, rhs, [&](auto& lhs_values, auto& rhs_values) {
+                switch (op_) {
+                    case ArithmeticOp::add:
+                        combine(lhs_values, rhs_values, std::plus<>());
+                        break;
+                    case ArithmeticOp::sub:
+                        combine(lhs_values, rhs_values, std::minus<>());
+                        break;
+                    case ArithmeticOp::mul:
+                        combine(lhs_values, rhs_values, std::multiplies<>());
+                        break;
+                    case ArithmeticOp::div:
+                        break;
+                }
+            });
+            break;
+        }
+    }
+}
+
+void ValueExpr::add_columns(std::vector<std::string>& names) const {
+    switch (kind_) {
+        case Kind::column:
+            names.push_back(name_);
+            break;
+        case Kind::literal:
+            break;
+        case Kind::arithmetic:
+            lhs_->add_columns(names);
+            rhs_->add_columns(names);
+            break;
+    }
+}
+
+//===================================================================
+//= ValueFilter
+//===================================================================
+
+std::shared_ptr<ValueFilter> ValueFilter::compare(
+    CompareOp op,
+    std::shared_ptr<ValueExpr> lhs,
+    std::shared_ptr<ValueExpr> rhs) {
+    if (lhs == nullptr || rhs == nullptr) {
+        throw TileDBSOMAError("[ValueFilter] Missing comparison operand");
+    }
+    std::shared_ptr<ValueFilter> filter(new ValueFilter(Kind::compare));
+    filter->op_ = op;
+    filter->lhs_ = std::move(lhs);
+    filter->rhs_ = std::move(rhs);
+    return filter;
+}
+
+std::shared_ptr<ValueFilter> ValueFilter::in_set(
+    const std::string& column, const std::vector<int64_t>& values) {
+    std::shared_ptr<ValueFilter> filter(new ValueFilter(Kind::int_set));
+    filter->column_ = column;
+    filter->int_set_.insert(values.begin(), values.end());
+    return filter;
+}
+
+std::shared_ptr<ValueFilter> ValueFilter::in_set(
+    const std::string& column, const std::vector<std::string>& values) {
+    std::shared_ptr<ValueFilter> filter(new ValueFilter(Kind::string_set));
+    filter->column_ = column;
+    filter->strings_ = values;
+    filter->string_set_.reserve(values.size());
+    for (const auto& value : filter->strings_) {
+        filter->string_set_.insert(value);
+    }
+    return filter;
+}
+
+std::shared_ptr<ValueFilter> ValueFilter::all_of(
+    std::vector<std::shared_ptr<ValueFilter>> filters) {
+    check_filters(filters);
+    std::shared_ptr<ValueFilter> filter(new ValueFilter(Kind::all_of));
+    filter->children_ = std::move(filters);
+    return filter;
+}
+
+std::shared_ptr<ValueFilter> ValueFilter::any_of(
+    std::vector<std::shared_ptr<ValueFilter>> filters) {
+    check_filters(filters);
+    std::shared_ptr<ValueFilter> filter(new ValueFilter(Kind::any_of));
+    filter->children_ = std::move(filters);
+    return filter;
+}
+
+std::shared_ptr<ValueFilter> ValueFilter::negate(
+    std::shared_ptr<ValueFilter> filter) {
+    if (filter == nullptr) {
+        throw TileDBSOMAError("[ValueFilter] Missing negated filter");
+    }
+    std::shared_ptr<ValueFilter> result(new ValueFilter(Kind::negate));
+    result->children_ = {std::move(filter)};
+    return result;
+}
+
+void ValueFilter::apply(ArrayBuffers& batch, std::vector<uint8_t>& keep)
+    const {
+    std::vector<uint8_t> match;
+    eval(batch, match);
+    for (size_t i = 0; i < keep.size(); i++) {
+        keep[i] &= match[i];
+    }
+}
+
+std::vector<std::string> ValueFilter::columns() const {
+    std::vector<std::string> names;
+    add_columns(names);
+
+    // Deduplicate, keeping the first occurrence of each name
+    std::vector<std::string> unique;
+    for (auto& name : names) {
+        if (std::find(unique.begin(), unique.end(), name) == unique.end()) {
+            unique.push_back(name);
+        }
+    }
+    return unique;
+}
+
+void ValueFilter::eval(ArrayBuffers& batch, std::vector<uint8_t>& match)
+    const {
+    size_t num_rows = batch.num_rows();
+
+    switch (kind_) {
+        case Kind::compare: {
+            Values lhs, rhs;
+            std::vector<uint8_t> rhs_valid;
+            lhs_->eval(batch, lhs, match);
+            rhs_->eval(batch, rhs, rhs_valid);
+            for (size_t i = 0; i < num_rows; i++) {
+                match[i] &= rhs_valid[i];
+            }
+            switch (op_) {
+                case CompareOp::eq:
+                    compare_values(lhs, rhs, match, std::equal_to<>());
+                    break;
+                case CompareOp::ne:
+                    compare_values(lhs, rhs, match, std::not_equal_to<>());
+                    break;
+                case CompareOp::lt:
+                    compare_values(lhs, rhs, match, std::less<>());
+                    break;
+                case CompareOp::le:
+                    compare_values(lhs, rhs, match, std::less_equal<>());
+                    break;
+                case CompareOp::gt:
+                    compare_values(lhs, rhs, match, std::greater<>());
+                    break;
+                case CompareOp::ge:
+                    compare_values(lhs, rhs, match, std::greater_equal<>());
+                    break;
+            }
+            break;
+        }
+        case Kind::int_set: {
+            auto buffer = batch.at(column_);
+            column_validity(*buffer, num_rows, match);
+            visit_column(*buffer, [&](auto t) {
+                using T = decltype(t);
+                if constexpr (std::is_integral_v<T>) {
+                    auto data = buffer->data<T>();
+                    for (size_t i = 0; i < num_rows; i++) {
+                        // uint64 values above the int64 range are never
+                        // members, rather than wrapping onto negative ones
+                        if constexpr (std::is_same_v<T, uint64_t>) {
+                            if (data[i] > INT64_RANGE_MAX) {
+                                match[i] = 0;
+                                continue;
+                            }
+                        }
+                        match[i] &= int_set_.count(
+                                        static_cast<int64_t>(data[i])) > 0;
+                    }
+                } else {
+                    throw TileDBSOMAError(fmt::format(
+                        "[ValueFilter] Cannot match integers against "
+                        "non-integral column '{}'",
+                        column_));
+                }
+                return 0;
+            });
+            break;
+        }
+        case Kind::string_set: {
+            auto buffer = batch.at(column_);
+            column_validity(*buffer, num_rows, match);
+            if (auto enumeration = buffer->get_enumeration_info()) {
+                // Look the set up once per label, then match the codes
+                auto labels = enumeration->as_vector<std::string>();
+                std::vector<uint8_t> label_match(labels.size());
+                for (size_t j = 0; j < labels.size(); j++) {
+                    label_match[j] = string_set_.count(labels[j]) > 0;
+                }
+                visit_column(*buffer, [&](auto t) {
+                    using T = decltype(t);
+                    if constexpr (std::is_integral_v<T>) {
+                        auto codes = buffer->data<T>();
+                        for (size_t i = 0; i < num_rows; i++) {
+                            auto code = static_cast<size_t>(codes[i]);
+                            match[i] &= code < label_match.size() &&
+                                        label_match[code];
+                        }
+                    }
+                    return 0;
+                });
+            } else if (buffer->is_var()) {
+                for (size_t i = 0; i < num_rows; i++) {
+                    match[i] &= string_set_.count(buffer->string_view(i)) >
+                                0;
+                }
+            } else {
+                throw TileDBSOMAError(fmt::format(
+                    "[ValueFilter] Cannot match strings against column '{}'",
+                    column_));
+            }
+            break;
+        }
+        case Kind::all_of:
+        case Kind::any_of: {
+            bool all = kind_ == Kind::all_of;
+            match.assign(num_rows, all ? 1 : 0);
+            std::vector<uint8_t> child_match;
+            for (const auto& child : children_) {
+                child->eval(batch, child_match);
+                for (size_t i = 0; i < num_rows; i++) {
+                    match[i] = all ? (match[i] & child_match[i]) :
+                                     (match[i] | child_match[i]);
+                }
+            }
+            break;
+        }
+        case Kind::negate:
+            children_.front()->eval(batch, match);
+            for (size_t i = 0; i < num_rows; i++) {
+                match[i] = !match[i];
+            }
+            break;
+    }
+}
+
+void ValueFilter::add_columns(std::vector<std::string>& names) const {
+    switch (kind_) {
+        case Kind::compare:
+            lhs_->add_columns(names);
+            rhs_->add_columns(names);
+            break;
+        case Kind::int_set:
+        case Kind::string_set:
+            names.push_back(column_);
+            break;
+        case Kind::all_of:
+        case Kind::any_of:
+        case Kind::negate:
+            for (const auto& child : children_) {
+                child->add_columns(names);
+            }
+            break;
+    }
+}
+
+}  // namespace tiledbsoma
@@ -0,0 +1,292 @@
+/**
+ * @file   value_filter.h
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2024 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ *   This declares the ValueExpr and ValueFilter classes, which evaluate
+ *   predicates that TileDB query conditions cannot express over the result
+ *   buffers of a read.
+ */
+
+#ifndef SOMA_VALUE_FILTER_H
+#define SOMA_VALUE_FILTER_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_set>
+#include <variant>
+#include <vector>
+
+#include "enums.h"
+
+namespace tiledbsoma {
+
+class ArrayBuffers;
+
+/**
+ * @brief A numeric expression evaluated for each cell of a batch: a column,
+ * a constant, or arithmetic on two expressions, one node at a time over the
+ * whole batch.
+ *
+ * Integral columns and constants are kept exact: they are evaluated as
+ * int64, or as uint64 for uint64 columns and constants above the int64
+ * range. Operands of different types are combined in the wider type, and in
+ * double as soon as either is floating-point. Integer addition, subtraction
+ * and multiplication wrap around on overflow; division is always computed
+ * in double.
+ */
+class ValueExpr {
+   public:
+    /**
+     * @brief The values of an expression over a batch, one per cell.
+     */
+    using Values = std::variant<
+        std::vector<int64_t>,
+        std::vector<uint64_t>,
+        std::vector<double>>;
+
+    //===================================================================
+    //= public static
+    //===================================================================
+
+    /**
+     * @brief The values of a numeric column. Null cells are null.
+     *
+     * @param name Attribute or dimension name
+     */
+    static std::shared_ptr<ValueExpr> column(const std::string& name);
+
+    /**
+     * @brief A constant.
+     *
+     * @param value Value
+     */
+    static std::shared_ptr<ValueExpr> literal(double value);
+
+    /**
+     * @brief An integral constant, compared exactly with integral columns.
+     *
+     * @param value Value
+     */
+    static std::shared_ptr<ValueExpr> literal(int64_t value);
+
+    /**
+     * @brief An unsigned integral constant, compared exactly with integral
+     * columns.
+     *
+     * @param value Value
+     */
+    static std::shared_ptr<ValueExpr> literal(uint64_t value);
+
+    /**
+     * @brief An integral constant of any other type, such as `int`.
+     *
+     * @param value Value
+     */
+    template <typename T, std::enable_if_t<std::is_integral_v<T>, int> = 0>
+    static std::shared_ptr<ValueExpr> literal(T value) {
+        if constexpr (std::is_signed_v<T>) {
+            return literal(static_cast<int64_t>(value));
+        } else {
+            return literal(static_cast<uint64_t>(value));
+        }
+    }
+
+    /**
+     * @brief An arithmetic operation on two expressions, null where either
+     * operand is null.
+     *
+     * @param op Operation
+     * @param lhs Left operand
+     * @param rhs Right operand
+     */
+    static std::shared_ptr<ValueExpr> arithmetic(
+        ArithmeticOp op,
+        std::shared_ptr<ValueExpr> lhs,
+        std::shared_ptr<ValueExpr> rhs);
+
+    //===================================================================
+    //= public non-static
+    //===================================================================
+
+    /**
+     * @brief Evaluate the expression for each cell of the batch.
+     *
+     * @param batch Result buffers
+     * @param values Set to one value per cell
+     * @param valid Set to one flag per cell, 0 for null values
+     */
+    void eval(
+        ArrayBuffers& batch, Values& values, std::vector<uint8_t>& valid) const;
+
+    /**
+     * @brief Append the names of the columns read by the expression.
+     */
+    void add_columns(std::vector<std::string>& names) const;
+
+   private:
+    enum class Kind { column, literal, arithmetic };
+
+    ValueExpr(Kind kind)
+        : kind_(kind) {
+    }
+
+    Kind kind_;
+
+    // Column name, for Kind::column
+    std::string name_;
+
+    // Constant, for Kind::literal
+    std::variant<int64_t, uint64_t, double> value_;
+
+    // Operation and operands, for Kind::arithmetic
+    ArithmeticOp op_ = ArithmeticOp::add;
+    std::shared_ptr<ValueExpr> lhs_;
+    std::shared_ptr<ValueExpr> rhs_;
+};
+
+/**
+ * @brief A predicate over the cells of a batch, built from comparisons,
+ * set membership and boolean combinations. Cells with a null operand never
+ * match a comparison or a set, so `negate` selects them.
+ *
+ * ManagedQuery applies the filter to each batch it reads and compacts the
+ * rejected cells out of the result buffers before they are returned.
+ */
+class ValueFilter {
+   public:
+    //===================================================================
+    //= public static
+    //===================================================================
+
+    /**
+     * @brief Compare two expressions.
+     *
+     * @param op Comparison
+     * @param lhs Left operand
+     * @param rhs Right operand
+     */
+    static std::shared_ptr<ValueFilter> compare(
+        CompareOp op,
+        std::shared_ptr<ValueExpr> lhs,
+        std::shared_ptr<ValueExpr> rhs);
+
+    /**
+     * @brief Match the cells of an integral column whose value is in a set.
+     *
+     * @param column Attribute or dimension name
+     * @param values Set members
+     */
+    static std::shared_ptr<ValueFilter> in_set(
+        const std::string& column, const std::vector<int64_t>& values);
+
+    /**
+     * @brief Match the cells of a string column, or of a column with a
+     * string enumeration, whose value is in a set.
+     *
+     * @param column Attribute or dimension name
+     * @param values Set members
+     */
+    static std::shared_ptr<ValueFilter> in_set(
+        const std::string& column, const std::vector<std::string>& values);
+
+    /**
+     * @brief Match the cells matched by every filter.
+     */
+    static std::shared_ptr<ValueFilter> all_of(
+        std::vector<std::shared_ptr<ValueFilter>> filters);
+
+    /**
+     * @brief Match the cells matched by any filter.
+     */
+    static std::shared_ptr<ValueFilter> any_of(
+        std::vector<std::shared_ptr<ValueFilter>> filters);
+
+    /**
+     * @brief Match the cells not matched by a filter.
+     */
+    static std::shared_ptr<ValueFilter> negate(
+        std::shared_ptr<ValueFilter> filter);
+
+    //===================================================================
+    //= public non-static
+    //===================================================================
+
+    ValueFilter(const ValueFilter&) = delete;
+    ValueFilter& operator=(const ValueFilter&) = delete;
+
+    /**
+     * @brief Clear the `keep` flag of the cells of the batch that do not
+     * match.
+     *
+     * @param batch Result buffers
+     * @param keep One flag per cell
+     */
+    void apply(ArrayBuffers& batch, std::vector<uint8_t>& keep) const;
+
+    /**
+     * @brief Return the names of the columns read by the filter, which must
+     * be selected in the query.
+     */
+    std::vector<std::string> columns() const;
+
+   private:
+    enum class Kind { compare, int_set, string_set, all_of, any_of, negate };
+
+    ValueFilter(Kind kind)
+        : kind_(kind) {
+    }
+
+    // Set `match` to one flag per cell of the batch
+    void eval(ArrayBuffers& batch, std::vector<uint8_t>& match) const;
+
+    void add_columns(std::vector<std::string>& names) const;
+
+    Kind kind_;
+
+    // Comparison and operands, for Kind::compare
+    CompareOp op_ = CompareOp::eq;
+    std::shared_ptr<ValueExpr> lhs_;
+    std::shared_ptr<ValueExpr> rhs_;
+
+    // Column and set members, for Kind::int_set and Kind::string_set. The
+    // string set views the strings owned by `strings_`.
+    std::string column_;
+    std::unordered_set<int64_t> int_set_;
+    std::vector<std::string> strings_;
+    std::unordered_set<std::string_view> string_set_;
+
+    // Operands, for Kind::all_of, Kind::any_of and Kind::negate
+    std::vector<std::shared_ptr<ValueFilter>> children_;
+};
+
+}  // namespace tiledbsoma
+
+#endif  // SOMA_VALUE_FILTER_H
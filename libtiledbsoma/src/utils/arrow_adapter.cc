@@ -31,8 +31,13 @@
  */
 
 #include "arrow_adapter.h"
+#include <cstring>
+#include <limits>
+#include "../soma/array_buffers.h"
 #include "../soma/column_buffer.h"
 #include "logger.h"
+#include "stats.h"
+#include "util.h"
 
 namespace tiledbsoma {
 
@@ -132,12 +137,10 @@ void ArrowAdapter::release_array(struct ArrowArray* array) {
     }
 
     if (array->dictionary != nullptr) {
-        // TODO: This can lead to segfault on some data sets, could be caused
-        //       by how we fill arrow data structures.  This should pass.
-        // if (array->dictionary->release != nullptr) {
-        //    LOG_TRACE("[ArrowAdapter] release_array array->dict release");
-        //    release_array(array->dictionary);
-        //}
+        if (array->dictionary->release != nullptr) {
+            LOG_TRACE("[ArrowAdapter] release_array array->dict release");
+            array->dictionary->release(array->dictionary);
+        }
         LOG_TRACE("[ArrowAdapter] release_array array->dict free");
         free(array->dictionary);
         array->dictionary = nullptr;
@@ -147,6 +150,85 @@ void ArrowAdapter::release_array(struct ArrowArray* array) {
     LOG_TRACE(fmt::format("[ArrowAdapter] release_array done"));
 }
 
+void ArrowAdapter::release_dictionary(struct ArrowArray* array) {
+    // Drop this array's reference to the shared dictionary, which is deleted
+    // with the last one
+    delete static_cast<std::shared_ptr<ArrowDictionary>*>(array->private_data);
+    array->private_data = nullptr;
+
+    if (array->buffers != nullptr) {
+        free(array->buffers);
+        array->buffers = nullptr;
+    }
+
+    array->release = nullptr;
+    LOG_TRACE("[ArrowAdapter] release_dictionary done");
+}
+
+ArrowTable ArrowAdapter::to_arrow(std::shared_ptr<ArrayBuffers> buffers) {
+    // The schema is derived first, from the buffers as read
+    auto schema = to_arrow_schema(buffers);
+    auto array = to_arrow_array(buffers);
+    return {std::move(array), std::move(schema)};
+}
+
+std::unique_ptr<ArrowSchema> ArrowAdapter::to_arrow_schema(
+    std::shared_ptr<ArrayBuffers> buffers) {
+    auto names = buffers->names();
+    auto num_columns = static_cast<int64_t>(names.size());
+
+    std::unique_ptr<ArrowSchema> schema = std::make_unique<ArrowSchema>();
+    schema->format = strdup("+s");
+    schema->name = nullptr;
+    schema->metadata = nullptr;
+    schema->flags = 0;
+    schema->n_children = num_columns;
+    schema->children = (ArrowSchema**)malloc(
+        num_columns * sizeof(ArrowSchema*));
+    schema->dictionary = nullptr;
+    schema->release = &ArrowAdapter::release_schema;
+    schema->private_data = nullptr;
+
+    // Move each column into a child allocated with malloc, which the
+    // release callback frees
+    for (int64_t i = 0; i < num_columns; i++) {
+        auto child = to_arrow_schema(buffers->at(names[i]));
+        schema->children[i] = (ArrowSchema*)malloc(sizeof(ArrowSchema));
+        ArrowSchemaMove(child.get(), schema->children[i]);
+    }
+
+    return schema;
+}
+
+std::unique_ptr<ArrowArray> ArrowAdapter::to_arrow_array(
+    std::shared_ptr<ArrayBuffers> buffers) {
+    auto names = buffers->names();
+    auto num_columns = static_cast<int64_t>(names.size());
+
+    std::unique_ptr<ArrowArray> array = std::make_unique<ArrowArray>();
+    array->length = names.empty() ? 0 : buffers->num_rows();
+    array->null_count = 0;
+    array->offset = 0;
+    array->n_buffers = 1;
+    array->buffers = (const void**)malloc(sizeof(void*));
+    array->buffers[0] = nullptr;  // no struct-level nulls
+    array->n_children = num_columns;
+    array->children = (ArrowArray**)malloc(num_columns * sizeof(ArrowArray*));
+    array->dictionary = nullptr;
+    array->release = &ArrowAdapter::release_array;
+    array->private_data = nullptr;
+
+    // Move each column into a child allocated with malloc, which the
+    // release callback frees
+    for (int64_t i = 0; i < num_columns; i++) {
+        auto child = to_arrow_array(buffers->at(names[i]));
+        array->children[i] = (ArrowArray*)malloc(sizeof(ArrowArray));
+        ArrowArrayMove(child.get(), array->children[i]);
+    }
+
+    return array;
+}
+
 std::unique_ptr<ArrowSchema> ArrowAdapter::arrow_schema_from_tiledb_array(
     std::shared_ptr<Context> ctx, std::shared_ptr<Array> tiledb_array) {
     auto tiledb_schema = tiledb_array->schema();
@@ -185,6 +267,7 @@ std::unique_ptr<ArrowSchema> ArrowAdapter::arrow_schema_from_tiledb_array(
             ArrowAdapter::to_arrow_format(attr.type()).data());
         child->name = strdup(attr.name().c_str());
         child->metadata = nullptr;
+        child->flags = 0;
         if (attr.nullable()) {
             child->flags |= ARROW_FLAG_NULLABLE;
         } else {
@@ -211,6 +294,7 @@ std::unique_ptr<ArrowSchema> ArrowAdapter::arrow_schema_from_tiledb_array(
             }
             dict->name = strdup(enmr.name().c_str());
             dict->metadata = nullptr;
+            dict->flags = 0;
             if (enmr.ordered()) {
                 child->flags |= ARROW_FLAG_DICTIONARY_ORDERED;
             } else {
@@ -897,81 +981,73 @@ ArraySchema ArrowAdapter::tiledb_schema_from_arrow_schema(
     return schema;
 }
 
-std::pair<const void*, std::size_t> ArrowAdapter::_get_data_and_length(
-    Enumeration& enmr, const void* dst) {
-    switch (enmr.type()) {
-        case TILEDB_BOOL: {
-            // We must handle this specially because vector<bool> does
-            // not store elements contiguously in memory
-            auto data = enmr.as_vector<bool>();
-
-            // Represent the Boolean vector with, at most, the last two
-            // bits. In Arrow, Boolean values are LSB packed
-            uint8_t src = 0;
-            for (size_t i = 0; i < data.size(); ++i)
-                src |= (data[i] << i);
-
-            // Allocate a single byte to copy the bits into
-            size_t sz = 1;
-            dst = malloc(sz);
-            std::memcpy((void*)dst, &src, sz);
-
-            return std::pair(dst, data.size());
-        }
-        case TILEDB_INT8: {
-            auto data = enmr.as_vector<int8_t>();
-            return std::pair(_fill_data_buffer(data, dst), data.size());
-        }
-        case TILEDB_UINT8: {
-            auto data = enmr.as_vector<uint8_t>();
-            return std::pair(
-                ArrowAdapter::_fill_data_buffer(data, dst), data.size());
-        }
-        case TILEDB_INT16: {
-            auto data = enmr.as_vector<int16_t>();
-            return std::pair(
-                ArrowAdapter::_fill_data_buffer(data, dst), data.size());
-        }
-        case TILEDB_UINT16: {
-            auto data = enmr.as_vector<uint16_t>();
-            return std::pair(
-                ArrowAdapter::_fill_data_buffer(data, dst), data.size());
-        }
-        case TILEDB_INT32: {
-            auto data = enmr.as_vector<int32_t>();
-            return std::pair(
-                ArrowAdapter::_fill_data_buffer(data, dst), data.size());
-        }
-        case TILEDB_UINT32: {
-            auto data = enmr.as_vector<uint32_t>();
-            return std::pair(
-                ArrowAdapter::_fill_data_buffer(data, dst), data.size());
-        }
-        case TILEDB_INT64: {
-            auto data = enmr.as_vector<int64_t>();
-            return std::pair(
-                ArrowAdapter::_fill_data_buffer(data, dst), data.size());
-        }
-        case TILEDB_UINT64: {
-            auto data = enmr.as_vector<uint64_t>();
-            return std::pair(
-                ArrowAdapter::_fill_data_buffer(data, dst), data.size());
+std::shared_ptr<ArrowDictionary> ArrowAdapter::to_dictionary(
+    Enumeration& enumeration) {
+    auto dictionary = std::make_shared<ArrowDictionary>();
+    dictionary->format_ = to_arrow_format(enumeration.type(), false);
+
+    switch (enumeration.type()) {
+        case TILEDB_STRING_ASCII:
+        case TILEDB_STRING_UTF8:
+        case TILEDB_CHAR: {
+            auto values = enumeration.as_vector<std::string>();
+            dictionary->length_ = values.size();
+            dictionary->offsets_.reserve(values.size() + 1);
+            dictionary->offsets_.push_back(0);
+            for (const auto& value : values) {
+                auto data = reinterpret_cast<const std::byte*>(value.data());
+                dictionary->data_.insert(
+                    dictionary->data_.end(), data, data + value.size());
+                if (dictionary->data_.size() >
+                    (size_t)std::numeric_limits<int32_t>::max()) {
+                    throw TileDBSOMAError(
+                        "ArrowAdapter: Enumeration values exceed 32-bit "
+                        "offsets");
+                }
+                dictionary->offsets_.push_back(dictionary->data_.size());
+            }
+            break;
         }
-        case TILEDB_FLOAT32: {
-            auto data = enmr.as_vector<float>();
-            return std::pair(
-                ArrowAdapter::_fill_data_buffer(data, dst), data.size());
+        case TILEDB_BOOL: {
+            // vector<bool> does not store elements contiguously in memory,
+            // so the values are packed bit by bit, LSB first as in Arrow
+            auto values = enumeration.as_vector<bool>();
+            dictionary->length_ = values.size();
+            dictionary->data_.assign((values.size() + 7) / 8, std::byte{0});
+            for (size_t i = 0; i < values.size(); i++) {
+                if (values[i]) {
+                    dictionary->data_[i / 8] |= std::byte(1 << (i % 8));
+                }
+            }
+            break;
         }
+        case TILEDB_INT8:
+        case TILEDB_UINT8:
+        case TILEDB_INT16:
+        case TILEDB_UINT16:
+        case TILEDB_INT32:
+        case TILEDB_UINT32:
+        case TILEDB_INT64:
+        case TILEDB_UINT64:
+        case TILEDB_FLOAT32:
         case TILEDB_FLOAT64: {
-            auto data = enmr.as_vector<double>();
-            return std::pair(
-                ArrowAdapter::_fill_data_buffer(data, dst), data.size());
+            util::visit_numeric_type(enumeration.type(), [&](auto tag) {
+                using T = decltype(tag);
+                auto values = enumeration.as_vector<T>();
+                auto data = reinterpret_cast<const std::byte*>(values.data());
+                dictionary->length_ = values.size();
+                dictionary->data_.assign(
+                    data, data + values.size() * sizeof(T));
+            });
+            break;
         }
         default:
             throw TileDBSOMAError(fmt::format(
                 "ArrowAdapter: Unsupported TileDB dict datatype: {} ",
-                tiledb::impl::type_to_str(enmr.type())));
+                tiledb::impl::type_to_str(enumeration.type())));
     }
+
+    return dictionary;
 }
 
 inline void exitIfError(const ArrowErrorCode ec, const std::string& msg) {
@@ -980,26 +1056,166 @@ inline void exitIfError(const ArrowErrorCode ec, const std::string& msg) {
             fmt::format("ArrowAdapter: Arrow Error {} ", msg));
 }
 
+// Build the Arrow binary views of the cells of a var-sized column into
+// `views`: the length, then the value itself if it has at most 12 bytes,
+// else its first 4 bytes, data buffer 0 and its offset in the buffer
+inline void make_string_views(
+    ColumnBuffer& column,
+    const uint64_t* offsets,
+    std::vector<std::byte>& views) {
+    constexpr size_t view_size = 16;
+    constexpr size_t max_inline = 12;
+    const std::byte* data = column.data<std::byte>().data();
+    views.assign(column.size() * view_size, std::byte{0});
+    for (size_t i = 0; i < column.size(); i++) {
+        std::byte* view = views.data() + i * view_size;
+        auto offset = static_cast<int32_t>(offsets[i]);
+        auto length = static_cast<int32_t>(offsets[i + 1] - offsets[i]);
+        std::memcpy(view, &length, sizeof(int32_t));
+        if ((size_t)length <= max_inline) {
+            std::memcpy(view + 4, data + offset, length);
+        } else {
+            int32_t buffer_index = 0;
+            std::memcpy(view + 4, data + offset, 4);
+            std::memcpy(view + 8, &buffer_index, sizeof(int32_t));
+            std::memcpy(view + 12, &offset, sizeof(int32_t));
+        }
+    }
+}
+
+// Return the format nanoarrow sets for the storage type of a TileDB type,
+// or the timestamp format for timestamps in seconds, milli- or nanoseconds
+inline std::string storage_format(tiledb_datatype_t type, bool use_large) {
+    auto format = ArrowAdapter::to_arrow_format(type, use_large);
+    if (type == TILEDB_DATETIME_SEC || type == TILEDB_DATETIME_MS ||
+        type == TILEDB_DATETIME_NS) {
+        return std::string(format);
+    }
+    ArrowSchema schema;
+    exitIfError(
+        ArrowSchemaInitFromType(
+            &schema, ArrowAdapter::to_nanoarrow_type(format)),
+        "Bad schema init");
+    std::string storage(schema.format);
+    schema.release(&schema);
+    return storage;
+}
+
+void ArrowAdapter::_derive_export_plan(
+    const ColumnBuffer& column, ArrowExportPlan& plan) {
+    plan.format_ = storage_format(column.type(), true);
+    plan.compact_format_ = storage_format(column.type(), false);
+    plan.view_format_ = plan.compact_format_ == "u" ? "vu" : "vz";
+
+    if (column.is_nullable()) {
+        plan.flags_ |= ARROW_FLAG_NULLABLE;
+    }
+    if (column.is_ordered()) {
+        plan.flags_ |= ARROW_FLAG_DICTIONARY_ORDERED;
+    }
+
+    if (auto enumeration = column.get_enumeration_info()) {
+        plan.dictionary_ = to_dictionary(*enumeration);
+    }
+}
+
+std::shared_ptr<ArrowExportPlan> ArrowAdapter::_export_plan(
+    ColumnBuffer& column) {
+    // Buffers read by a ManagedQuery share the plan of their column, derived
+    // on the first export; others get their own, kept for later exports
+    auto plan = column.export_plan();
+    if (plan == nullptr) {
+        plan = std::make_shared<ArrowExportPlan>();
+        column.set_export_plan(plan);
+    }
+    std::call_once(
+        plan->derived_, [&]() { _derive_export_plan(column, *plan); });
+    return plan;
+}
+
+// Strings keep 64-bit offsets unless another layout was selected and the
+// data fits 32-bit offsets
+inline StringLayout export_layout(ColumnBuffer& column) {
+    if (column.is_var() &&
+        column.offsets().data()[column.size()] <= column.max_narrow_bytes()) {
+        return column.string_layout();
+    }
+    return StringLayout::large;
+}
+
+inline const std::string& layout_format(
+    const ArrowExportPlan& plan, StringLayout layout) {
+    return layout == StringLayout::large   ? plan.format_ :
+           layout == StringLayout::compact ? plan.compact_format_ :
+                                             plan.view_format_;
+}
+
+std::string_view ArrowAdapter::export_format(
+    std::shared_ptr<ColumnBuffer> column) {
+    auto plan = _export_plan(*column);
+    return layout_format(*plan, export_layout(*column));
+}
+
 std::pair<std::unique_ptr<ArrowArray>, std::unique_ptr<ArrowSchema>>
 ArrowAdapter::to_arrow(std::shared_ptr<ColumnBuffer> column) {
-    std::unique_ptr<ArrowSchema> schema = std::make_unique<ArrowSchema>();
-    std::unique_ptr<ArrowArray> array = std::make_unique<ArrowArray>();
-    auto sch = schema.get();
-    auto arr = array.get();
+    // The schema is derived first, from the buffers as read
+    auto schema = to_arrow_schema(column);
+    auto array = to_arrow_array(column);
+    return std::pair(std::move(array), std::move(schema));
+}
 
-    auto coltype = to_arrow_format(column->type()).data();
-    auto natype = to_nanoarrow_type(coltype);
-    exitIfError(ArrowSchemaInitFromType(sch, natype), "Bad schema init");
-    exitIfError(
-        ArrowSchemaSetName(sch, column->name().data()), "Bad schema name");
-    exitIfError(
-        ArrowSchemaAllocateChildren(sch, 0), "Bad schema children alloc");
-    // After allocating and initializing via nanoarrow we
-    // hook our custom release function in
+std::unique_ptr<ArrowSchema> ArrowAdapter::to_arrow_schema(
+    std::shared_ptr<ColumnBuffer> column) {
+    auto plan = _export_plan(*column);
+    auto& format = layout_format(*plan, export_layout(*column));
+
+    std::unique_ptr<ArrowSchema> schema = std::make_unique<ArrowSchema>();
+    schema->format = strdup(format.c_str());
+    schema->name = strdup(column->name().data());
+    schema->metadata = nullptr;
+    schema->flags = plan->flags_;
+    schema->n_children = 0;
+    schema->children = nullptr;
+    schema->dictionary = nullptr;
     schema->release = &release_schema;
+    schema->private_data = nullptr;
+
+    // Workaround for date
+    if (column->type() == TILEDB_DATETIME_DAY) {
+        free((void*)schema->format);  // free the 'storage' format
+        schema->format = strdup(to_arrow_format(column->type()).data());
+    }
+
+    if (auto& dictionary = plan->dictionary_) {
+        auto dict_sch = (ArrowSchema*)malloc(sizeof(ArrowSchema));
+        dict_sch->format = strdup(dictionary->format_.c_str());
+        dict_sch->name = strdup("");
+        dict_sch->metadata = nullptr;
+        dict_sch->flags = ARROW_FLAG_NULLABLE;
+        dict_sch->n_children = 0;
+        dict_sch->children = nullptr;
+        dict_sch->dictionary = nullptr;
+        dict_sch->release = &release_schema;
+        dict_sch->private_data = nullptr;
+        schema->dictionary = dict_sch;
+    }
 
-    // this will be 3 for char vecs and 2 for enumerations
-    int n_buffers = column->is_var() ? 3 : 2;
+    return schema;
+}
+
+std::unique_ptr<ArrowArray> ArrowAdapter::to_arrow_array(
+    std::shared_ptr<ColumnBuffer> column) {
+    stats::ScopedTimer timer("soma.arrow_adapter.to_arrow");
+    auto plan = _export_plan(*column);
+    auto layout = export_layout(*column);
+
+    std::unique_ptr<ArrowArray> array = std::make_unique<ArrowArray>();
+
+    // this will be 3 for char vecs, 4 for string views (validity, views,
+    // data and data sizes) and 2 for enumerations
+    int n_buffers = layout == StringLayout::view ? 4 :
+                    column->is_var()             ? 3 :
+                                                   2;
 
     // Create an ArrowBuffer to manage the lifetime of `column`.
     // - `arrow_buffer` holds shared_ptr to `column`, increments
@@ -1011,26 +1227,24 @@ ArrowAdapter::to_arrow(std::shared_ptr<ColumnBuffer> column) {
     //   0, the ColumnBuffer data will be deleted.
     auto arrow_buffer = new ArrowBuffer(column);
 
-    exitIfError(ArrowArrayInitFromType(arr, natype), "Bad array init");
-    exitIfError(ArrowArrayAllocateChildren(arr, 0), "Bad array children alloc");
     array->length = column->size();
+    array->null_count = 0;
+    array->offset = 0;
+    array->n_buffers = n_buffers;
+    array->n_children = 0;
+    array->children = nullptr;
+    array->dictionary = nullptr;
+    array->release = &release_array;
+    array->private_data = (void*)arrow_buffer;
 
     LOG_TRACE(fmt::format(
         "[ArrowAdapter] column type {} name {} nbuf {} {} nullable {}",
-        to_arrow_format(column->type()).data(),
+        layout_format(*plan, layout),
         column->name().data(),
         n_buffers,
         array->n_buffers,
         column->is_nullable()));
 
-    // After allocating and initializing via nanoarrow we
-    // hook our custom release function in
-    array->release = &release_array;
-    if (array->private_data != nullptr) {  // as we use nanoarrow's init
-        free(array->private_data);         // free what was allocated before
-    }                                      // assigning our ArrowBuffer pointer
-    array->private_data = (void*)arrow_buffer;
-
     LOG_TRACE(fmt::format(
         "[ArrowAdapter] create array name='{}' use_count={}",
         column->name(),
@@ -1039,14 +1253,23 @@ ArrowAdapter::to_arrow(std::shared_ptr<ColumnBuffer> column) {
     array->buffers = (const void**)malloc(sizeof(void*) * n_buffers);
     assert(array->buffers != nullptr);
     array->buffers[0] = nullptr;  // validity addressed below
-    array->buffers[n_buffers - 1] = column->data<void*>().data();  // data
-    if (n_buffers == 3) {
-        array->buffers[1] = column->offsets().data();  // offsets
+    if (layout == StringLayout::view) {
+        auto offsets = column->offsets().data();
+        make_string_views(*column, offsets, arrow_buffer->views_);
+        arrow_buffer->view_data_size_ = offsets[column->size()];
+        array->buffers[1] = arrow_buffer->views_.data();     // views
+        array->buffers[2] = column->data<void*>().data();    // data
+        array->buffers[3] = &arrow_buffer->view_data_size_;  // data sizes
+    } else {
+        array->buffers[n_buffers - 1] = column->data<void*>().data();  // data
+        if (layout == StringLayout::compact) {
+            array->buffers[1] = column->offsets_to_uint32();  // offsets
+        } else if (n_buffers == 3) {
+            array->buffers[1] = column->offsets().data();  // offsets
+        }
     }
 
     if (column->is_nullable()) {
-        schema->flags |= ARROW_FLAG_NULLABLE;  // it is also set by default
-
         // Count nulls
         for (size_t i = 0; i < column->size(); ++i) {
             array->null_count += column->validity()[i] == 0;
@@ -1055,13 +1278,6 @@ ArrowAdapter::to_arrow(std::shared_ptr<ColumnBuffer> column) {
         // Convert validity bytemap to a bitmap in place
         column->validity_to_bitmap();
         array->buffers[0] = column->validity().data();
-    } else {
-        schema->flags &= ~ARROW_FLAG_NULLABLE;  // as ArrowSchemaInitFromType
-                                                // leads to NULLABLE set
-    }
-
-    if (column->is_ordered()) {
-        schema->flags |= ARROW_FLAG_DICTIONARY_ORDERED;
     }
 
     // Workaround to cast TILEDB_BOOL from uint8 to 1-bit Arrow boolean
@@ -1069,18 +1285,8 @@ ArrowAdapter::to_arrow(std::shared_ptr<ColumnBuffer> column) {
         column->data_to_bitmap();
     }
 
-    // Workaround for datetime
-    if (column->type() == TILEDB_DATETIME_SEC ||
-        column->type() == TILEDB_DATETIME_MS ||
-        column->type() == TILEDB_DATETIME_NS) {
-        free((void*)schema->format);  // free the 'storage' format
-        schema->format = strdup(to_arrow_format(column->type()).data());
-    }
-
     // Workaround for date
     if (column->type() == TILEDB_DATETIME_DAY) {
-        free((void*)schema->format);  // free the 'storage' format
-        schema->format = strdup(to_arrow_format(column->type()).data());
         // TODO: Put in ColumnBuffer
         size_t n = array->length;
         std::vector<int64_t> indata(n);
@@ -1096,58 +1302,32 @@ ArrowAdapter::to_arrow(std::shared_ptr<ColumnBuffer> column) {
             sizeof(int32_t) * n);
     }
 
-    if (column->has_enumeration()) {
-        auto dict_sch = (ArrowSchema*)malloc(sizeof(ArrowSchema));
+    if (auto& dictionary = plan->dictionary_) {
+        // The dictionary array points into the shared buffers, and holds a
+        // reference to them until it is released
         auto dict_arr = (ArrowArray*)malloc(sizeof(ArrowArray));
-
-        auto enmr = column->get_enumeration_info();
-        auto dcoltype = to_arrow_format(enmr->type(), false).data();
-        auto dnatype = to_nanoarrow_type(dcoltype);
-
-        exitIfError(
-            ArrowSchemaInitFromType(dict_sch, dnatype), "Bad schema init");
-        exitIfError(ArrowSchemaSetName(dict_sch, ""), "Bad schema name");
-        exitIfError(
-            ArrowSchemaAllocateChildren(dict_sch, 0),
-            "Bad schema children alloc");
-        dict_sch->release = &release_schema;
-
-        exitIfError(
-            ArrowArrayInitFromType(dict_arr, dnatype), "Bad array init");
-        exitIfError(
-            ArrowArrayAllocateChildren(dict_arr, 0),
-            "Bad array children alloc");
-        // hook up our custom release function
-        dict_arr->release = &release_array;
-
-        // TODO string types currently get the data and offset
-        // buffers from ColumnBuffer::enum_offsets and
-        // ColumnBuffer::enum_string which is retrieved via
-        // ColumnBuffer::convert_enumeration. This may be refactored
-        // to all use ColumnBuffer::get_enumeration_info. Note that
-        // ColumnBuffer::has_enumeration may also be removed in a
-        // future refactor as ColumnBuffer::get_enumeration_info
-        // returns std::optional where std::nullopt indicates the
-        // column does not contain enumerated values.
-        if (enmr->type() == TILEDB_STRING_ASCII ||
-            enmr->type() == TILEDB_STRING_UTF8 || enmr->type() == TILEDB_CHAR) {
-            auto dict_vec = enmr->as_vector<std::string>();
-            column->convert_enumeration();
-            dict_arr->buffers[1] = column->enum_offsets().data();
-            dict_arr->buffers[2] = column->enum_string().data();
-            dict_arr->length = dict_vec.size();
-        } else {
-            auto [dict_data, dict_length] = _get_data_and_length(
-                *enmr, dict_arr->buffers[1]);
-            dict_arr->buffers[1] = dict_data;
-            dict_arr->length = dict_length;
+        int dict_n_buffers = dictionary->offsets_.empty() ? 2 : 3;
+        dict_arr->length = dictionary->length_;
+        dict_arr->null_count = 0;
+        dict_arr->offset = 0;
+        dict_arr->n_buffers = dict_n_buffers;
+        dict_arr->buffers = (const void**)malloc(
+            sizeof(void*) * dict_n_buffers);
+        dict_arr->buffers[0] = nullptr;  // no nulls
+        if (dict_n_buffers == 3) {
+            dict_arr->buffers[1] = dictionary->offsets_.data();
         }
-
-        schema->dictionary = dict_sch;
+        dict_arr->buffers[dict_n_buffers - 1] = dictionary->data_.data();
+        dict_arr->n_children = 0;
+        dict_arr->children = nullptr;
+        dict_arr->dictionary = nullptr;
+        dict_arr->release = &release_dictionary;
+        dict_arr->private_data = new std::shared_ptr<ArrowDictionary>(
+            dictionary);
         array->dictionary = dict_arr;
     }
 
-    return std::pair(std::move(array), std::move(schema));
+    return array;
 }
 
 bool ArrowAdapter::_isvar(const char* format) {
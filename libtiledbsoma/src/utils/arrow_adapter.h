@@ -1,6 +1,7 @@
 #ifndef ARROW_ADAPTER_H
 #define ARROW_ADAPTER_H
 
+#include <mutex>
 #include <tiledb/tiledb>
 #include <tiledb/tiledb_experimental>
 
@@ -16,6 +17,7 @@ namespace tiledbsoma {
 using namespace tiledb;
 using json = nlohmann::json;
 
+class ArrayBuffers;
 class ColumnBuffer;
 
 /**
@@ -31,6 +33,58 @@ struct ArrowBuffer {
         : buffer_(buffer){};
 
     std::shared_ptr<ColumnBuffer> buffer_;
+
+    // For a column exported as string views: the views, 16 bytes per cell,
+    // and the size of the data buffer they point into
+    std::vector<std::byte> views_;
+    int64_t view_data_size_ = 0;
+};
+
+/**
+ * @brief The ArrowDictionary holds the values of an enumeration laid out as
+ * the buffers of an Arrow dictionary array. It is built once per open array
+ * and shared by the dictionary arrays of every exported batch, so the batches
+ * of a column reference identical dictionaries.
+ *
+ * Each dictionary ArrowArray holds a shared pointer to it in private_data,
+ * which the ArrowArray.release callback deletes.
+ */
+struct ArrowDictionary {
+    // Arrow format of the values
+    std::string format_;
+
+    // Number of values
+    int64_t length_ = 0;
+
+    // Values: bit-packed for booleans, else fixed-size values or the
+    // concatenated strings
+    std::vector<std::byte> data_;
+
+    // Offsets of the strings into data_, empty for fixed-size values
+    std::vector<int32_t> offsets_;
+};
+
+/**
+ * @brief The ArrowExportPlan holds what ArrowAdapter::to_arrow derives from
+ * the TileDB type of a column: its Arrow formats, schema flags and
+ * dictionary. The columns of an open array each share one plan across
+ * batches, derived on the first export.
+ */
+struct ArrowExportPlan {
+    // Set once the plan is derived
+    std::once_flag derived_;
+
+    // Arrow format with 64-bit string offsets, and with 32-bit offsets or as
+    // string views for var-sized columns
+    std::string format_;
+    std::string compact_format_;
+    std::string view_format_;
+
+    // Schema flags
+    int64_t flags_ = 0;
+
+    // Dictionary of the enumeration, or nullptr
+    std::shared_ptr<ArrowDictionary> dictionary_;
 };
 
 using ArrowTable =
@@ -168,6 +222,7 @@ class ArrowAdapter {
    public:
     static void release_schema(struct ArrowSchema* schema);
     static void release_array(struct ArrowArray* array);
+    static void release_dictionary(struct ArrowArray* array);
 
     static bool _isstr(const char* format);
 
@@ -180,6 +235,75 @@ class ArrowAdapter {
     static std::pair<std::unique_ptr<ArrowArray>, std::unique_ptr<ArrowSchema>>
     to_arrow(std::shared_ptr<ColumnBuffer> column);
 
+    /**
+     * @brief Convert ArrayBuffers to an Arrow struct array, i.e. a record
+     * batch, with one child per column. Like the single column conversion,
+     * the children reference the ColumnBuffer data without copying it.
+     *
+     * @return ArrowTable
+     */
+    static ArrowTable to_arrow(std::shared_ptr<ArrayBuffers> buffers);
+
+    /**
+     * @brief Convert the ColumnBuffer's type to an Arrow schema, without
+     * exporting its data. Since the string layout depends on the size of the
+     * data, the schema describes the column's buffers as they are before
+     * `to_arrow_array`.
+     *
+     * @return std::unique_ptr<ArrowSchema>
+     */
+    static std::unique_ptr<ArrowSchema> to_arrow_schema(
+        std::shared_ptr<ColumnBuffer> column);
+
+    /**
+     * @brief Convert ArrayBuffers to the schema of the struct array
+     * `to_arrow` returns, with one child per column.
+     *
+     * @return std::unique_ptr<ArrowSchema>
+     */
+    static std::unique_ptr<ArrowSchema> to_arrow_schema(
+        std::shared_ptr<ArrayBuffers> buffers);
+
+    /**
+     * @brief Convert ColumnBuffer to an Arrow array, without its schema,
+     * for callers that reuse the schema of an earlier batch. The validity,
+     * Boolean and 32-bit offset buffers are converted in place, so a
+     * ColumnBuffer is exported once.
+     *
+     * @return std::unique_ptr<ArrowArray>
+     */
+    static std::unique_ptr<ArrowArray> to_arrow_array(
+        std::shared_ptr<ColumnBuffer> column);
+
+    /**
+     * @brief Convert ArrayBuffers to an Arrow struct array, without its
+     * schema, with one child per column.
+     *
+     * @return std::unique_ptr<ArrowArray>
+     */
+    static std::unique_ptr<ArrowArray> to_arrow_array(
+        std::shared_ptr<ArrayBuffers> buffers);
+
+    /**
+     * @brief Get the Arrow format the ColumnBuffer is exported with, which
+     * depends on the string layout its data fits.
+     *
+     * @param column Column buffer, not yet exported
+     * @return std::string_view Arrow format string, valid while the column
+     * is alive
+     */
+    static std::string_view export_format(std::shared_ptr<ColumnBuffer> column);
+
+    /**
+     * @brief Build the Arrow dictionary of an enumeration. String values get
+     * 32-bit offsets and Boolean values are bit-packed.
+     *
+     * @param enumeration TileDB enumeration
+     * @return std::shared_ptr<ArrowDictionary>
+     */
+    static std::shared_ptr<ArrowDictionary> to_dictionary(
+        Enumeration& enumeration);
+
     /**
      * @brief Create a an ArrowSchema from TileDB Schema
      *
@@ -230,16 +354,10 @@ class ArrowAdapter {
     static enum ArrowType to_nanoarrow_type(std::string_view sv);
 
    private:
-    static std::pair<const void*, std::size_t> _get_data_and_length(
-        Enumeration& enmr, const void* dst);
+    static void _derive_export_plan(
+        const ColumnBuffer& column, ArrowExportPlan& plan);
 
-    template <typename T>
-    static const void* _fill_data_buffer(std::vector<T> src, const void* dst) {
-        auto sz = src.size() * sizeof(T);
-        dst = (const void*)malloc(sz);
-        std::memcpy((void*)dst, src.data(), sz);
-        return dst;
-    }
+    static std::shared_ptr<ArrowExportPlan> _export_plan(ColumnBuffer& column);
 
     static Dimension _create_dim(
         tiledb_datatype_t type,
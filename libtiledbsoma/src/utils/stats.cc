@@ -28,30 +28,167 @@
  * @section DESCRIPTION
  *
  * This file provides access to stats from libtiledbsoma's dependency on
- * TileDB Embedded.
+ * TileDB Embedded, and collects libtiledbsoma's own counters and timers.
  */
 
 #include "utils/stats.h"
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <vector>
 #include <tiledb/tiledb>
 
 namespace tiledbsoma::stats {
 
+namespace {
+
+struct Timer {
+    double sum = 0;
+    uint64_t count = 0;
+};
+
+std::atomic<bool> enabled{false};
+std::mutex mutex;
+std::map<std::string, uint64_t, std::less<>> counters;
+std::map<std::string, Timer, std::less<>> timers;
+
+// The atomic counters and timers, registered once and never removed
+std::vector<AtomicCounter*> atomic_counters;
+std::vector<AtomicTimer*> atomic_timers;
+
+// Format libtiledbsoma stats like one entry of the TileDB stats dump
+std::string dump_soma() {
+    const std::lock_guard<std::mutex> lock(mutex);
+
+    // Fold the atomic counters and timers into copies of the others
+    auto all_counters = counters;
+    auto all_timers = timers;
+    for (auto counter : atomic_counters) {
+        if (auto value = counter->value()) {
+            all_counters[counter->name()] += value;
+        }
+    }
+    for (auto timer : atomic_timers) {
+        if (auto count = timer->count()) {
+            auto& entry = all_timers[timer->name()];
+            entry.sum += timer->seconds();
+            entry.count += count;
+        }
+    }
+
+    std::ostringstream out;
+    out << "  {\n    \"timers\": {";
+    bool first = true;
+    for (auto& [name, timer] : all_timers) {
+        out << (first ? "\n" : ",\n");
+        out << "      \"" << name << ".sum\": " << timer.sum << ",\n";
+        out << "      \"" << name
+            << ".avg\": " << (timer.count ? timer.sum / timer.count : 0);
+        first = false;
+    }
+    out << (first ? "" : "\n    ") << "},\n    \"counters\": {";
+    first = true;
+    for (auto& [name, value] : all_counters) {
+        out << (first ? "\n" : ",\n");
+        out << "      \"" << name << "\": " << value;
+        first = false;
+    }
+    out << (first ? "" : "\n    ") << "}\n  }";
+    return out.str();
+}
+
+}  // namespace
+
 void enable() {
     tiledb::Stats::enable();
+    enabled = true;
 }
 
 void disable() {
     tiledb::Stats::disable();
+    enabled = false;
 }
 
 void reset() {
     tiledb::Stats::reset();
+    const std::lock_guard<std::mutex> lock(mutex);
+    counters.clear();
+    timers.clear();
+    for (auto counter : atomic_counters) {
+        counter->reset();
+    }
+    for (auto timer : atomic_timers) {
+        timer->reset();
+    }
 }
 
 std::string dump() {
     std::string stats;
     tiledb::Stats::raw_dump(&stats);
+
+    // The TileDB dump is a JSON array of stats entries: add ours as the last
+    // entry of the array.
+    auto soma = dump_soma();
+    auto close = stats.rfind(']');
+    if (close == std::string::npos) {
+        return "[\n" + soma + "\n]\n";
+    }
+    auto open = stats.find('[');
+    bool empty = stats.find('{', open) == std::string::npos;
+    auto last = stats.find_last_not_of(" \n\t", close - 1);
+    stats.replace(
+        last + 1, close - last - 1, (empty ? "\n" : ",\n") + soma + "\n");
     return stats;
 }
 
+bool is_enabled() {
+    return enabled.load(std::memory_order_relaxed);
+}
+
+namespace detail {
+
+void add_counter(std::string_view name, uint64_t value) {
+    const std::lock_guard<std::mutex> lock(mutex);
+    auto it = counters.find(name);
+    if (it == counters.end()) {
+        it = counters.emplace(std::string(name), 0).first;
+    }
+    it->second += value;
+}
+
+void max_counter(std::string_view name, uint64_t value) {
+    const std::lock_guard<std::mutex> lock(mutex);
+    auto it = counters.find(name);
+    if (it == counters.end()) {
+        it = counters.emplace(std::string(name), 0).first;
+    }
+    it->second = std::max(it->second, value);
+}
+
+void add_timer(std::string_view name, double seconds) {
+    const std::lock_guard<std::mutex> lock(mutex);
+    auto it = timers.find(name);
+    if (it == timers.end()) {
+        it = timers.emplace(std::string(name), Timer{}).first;
+    }
+    it->second.sum += seconds;
+    it->second.count++;
+}
+
+}  // namespace detail
+
+AtomicCounter::AtomicCounter(const char* name)
+    : name_(name) {
+    const std::lock_guard<std::mutex> lock(mutex);
+    atomic_counters.push_back(this);
+}
+
+AtomicTimer::AtomicTimer(const char* name)
+    : name_(name) {
+    const std::lock_guard<std::mutex> lock(mutex);
+    atomic_timers.push_back(this);
+}
+
 };  // namespace tiledbsoma::stats
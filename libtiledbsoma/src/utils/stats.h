@@ -35,15 +35,192 @@
 
 #include <stdexcept>  // for windows: error C2039: 'runtime_error': is not a member of 'std'
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <string>
+#include <string_view>
 
 namespace tiledbsoma::stats {
 
 void enable();
 void disable();
 void reset();
+
+/**
+ * @brief Return the TileDB stats as a JSON string, with the libtiledbsoma
+ * counters and timers appended as one more entry of the same shape.
+ */
 std::string dump();
 
+/**
+ * @brief Return true if stats collection is enabled. Callers should check
+ * this before doing any work that is only needed to record stats.
+ */
+bool is_enabled();
+
+namespace detail {
+
+void add_counter(std::string_view name, uint64_t value);
+void max_counter(std::string_view name, uint64_t value);
+void add_timer(std::string_view name, double seconds);
+
+}  // namespace detail
+
+/**
+ * @brief Add `value` to the counter `name`. Nothing is done, not even
+ * building the name, while stats are disabled.
+ */
+inline void add_counter(std::string_view name, uint64_t value = 1) {
+    if (is_enabled()) {
+        detail::add_counter(name, value);
+    }
+}
+
+/**
+ * @brief Raise the counter `name` to `value` if it is larger, e.g., to keep
+ * a high-water mark.
+ */
+inline void max_counter(std::string_view name, uint64_t value) {
+    if (is_enabled()) {
+        detail::max_counter(name, value);
+    }
+}
+
+/**
+ * @brief Record `seconds` against the timer `name`. Timers are dumped as
+ * their sum and average.
+ */
+inline void add_timer(std::string_view name, double seconds) {
+    if (is_enabled()) {
+        detail::add_timer(name, seconds);
+    }
+}
+
+/**
+ * @brief A counter updated with relaxed atomics rather than under the stats
+ * lock, for paths as hot as task scheduling. It must have static storage
+ * duration, e.g. as a function-local static: it registers itself on
+ * construction and is dumped and reset with the other counters.
+ */
+class AtomicCounter {
+   public:
+    explicit AtomicCounter(const char* name);
+
+    AtomicCounter(const AtomicCounter&) = delete;
+    AtomicCounter& operator=(const AtomicCounter&) = delete;
+
+    void add(uint64_t value = 1) {
+        if (is_enabled()) {
+            value_.fetch_add(value, std::memory_order_relaxed);
+        }
+    }
+
+    // Raise the counter to `value` if it is larger
+    void max(uint64_t value) {
+        if (!is_enabled()) {
+            return;
+        }
+        auto current = value_.load(std::memory_order_relaxed);
+        while (current < value && !value_.compare_exchange_weak(
+                                      current,
+                                      value,
+                                      std::memory_order_relaxed)) {
+        }
+    }
+
+    const char* name() const {
+        return name_;
+    }
+
+    uint64_t value() const {
+        return value_.load(std::memory_order_relaxed);
+    }
+
+    void reset() {
+        value_.store(0, std::memory_order_relaxed);
+    }
+
+   private:
+    const char* name_;
+    std::atomic<uint64_t> value_{0};
+};
+
+/**
+ * @brief A timer updated with relaxed atomics, with the same requirements
+ * as AtomicCounter. Durations are summed in nanoseconds.
+ */
+class AtomicTimer {
+   public:
+    explicit AtomicTimer(const char* name);
+
+    AtomicTimer(const AtomicTimer&) = delete;
+    AtomicTimer& operator=(const AtomicTimer&) = delete;
+
+    void add(std::chrono::steady_clock::duration elapsed) {
+        if (is_enabled()) {
+            auto nanoseconds =
+                std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed);
+            nanoseconds_.fetch_add(
+                static_cast<uint64_t>(nanoseconds.count()),
+                std::memory_order_relaxed);
+            count_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    const char* name() const {
+        return name_;
+    }
+
+    double seconds() const {
+        return nanoseconds_.load(std::memory_order_relaxed) * 1e-9;
+    }
+
+    uint64_t count() const {
+        return count_.load(std::memory_order_relaxed);
+    }
+
+    void reset() {
+        nanoseconds_.store(0, std::memory_order_relaxed);
+        count_.store(0, std::memory_order_relaxed);
+    }
+
+   private:
+
+    const char* name_;
+    std::atomic<uint64_t> nanoseconds_{0};
+    std::atomic<uint64_t> count_{0};
+};
+
+/**
+ * @brief Record the lifetime of the object against the timer `name`, if
+ * stats are enabled when it is constructed.
+ */
+class ScopedTimer {
+   public:
+    ScopedTimer(const char* name)
+        : name_(is_enabled() ? name : nullptr) {
+        if (name_ != nullptr) {
+            start_ = std::chrono::steady_clock::now();
+        }
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    ~ScopedTimer() {
+        if (name_ != nullptr) {
+            std::chrono::duration<double> elapsed =
+                std::chrono::steady_clock::now() - start_;
+            add_timer(name_, elapsed.count());
+        }
+    }
+
+   private:
+    const char* name_;
+    std::chrono::steady_clock::time_point start_;
+};
+
 };  // namespace tiledbsoma::stats
 
 #endif  // TILEDBSOMA_STATS_H
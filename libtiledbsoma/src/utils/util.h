@@ -36,6 +36,7 @@
 #include <regex>
 #include <stdexcept>  // for windows: error C2039: 'runtime_error': is not a member of 'std'
 
+#include <tiledb/tiledb>
 #include "span/span.hpp"
 
 namespace tiledbsoma::util {
@@ -67,6 +68,60 @@ bool is_tiledb_uri(std::string_view uri);
  */
 std::string rstrip_uri(std::string_view uri);
 
+/**
+ * @brief Call `fn(T{})` with the C++ type `T` that stores values of the given
+ * fixed-size numeric TileDB type. Booleans are stored as uint8_t and
+ * datetimes as int64_t.
+ *
+ * @param type TileDB datatype
+ * @param fn Generic callable
+ * @return The result of `fn`
+ * @throws std::invalid_argument if the type is not numeric
+ */
+template <typename Fn>
+auto visit_numeric_type(tiledb_datatype_t type, Fn&& fn) {
+    switch (type) {
+        case TILEDB_INT8:
+            return fn(int8_t{});
+        case TILEDB_BOOL:
+        case TILEDB_UINT8:
+            return fn(uint8_t{});
+        case TILEDB_INT16:
+            return fn(int16_t{});
+        case TILEDB_UINT16:
+            return fn(uint16_t{});
+        case TILEDB_INT32:
+            return fn(int32_t{});
+        case TILEDB_UINT32:
+            return fn(uint32_t{});
+        case TILEDB_INT64:
+        case TILEDB_DATETIME_YEAR:
+        case TILEDB_DATETIME_MONTH:
+        case TILEDB_DATETIME_WEEK:
+        case TILEDB_DATETIME_DAY:
+        case TILEDB_DATETIME_HR:
+        case TILEDB_DATETIME_MIN:
+        case TILEDB_DATETIME_SEC:
+        case TILEDB_DATETIME_MS:
+        case TILEDB_DATETIME_US:
+        case TILEDB_DATETIME_NS:
+        case TILEDB_DATETIME_PS:
+        case TILEDB_DATETIME_FS:
+        case TILEDB_DATETIME_AS:
+            return fn(int64_t{});
+        case TILEDB_UINT64:
+            return fn(uint64_t{});
+        case TILEDB_FLOAT32:
+            return fn(float{});
+        case TILEDB_FLOAT64:
+            return fn(double{});
+        default:
+            throw std::invalid_argument(
+                "Unsupported non-numeric type " +
+                tiledb::impl::type_to_str(type));
+    }
+}
+
 }  // namespace tiledbsoma::util
 
 #endif
@@ -31,9 +31,14 @@
  */
 
 #include <reindexer/reindexer.h>
+#include <soma/soma_context.h>
+#include <atomic>
+#include <catch2/benchmark/catch_benchmark.hpp>
 #include <catch2/catch_test_macros.hpp>
 #include <cstdint>
+#include <map>
 #include <string>
+#include <thread>
 #include <tiledb/tiledb>
 #include <unordered_map>
 #include <vector>
@@ -142,4 +147,127 @@ TEST_CASE("C++ re-indexer") {
         }
     }
 }
+
+TEST_CASE("C++ re-indexer with thread pool") {
+    auto context = std::make_shared<tiledbsoma::SOMAContext>(
+        std::map<std::string, std::string>(
+            {{"sm.compute_concurrency_level", "8"}}));
+
+    // Large enough to be split over several parallel chunks
+    size_t size = 1000003;
+    std::vector<int64_t> keys(size);
+    for (size_t i = 0; i < size; i++) {
+        keys[i] = 3 * static_cast<int64_t>(i) - 1000;
+    }
+    tiledbsoma::IntIndexer indexer(context);
+    indexer.map_locations(keys);
+
+    std::vector<int64_t> lookups(keys.rbegin(), keys.rend());
+    lookups.push_back(-1);
+    std::vector<int64_t> results(lookups.size());
+    indexer.lookup(lookups, results);
+    for (size_t i = 0; i < size; i++) {
+        REQUIRE(results[i] == static_cast<int64_t>(size - 1 - i));
+    }
+    REQUIRE(results.back() == -1);
+}
+
+TEST_CASE("SOMAContext parallel_for") {
+    auto context = std::make_shared<tiledbsoma::SOMAContext>(
+        std::map<std::string, std::string>(
+            {{"sm.compute_concurrency_level", "8"}}));
+
+    for (size_t size : {0, 1, 10, 100000}) {
+        for (size_t grain_size : {1, 7, 1 << 14}) {
+            std::vector<std::atomic<int>> visits(size);
+            context->parallel_for(
+                0, size, grain_size, [&visits](size_t begin, size_t end) {
+                    for (size_t i = begin; i < end; i++) {
+                        visits[i]++;
+                    }
+                });
+            for (auto& v : visits) {
+                REQUIRE(v == 1);
+            }
+        }
+    }
+
+    REQUIRE_THROWS_AS(
+        context->parallel_for(
+            0,
+            100000,
+            10,
+            [](size_t begin, size_t) {
+                if (begin > 50000) {
+                    throw std::runtime_error("chunk failed");
+                }
+            }),
+        std::runtime_error);
+}
+
+TEST_CASE("SOMAContext CPU affinity list") {
+    auto thread_pool = [](const std::string& cpu_list) {
+        auto context = std::make_shared<tiledbsoma::SOMAContext>(
+            std::map<std::string, std::string>(
+                {{"sm.compute_concurrency_level", "4"},
+                 {"soma.thread_pool.cpu_affinity", cpu_list}}));
+        return context->thread_pool();
+    };
+
+    REQUIRE(thread_pool("0") != nullptr);
+    REQUIRE(thread_pool("0-1,0") != nullptr);
+    for (auto cpu_list :
+         {"", "3x", "0-7abc", "1 2", " 1", "+1", "-1", "1-", "2-1", "0,,1",
+          "0,", "99999999999999999999999", "0-100000000", "4096"}) {
+        INFO(cpu_list);
+
+        // Rejected when the context is built, not when the pool is created
+        REQUIRE_THROWS_AS(
+            tiledbsoma::SOMAContext(std::map<std::string, std::string>(
+                {{"soma.thread_pool.cpu_affinity", cpu_list}})),
+            std::runtime_error);
+    }
+}
+
+TEST_CASE("C++ re-indexer CPU affinity", "[.][benchmark]") {
+    // Lookup throughput with the SOMA thread pool unpinned, restricted to
+    // the first half of the CPUs, and with each worker pinned to one CPU.
+    size_t num_cpus = std::max(2u, std::thread::hardware_concurrency());
+    std::string concurrency = std::to_string(num_cpus);
+    std::string first_half = "0-" + std::to_string(num_cpus / 2 - 1);
+
+    size_t size = 1 << 24;
+    std::vector<int64_t> keys(size);
+    for (size_t i = 0; i < size; i++) {
+        keys[i] = 7 * static_cast<int64_t>(i);
+    }
+    std::vector<int64_t> lookups(keys.rbegin(), keys.rend());
+    std::vector<int64_t> results(size);
+
+    auto run = [&](std::map<std::string, std::string> config) {
+        config["sm.compute_concurrency_level"] = concurrency;
+        auto indexer = std::make_shared<tiledbsoma::IntIndexer>(
+            std::make_shared<tiledbsoma::SOMAContext>(config));
+        indexer->map_locations(keys);
+        return [&, indexer]() {
+            indexer->lookup(lookups, results);
+            return results.back();
+        };
+    };
+
+    auto unpinned = run({});
+    BENCHMARK("unpinned") {
+        return unpinned();
+    };
+    auto cpu_set = run({{"soma.thread_pool.cpu_affinity", first_half}});
+    BENCHMARK("cpu set") {
+        return cpu_set();
+    };
+    auto pinned = run(
+        {{"soma.thread_pool.cpu_affinity", first_half},
+         {"soma.thread_pool.pin_workers", "true"}});
+    BENCHMARK("pinned workers") {
+        return pinned();
+    };
+}
 }  // namespace
@@ -31,6 +31,8 @@
  */
 
 #include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators_all.hpp>
+#include <cstring>
 #include <tiledb/tiledb>
 #include <tiledbsoma/tiledbsoma>
 
@@ -99,3 +101,56 @@ TEST_CASE("ColumnBuffer: Create from array") {
         REQUIRE(buffers->is_nullable() == true);
     }
 }
+
+TEST_CASE("ColumnBuffer: string layouts") {
+    auto layout = GENERATE(
+        StringLayout::large, StringLayout::compact, StringLayout::view);
+
+    std::string data = "abcthirteen bytesxyz";
+    std::vector<uint64_t> offsets({0, 3, 17, 20});
+    auto column = std::make_shared<ColumnBuffer>(
+        "s", TILEDB_STRING_UTF8, 3, data.size(), true, false);
+    column->set_data(3, data.data(), offsets.data());
+    column->set_string_layout(layout);
+
+    auto [array, schema] = ArrowAdapter::to_arrow(column);
+    REQUIRE(array->length == 3);
+    if (layout == StringLayout::large) {
+        REQUIRE(std::string(schema->format) == "U");
+        REQUIRE(array->n_buffers == 3);
+        auto exported = (const uint64_t*)array->buffers[1];
+        REQUIRE(std::vector<uint64_t>(exported, exported + 4) == offsets);
+    } else if (layout == StringLayout::compact) {
+        REQUIRE(std::string(schema->format) == "u");
+        REQUIRE(array->n_buffers == 3);
+        auto exported = (const uint32_t*)array->buffers[1];
+        REQUIRE(
+            std::vector<uint32_t>(exported, exported + 4) ==
+            std::vector<uint32_t>({0, 3, 17, 20}));
+    } else {
+        REQUIRE(std::string(schema->format) == "vu");
+        REQUIRE(array->n_buffers == 4);
+        REQUIRE(*(const int64_t*)array->buffers[3] == 20);
+
+        // Short values are inlined, long ones point into the data buffer
+        auto views = (const char*)array->buffers[1];
+        auto int32_at = [&](size_t offset) {
+            int32_t value;
+            std::memcpy(&value, views + offset, sizeof(int32_t));
+            return value;
+        };
+        REQUIRE(int32_at(0) == 3);
+        REQUIRE(std::string(views + 4, 3) == "abc");
+        REQUIRE(int32_at(16) == 14);
+        REQUIRE(std::string(views + 20, 4) == "thir");
+        REQUIRE(int32_at(24) == 0);
+        REQUIRE(int32_at(28) == 3);
+        REQUIRE(int32_at(32) == 3);
+        REQUIRE(std::string(views + 36, 3) == "xyz");
+    }
+
+    // The string data is exported in place in every layout
+    REQUIRE(array->buffers[2] == column->data<char>().data());
+    array->release(array.get());
+    schema->release(schema.get());
+}
@@ -196,3 +196,99 @@ TEST_CASE("ManagedQuery: Validity test") {
     REQUIRE_THAT(a0, Equals(mq.strings(attr_name)));
     REQUIRE_THAT(a0_valids, Equals(a0_valids_actual));
 }
+
+TEST_CASE("ManagedQuery: Read stats") {
+    std::string uri = "mem://unit-test-array-stats";
+
+    auto ctx = std::make_shared<Context>();
+    auto [array, d0, a0, _] = create_array(uri, *ctx);
+
+    stats::reset();
+    stats::enable();
+
+    auto mq = ManagedQuery(array, ctx);
+    mq.setup_read();
+    mq.submit_read();
+    mq.results();
+
+    stats::disable();
+    auto dump = stats::dump();
+    stats::reset();
+
+    REQUIRE_THAT(dump, ContainsSubstring("\"soma.managed_query.reads\": 1"));
+    REQUIRE_THAT(
+        dump,
+        ContainsSubstring(
+            "\"soma.managed_query.cells_read\": " +
+            std::to_string(d0.size())));
+    REQUIRE_THAT(dump, ContainsSubstring("soma.managed_query.bytes_read"));
+    REQUIRE_THAT(dump, ContainsSubstring("soma.managed_query.submit_wait.sum"));
+    REQUIRE_THAT(dump, ContainsSubstring("soma.column_buffer.allocs"));
+}
+
+TEST_CASE("ManagedQuery: atomic stats counters") {
+    static stats::AtomicCounter counter("soma.test.atomic_counter");
+    static stats::AtomicTimer timer("soma.test.atomic_timer");
+
+    stats::reset();
+    counter.add(5);
+    REQUIRE(counter.value() == 0);
+
+    stats::enable();
+    counter.add(2);
+    counter.max(1);
+    counter.add();
+    timer.add(std::chrono::milliseconds(3));
+    stats::disable();
+
+    auto dump = stats::dump();
+    REQUIRE_THAT(dump, ContainsSubstring("\"soma.test.atomic_counter\": 3"));
+    REQUIRE_THAT(dump, ContainsSubstring("soma.test.atomic_timer.sum"));
+
+    stats::reset();
+    REQUIRE(counter.value() == 0);
+    REQUIRE(timer.count() == 0);
+}
+
+TEST_CASE("ManagedQuery: Result size estimate") {
+    std::string uri = "mem://unit-test-array-estimate";
+    std::string dim_name = "d0";
+    std::string attr_name = "a0";
+
+    auto ctx = std::make_shared<Context>();
+    auto [array, d0, a0, _] = create_array(uri, *ctx);
+
+    auto mq = ManagedQuery(array, ctx);
+    mq.select_points<std::string>(dim_name, {"a"});
+
+    auto estimates = mq.estimate_result_sizes();
+    REQUIRE(estimates.size() == 2);
+    REQUIRE(estimates.at(dim_name).num_cells >= 1);
+    REQUIRE(estimates.at(attr_name).num_cells >= 1);
+    REQUIRE(estimates.at(attr_name).data_bytes >= a0[0].size());
+
+    stats::reset();
+    stats::enable();
+
+    mq.setup_read();
+    mq.submit_read();
+    mq.results();
+
+    stats::disable();
+    auto dump = stats::dump();
+    stats::reset();
+
+    REQUIRE(mq.results_complete());
+    REQUIRE(mq.total_num_cells() == 1);
+    REQUIRE_THAT(
+        std::string(a0[0]), Equals(std::string(mq.string_view(attr_name, 0))));
+
+    // Buffers are sized from the estimate rather than soma.init_buffer_bytes
+    std::string key = "\"soma.column_buffer.alloc_bytes\": ";
+    auto pos = dump.find(key);
+    REQUIRE(pos != std::string::npos);
+    REQUIRE(std::stoull(dump.substr(pos + key.size())) < (1 << 20));
+
+    // Estimates are only available before the query is submitted
+    REQUIRE_THROWS(mq.estimate_result_sizes());
+}
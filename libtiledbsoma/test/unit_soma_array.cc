@@ -178,6 +178,16 @@ std::tuple<std::vector<int64_t>, std::vector<int>> write_array(
     return {expected_d0, expected_a0};
 }
 
+// Value of a counter in the stats dump, or 0 if it is not in the dump
+uint64_t stats_counter(const std::string& name) {
+    auto dump = stats::dump();
+    auto key = "\"" + name + "\": ";
+    auto pos = dump.find(key);
+    return pos == std::string::npos ?
+               0 :
+               std::stoull(dump.substr(pos + key.size()));
+}
+
 };  // namespace
 
 TEST_CASE("SOMAArray: nnz") {
@@ -486,6 +496,155 @@ TEST_CASE("SOMAArray: Enumeration") {
     REQUIRE(soma_array->attr_has_enum("a"));
 }
 
+TEST_CASE("SOMAArray: Enumeration dictionary shared across batches") {
+    std::string uri = "mem://unit-test-array-enmr-shared";
+    std::map<std::string, std::string> cfg;
+    cfg["soma.init_buffer_bytes"] = "16";
+    auto ctx = std::make_shared<SOMAContext>(cfg);
+    ArraySchema schema(*ctx->tiledb_ctx(), TILEDB_SPARSE);
+
+    auto dim = Dimension::create<int64_t>(*ctx->tiledb_ctx(), "d", {0, 99});
+    Domain dom(*ctx->tiledb_ctx());
+    dom.add_dimension(dim);
+    schema.set_domain(dom);
+
+    std::vector<std::string> vals = {"red", "blue", "green"};
+    auto enmr = Enumeration::create(*ctx->tiledb_ctx(), "rbg", vals);
+    ArraySchemaExperimental::add_enumeration(*ctx->tiledb_ctx(), schema, enmr);
+
+    auto attr = Attribute::create<int>(*ctx->tiledb_ctx(), "a");
+    AttributeExperimental::set_enumeration_name(
+        *ctx->tiledb_ctx(), attr, "rbg");
+    schema.add_attribute(attr);
+
+    Array::create(uri, std::move(schema));
+
+    std::vector<int64_t> d = {0, 1, 2, 3, 4, 5};
+    std::vector<int> a = {2, 0, 1, 0, 1, 2};
+    Array array(*ctx->tiledb_ctx(), uri, TILEDB_WRITE);
+    Query query(*ctx->tiledb_ctx(), array);
+    query.set_layout(TILEDB_UNORDERED)
+        .set_data_buffer("d", d)
+        .set_data_buffer("a", a);
+    query.submit();
+    array.close();
+
+    // Every batch references the same dictionary buffers
+    auto soma_array = SOMAArray::open(OpenMode::read, uri, ctx);
+    const void* offsets = nullptr;
+    const void* data = nullptr;
+    size_t batches = 0;
+    while (auto batch = soma_array->read_next()) {
+        auto [arr, sch] = ArrowAdapter::to_arrow((*batch)->at("a"));
+        REQUIRE(sch->dictionary != nullptr);
+        REQUIRE(std::string(sch->dictionary->format) == "u");
+        REQUIRE(arr->dictionary->length == 3);
+        if (batches++ == 0) {
+            offsets = arr->dictionary->buffers[1];
+            data = arr->dictionary->buffers[2];
+            auto dict_offsets = static_cast<const int32_t*>(offsets);
+            std::string dict_data(
+                static_cast<const char*>(data), dict_offsets[3]);
+            REQUIRE(dict_data == "redbluegreen");
+        } else {
+            REQUIRE(arr->dictionary->buffers[1] == offsets);
+            REQUIRE(arr->dictionary->buffers[2] == data);
+        }
+        arr->release(arr.get());
+        sch->release(sch.get());
+    }
+    REQUIRE(batches > 1);
+    soma_array->close();
+}
+
+TEST_CASE("SOMAArray: Arrow schema and export plans are cached") {
+    std::map<std::string, std::string> cfg;
+    cfg["soma.init_buffer_bytes"] = "16";
+    auto ctx = std::make_shared<SOMAContext>(cfg);
+    std::string base_uri = "mem://unit-test-array-export-plan";
+    auto [uri, expected_nnz] = create_array(base_uri, ctx);
+    write_array(uri, ctx);
+    auto soma_array = SOMAArray::open(OpenMode::read, uri, ctx);
+
+    // Each call returns its own copy of the cached schema
+    auto schema = soma_array->arrow_schema();
+    auto other = soma_array->arrow_schema();
+    REQUIRE(schema.get() != other.get());
+    REQUIRE(schema->n_children == 2);
+    REQUIRE(other->n_children == 2);
+    REQUIRE(std::string(schema->children[0]->name) == "d0");
+    REQUIRE(std::string(other->children[0]->format) == "l");
+    REQUIRE(std::string(other->children[1]->format) == "i");
+    schema->release(schema.get());
+    other->release(other.get());
+
+    // Every batch of a column shares one export plan
+    std::shared_ptr<ArrowExportPlan> plan;
+    size_t batches = 0;
+    while (auto batch = soma_array->read_next()) {
+        auto column = (*batch)->at("a0");
+        REQUIRE(column->export_plan() != nullptr);
+        if (batches++ == 0) {
+            plan = column->export_plan();
+        } else {
+            REQUIRE(column->export_plan() == plan);
+        }
+        auto [arr, sch] = ArrowAdapter::to_arrow(column);
+        REQUIRE(std::string(sch->format) == "i");
+        REQUIRE(plan->format_ == "i");
+        arr->release(arr.get());
+        sch->release(sch.get());
+    }
+    REQUIRE(batches > 1);
+    soma_array->close();
+}
+
+TEST_CASE("SOMAArray: Arrow batches share one schema") {
+    std::map<std::string, std::string> cfg;
+    cfg["soma.init_buffer_bytes"] = "16";
+    auto ctx = std::make_shared<SOMAContext>(cfg);
+    std::string base_uri = "mem://unit-test-array-batch-exporter";
+    auto [uri, expected_nnz] = create_array(base_uri, ctx);
+    write_array(uri, ctx);
+    auto soma_array = SOMAArray::open(OpenMode::read, uri, ctx);
+
+    // The schema is built from the first batch and kept for the others
+    BatchExporter exporter;
+    const ArrowSchema* schema = nullptr;
+    uint64_t num_rows = 0;
+    size_t batches = 0;
+    while (auto batch = soma_array->read_next()) {
+        auto array = exporter.export_array(*batch);
+        if (batches++ == 0) {
+            schema = exporter.schema();
+        } else {
+            REQUIRE(exporter.schema() == schema);
+        }
+        REQUIRE(schema->n_children == 2);
+        REQUIRE(array->n_children == 2);
+        REQUIRE(std::string(schema->children[1]->format) == "i");
+        num_rows += array->length;
+        array->release(array.get());
+    }
+    REQUIRE(batches > 1);
+    REQUIRE(num_rows == expected_nnz);
+
+    // Each batch of read_next_arrow comes with its own copy of the schema
+    soma_array->reset();
+    num_rows = 0;
+    while (auto batch = soma_array->read_next_arrow()) {
+        auto& [array, batch_schema] = *batch;
+        REQUIRE(std::string(batch_schema->format) == "+s");
+        REQUIRE(std::string(batch_schema->children[0]->name) == "d0");
+        REQUIRE(std::string(batch_schema->children[1]->name) == "a0");
+        num_rows += array->length;
+        array->release(array.get());
+        batch_schema->release(batch_schema.get());
+    }
+    REQUIRE(num_rows == expected_nnz);
+    soma_array->close();
+}
+
 TEST_CASE("SOMAArray: ResultOrder") {
     auto ctx = std::make_shared<SOMAContext>();
     std::string base_uri = "mem://unit-test-array-result-order";
@@ -596,3 +755,439 @@ TEST_CASE("SOMAArray: Write and read back Boolean") {
             {false, true, false, true, false, true, false, true}));
     soma_array->close();
 }
+
+TEST_CASE("SOMAArray: partitioned scan") {
+    auto order = GENERATE(ScanOrder::arbitrary, ScanOrder::range);
+    int num_cells_per_fragment = 128;
+    int num_fragments = 4;
+
+    // Small buffers, so each partition is read in several batches
+    std::map<std::string, std::string> cfg;
+    cfg["soma.init_buffer_bytes"] = "256";
+    auto ctx = std::make_shared<SOMAContext>(cfg);
+
+    std::string base_uri = "mem://unit-test-array-partitioned-scan";
+    auto [uri, expected_nnz] = create_array(
+        base_uri, ctx, num_cells_per_fragment, num_fragments);
+    auto [expected_d0, expected_a0] = write_array(
+        uri, ctx, num_cells_per_fragment, num_fragments);
+
+    auto soma_array = SOMAArray::open(OpenMode::read, uri, ctx);
+    soma_array->reset({}, "auto", ResultOrder::rowmajor);
+
+    auto scan = soma_array->partitioned_scan(8, order, 4);
+    auto partitions = scan->partitions();
+    REQUIRE(partitions.size() == 8);
+    REQUIRE(partitions.front().first == 0);
+    REQUIRE(partitions.back().second == 511);
+    for (size_t i = 1; i < partitions.size(); i++) {
+        REQUIRE(partitions[i].first == partitions[i - 1].second + 1);
+    }
+
+    std::vector<int64_t> d0;
+    while (auto batch = scan->read_next()) {
+        auto d0span = (*batch)->at("d0")->data<int64_t>();
+        d0.insert(d0.end(), d0span.begin(), d0span.end());
+    }
+    REQUIRE(d0.size() == expected_nnz);
+    if (order == ScanOrder::arbitrary) {
+        std::sort(d0.begin(), d0.end());
+    }
+    std::sort(expected_d0.begin(), expected_d0.end());
+    REQUIRE(d0 == expected_d0);
+
+    // The managed query is left untouched
+    REQUIRE(soma_array->read_next().has_value());
+
+    // A selection would be silently ignored by the partitions
+    soma_array->reset();
+    soma_array->set_dim_points<int64_t>("d0", std::vector<int64_t>({1, 2}));
+    REQUIRE_THROWS_AS(soma_array->partitioned_scan(8, order), TileDBSOMAError);
+    soma_array->reset();
+    REQUIRE(soma_array->partitioned_scan(8, order)->read_next().has_value());
+    soma_array->close();
+}
+
+TEST_CASE("SOMAArray: partitioned scan domain split") {
+    using FragmentExtent = PartitionedScan::FragmentExtent;
+
+    REQUIRE(PartitionedScan::split_domain({}, 4).empty());
+
+    // Uniform cells split into equal ranges
+    REQUIRE(
+        PartitionedScan::split_domain({FragmentExtent{0, 99, 100}}, 4) ==
+        std::vector<std::pair<int64_t, int64_t>>(
+            {{0, 24}, {25, 49}, {50, 74}, {75, 99}}));
+
+    // A dense fragment gets narrower ranges
+    auto ranges = PartitionedScan::split_domain(
+        {FragmentExtent{0, 9, 1000}, FragmentExtent{10, 999, 10}}, 2);
+    REQUIRE(
+        ranges ==
+        std::vector<std::pair<int64_t, int64_t>>({{0, 5}, {6, 999}}));
+
+    // Never more ranges than coordinates
+    REQUIRE(
+        PartitionedScan::split_domain({FragmentExtent{0, 1, 10}}, 8).size() ==
+        2);
+}
+
+TEST_CASE("SOMAArray: limit and top-k") {
+    int num_cells_per_fragment = 16;
+    int num_fragments = 4;
+
+    // Small buffers, so the array is read in several batches
+    std::map<std::string, std::string> cfg;
+    cfg["soma.init_buffer_bytes"] = "64";
+    auto ctx = std::make_shared<SOMAContext>(cfg);
+
+    std::string base_uri = "mem://unit-test-array-limit-top-k";
+    auto [uri, expected_nnz] = create_array(
+        base_uri, ctx, num_cells_per_fragment, num_fragments);
+    write_array(uri, ctx, num_cells_per_fragment, num_fragments);
+
+    auto soma_array = SOMAArray::open(OpenMode::read, uri, ctx);
+
+    // The batch reaching the limit is truncated and no more are read
+    soma_array->reset({}, "auto", ResultOrder::rowmajor);
+    soma_array->set_limit(10);
+    std::vector<int64_t> d0;
+    size_t num_batches = 0;
+    while (auto batch = soma_array->read_next()) {
+        auto d0span = (*batch)->at("d0")->data<int64_t>();
+        d0.insert(d0.end(), d0span.begin(), d0span.end());
+        num_batches++;
+    }
+    std::vector<int64_t> expected_d0(10);
+    std::iota(expected_d0.begin(), expected_d0.end(), 0);
+    REQUIRE(d0 == expected_d0);
+    REQUIRE(num_batches == 2);
+    REQUIRE(soma_array->total_num_cells() == 10);
+
+    // A limit of 0 returns one empty batch with the selected columns
+    soma_array->reset({"d0", "a0"}, "auto", ResultOrder::rowmajor);
+    soma_array->set_limit(0);
+    auto batch = soma_array->read_next();
+    REQUIRE(batch.has_value());
+    REQUIRE((*batch)->num_rows() == 0);
+    REQUIRE((*batch)->names() == std::vector<std::string>({"d0", "a0"}));
+    REQUIRE(!soma_array->read_next().has_value());
+
+    auto top_k = [&](const std::string& column, uint64_t k, bool largest) {
+        soma_array->reset({}, "auto", ResultOrder::rowmajor);
+        auto buffers = soma_array->read_top_k(column, k, largest);
+        auto d0span = buffers->at("d0")->data<int64_t>();
+        return std::vector<int64_t>(d0span.begin(), d0span.end());
+    };
+    REQUIRE(top_k("d0", 5, true) == std::vector<int64_t>({63, 62, 61, 60, 59}));
+    REQUIRE(top_k("d0", 3, false) == std::vector<int64_t>({0, 1, 2}));
+    REQUIRE(top_k("d0", 100, true).size() == expected_nnz);
+    REQUIRE(top_k("d0", 0, true).empty());
+
+    // a0 is the fragment number: ties keep the rows read first
+    REQUIRE(top_k("a0", 3, true) == std::vector<int64_t>({48, 49, 50}));
+
+    // The ranked column must be read
+    soma_array->reset({"a0"});
+    REQUIRE_THROWS_AS(soma_array->read_top_k("d0", 1), TileDBSOMAError);
+    soma_array->close();
+}
+
+TEST_CASE("SOMAArray: Arrow stream") {
+    auto prefetch = GENERATE(true, false);
+    int num_cells_per_fragment = 16;
+    int num_fragments = 4;
+
+    // Small buffers, so the stream returns several batches
+    std::map<std::string, std::string> cfg;
+    cfg["soma.init_buffer_bytes"] = "64";
+    auto ctx = std::make_shared<SOMAContext>(cfg);
+
+    std::string base_uri = "mem://unit-test-array-arrow-stream";
+    auto [uri, expected_nnz] = create_array(
+        base_uri, ctx, num_cells_per_fragment, num_fragments);
+    auto [expected_d0, expected_a0] = write_array(
+        uri, ctx, num_cells_per_fragment, num_fragments);
+
+    auto soma_array = SOMAArray::open(OpenMode::read, uri, ctx);
+    soma_array->reset({"d0", "a0"}, "auto", ResultOrder::rowmajor);
+
+    ArrowArrayStream stream;
+    soma_array->to_arrow_stream(&stream, prefetch);
+
+    ArrowSchema schema;
+    REQUIRE(stream.get_schema(&stream, &schema) == 0);
+    REQUIRE(std::string(schema.format) == "+s");
+    REQUIRE(schema.n_children == 2);
+    REQUIRE(std::string(schema.children[0]->name) == "d0");
+    REQUIRE(std::string(schema.children[1]->name) == "a0");
+    schema.release(&schema);
+
+    std::vector<int64_t> d0;
+    size_t num_batches = 0;
+    while (true) {
+        ArrowArray batch;
+        REQUIRE(stream.get_next(&stream, &batch) == 0);
+        if (batch.release == nullptr) {
+            break;
+        }
+        REQUIRE(batch.n_children == 2);
+        REQUIRE(batch.children[0]->length == batch.length);
+        auto data = static_cast<const int64_t*>(
+            batch.children[0]->buffers[1]);
+        d0.insert(d0.end(), data, data + batch.length);
+        batch.release(&batch);
+        num_batches++;
+    }
+    stream.release(&stream);
+
+    REQUIRE(num_batches > 1);
+    REQUIRE(d0.size() == expected_nnz);
+    std::sort(expected_d0.begin(), expected_d0.end());
+    REQUIRE(d0 == expected_d0);
+    soma_array->close();
+}
+
+TEST_CASE("SOMAArray: Arrow stream keeps its string layout") {
+    auto layout = GENERATE(
+        StringLayout::large, StringLayout::compact, StringLayout::view);
+
+    // Batches of at most 4 cells or 32 bytes of strings, of which only 16
+    // may be exported with 32-bit offsets
+    std::map<std::string, std::string> cfg;
+    cfg["soma.init_buffer_bytes"] = "32";
+    cfg["soma.max_narrow_string_bytes"] = "16";
+    auto ctx = std::make_shared<SOMAContext>(cfg);
+
+    std::string uri = "mem://unit-test-array-arrow-stream-layout";
+    ArraySchema schema(*ctx->tiledb_ctx(), TILEDB_SPARSE);
+    auto dim = Dimension::create<int64_t>(*ctx->tiledb_ctx(), "d", {0, 99});
+    Domain dom(*ctx->tiledb_ctx());
+    dom.add_dimension(dim);
+    schema.set_domain(dom);
+    Attribute attr(*ctx->tiledb_ctx(), "s", TILEDB_STRING_UTF8);
+    attr.set_cell_val_num(TILEDB_VAR_NUM);
+    schema.add_attribute(attr);
+    Array::create(uri, std::move(schema));
+
+    // The first batch holds short strings, the later ones a long one each
+    std::vector<int64_t> d = {0, 1, 2, 3, 4, 5, 6};
+    std::vector<std::string> values = {"ab", "ab", "ab", "ab"};
+    values.resize(d.size(), std::string(20, 'x'));
+    std::string data;
+    std::vector<uint64_t> offsets;
+    for (auto& value : values) {
+        offsets.push_back(data.size());
+        data += value;
+    }
+    Array array(*ctx->tiledb_ctx(), uri, TILEDB_WRITE);
+    Query query(*ctx->tiledb_ctx(), array);
+    query.set_layout(TILEDB_UNORDERED)
+        .set_data_buffer("d", d)
+        .set_data_buffer("s", data)
+        .set_offsets_buffer("s", offsets);
+    query.submit();
+    array.close();
+
+    auto soma_array = SOMAArray::open(OpenMode::read, uri, ctx);
+    soma_array->reset({"d", "s"}, "auto", ResultOrder::rowmajor);
+    soma_array->set_string_layout(layout);
+    ArrowArrayStream stream;
+    soma_array->to_arrow_stream(&stream);
+
+    ArrowSchema stream_schema;
+    REQUIRE(stream.get_schema(&stream, &stream_schema) == 0);
+    std::string format(stream_schema.children[1]->format);
+    stream_schema.release(&stream_schema);
+
+    // Batches too large for the layout of the schema are not returned
+    // with another one
+    size_t num_cells = 0;
+    int rc = 0;
+    while (true) {
+        ArrowArray batch;
+        rc = stream.get_next(&stream, &batch);
+        if (rc != 0 || batch.release == nullptr) {
+            break;
+        }
+        num_cells += batch.length;
+        batch.release(&batch);
+    }
+    if (layout == StringLayout::large) {
+        REQUIRE(format == "U");
+        REQUIRE(rc == 0);
+        REQUIRE(num_cells == d.size());
+    } else {
+        REQUIRE(format == (layout == StringLayout::compact ? "u" : "vu"));
+        REQUIRE(rc != 0);
+        REQUIRE_THAT(
+            std::string(stream.get_last_error(&stream)),
+            ContainsSubstring("does not match the stream schema"));
+        REQUIRE(num_cells < d.size());
+    }
+    stream.release(&stream);
+    soma_array->close();
+}
+
+TEST_CASE("SOMAArray: write Arrow stream") {
+    int num_cells_per_fragment = 16;
+    int num_fragments = 4;
+
+    // Small buffers, so the stream holds several batches
+    std::map<std::string, std::string> cfg;
+    cfg["soma.init_buffer_bytes"] = "64";
+    auto ctx = std::make_shared<SOMAContext>(cfg);
+
+    auto [src_uri, expected_nnz] = create_array(
+        "mem://unit-test-array-write-stream-src",
+        ctx,
+        num_cells_per_fragment,
+        num_fragments);
+    auto [expected_d0, expected_a0] = write_array(
+        src_uri, ctx, num_cells_per_fragment, num_fragments);
+    auto [dst_uri, dst_nnz] = create_array(
+        "mem://unit-test-array-write-stream-dst", ctx);
+
+    // Copy the source array to the destination, one batch at a time
+    auto src = SOMAArray::open(OpenMode::read, src_uri, ctx);
+    src->reset({"d0", "a0"}, "auto", ResultOrder::rowmajor);
+    ArrowArrayStream stream;
+    src->to_arrow_stream(&stream);
+
+    auto dst = SOMAArray::open(OpenMode::write, dst_uri, ctx);
+    REQUIRE(dst->write_stream(&stream) == expected_nnz);
+    REQUIRE(stream.release == nullptr);
+    dst->close();
+    src->close();
+
+    dst = SOMAArray::open(OpenMode::read, dst_uri, ctx);
+    dst->reset({}, "auto", ResultOrder::rowmajor);
+    std::vector<int64_t> d0;
+    std::vector<int> a0;
+    while (auto batch = dst->read_next()) {
+        auto d0span = (*batch)->at("d0")->data<int64_t>();
+        auto a0span = (*batch)->at("a0")->data<int>();
+        d0.insert(d0.end(), d0span.begin(), d0span.end());
+        a0.insert(a0.end(), a0span.begin(), a0span.end());
+    }
+    std::vector<int64_t> sorted_d0(expected_d0.size());
+    std::iota(sorted_d0.begin(), sorted_d0.end(), 0);
+    REQUIRE(d0 == sorted_d0);
+    for (size_t i = 0; i < a0.size(); i++) {
+        REQUIRE(a0[i] == d0[i] / num_cells_per_fragment);
+    }
+
+    // The stream is released even if nothing can be written
+    src = SOMAArray::open(OpenMode::read, src_uri, ctx);
+    src->to_arrow_stream(&stream);
+    REQUIRE_THROWS_AS(dst->write_stream(&stream), TileDBSOMAError);
+    REQUIRE(stream.release == nullptr);
+    src->close();
+    dst->close();
+}
+
+TEST_CASE("SOMAArray: write Arrow stream extends an enumeration once") {
+    std::map<std::string, std::string> cfg;
+    cfg["soma.init_buffer_bytes"] = "16";
+    auto ctx = std::make_shared<SOMAContext>(cfg);
+
+    auto create = [&](const std::string& uri,
+                      const std::vector<std::string>& labels) {
+        ArraySchema schema(*ctx->tiledb_ctx(), TILEDB_SPARSE);
+        auto dim = Dimension::create<int64_t>(
+            *ctx->tiledb_ctx(), "d", {0, 99});
+        Domain dom(*ctx->tiledb_ctx());
+        dom.add_dimension(dim);
+        schema.set_domain(dom);
+        auto enmr = Enumeration::create(*ctx->tiledb_ctx(), "rbg", labels);
+        ArraySchemaExperimental::add_enumeration(
+            *ctx->tiledb_ctx(), schema, enmr);
+        auto attr = Attribute::create<int>(*ctx->tiledb_ctx(), "a");
+        AttributeExperimental::set_enumeration_name(
+            *ctx->tiledb_ctx(), attr, "rbg");
+        schema.add_attribute(attr);
+        Array::create(uri, std::move(schema));
+    };
+
+    std::string src_uri = "mem://unit-test-array-write-stream-enmr-src";
+    std::string dst_uri = "mem://unit-test-array-write-stream-enmr-dst";
+    create(src_uri, {"red", "blue", "green"});
+    create(dst_uri, {"green"});
+
+    std::vector<int64_t> d = {0, 1, 2, 3, 4, 5};
+    std::vector<int> a = {2, 0, 1, 0, 1, 2};
+    Array array(*ctx->tiledb_ctx(), src_uri, TILEDB_WRITE);
+    Query query(*ctx->tiledb_ctx(), array);
+    query.set_layout(TILEDB_UNORDERED)
+        .set_data_buffer("d", d)
+        .set_data_buffer("a", a);
+    query.submit();
+    array.close();
+
+    // Every batch carries the full dictionary, so the first one extends
+    // the enumeration and the others only remap their indexes
+    auto src = SOMAArray::open(OpenMode::read, src_uri, ctx);
+    src->reset({"d", "a"}, "auto", ResultOrder::rowmajor);
+    ArrowArrayStream stream;
+    src->to_arrow_stream(&stream);
+    auto dst = SOMAArray::open(OpenMode::write, dst_uri, ctx);
+    REQUIRE(dst->write_stream(&stream) == d.size());
+    dst->close();
+    src->close();
+
+    dst = SOMAArray::open(OpenMode::read, dst_uri, ctx);
+    auto labels = dst->get_attr_to_enum_mapping()
+                      .at("a")
+                      .as_vector<std::string>();
+    REQUIRE(labels.size() == 3);
+    REQUIRE(labels[0] == "green");
+
+    dst->reset({}, "auto", ResultOrder::rowmajor);
+    std::vector<std::string> expected = {
+        "green", "red", "blue", "red", "blue", "green"};
+    std::vector<std::string> written;
+    while (auto batch = dst->read_next()) {
+        for (auto index : (*batch)->at("a")->data<int>()) {
+            written.push_back(labels[index]);
+        }
+    }
+    REQUIRE(written == expected);
+    dst->close();
+}
+
+TEST_CASE("SOMAArray: write Arrow stream frees the cast batches") {
+    int num_cells_per_fragment = 256;
+    int num_fragments = 2;
+
+    // Batches of 8 cells
+    std::map<std::string, std::string> cfg;
+    cfg["soma.init_buffer_bytes"] = "64";
+    auto ctx = std::make_shared<SOMAContext>(cfg);
+
+    auto [src_uri, expected_nnz] = create_array(
+        "mem://unit-test-array-write-stream-free-src",
+        ctx,
+        num_cells_per_fragment,
+        num_fragments);
+    write_array(src_uri, ctx, num_cells_per_fragment, num_fragments);
+    auto [dst_uri, dst_nnz] = create_array(
+        "mem://unit-test-array-write-stream-free-dst", ctx);
+
+    auto src = SOMAArray::open(OpenMode::read, src_uri, ctx);
+    ArrowArrayStream stream;
+    src->to_arrow_stream(&stream);
+    auto dst = SOMAArray::open(OpenMode::write, dst_uri, ctx);
+
+    stats::reset();
+    stats::enable();
+    REQUIRE(dst->write_stream(&stream) == expected_nnz);
+    stats::disable();
+    dst->close();
+    src->close();
+
+    // Every column cast from a batch is freed once it is copied
+    auto cast = stats_counter("soma.array.cast_columns");
+    REQUIRE(cast >= 2 * expected_nnz / 8);
+    REQUIRE(stats_counter("soma.array.cast_columns_released") == cast);
+    stats::reset();
+}
@@ -389,3 +389,158 @@ TEST_CASE("SOMADataFrame: bounds-checking") {
 
     soma_dataframe->close();
 }
+
+TEST_CASE("SOMADataFrame: late materialization") {
+    int64_t dim_max = 1000;
+    auto ctx = std::make_shared<SOMAContext>();
+    std::string uri = "mem://unit-test-dataframe-late-materialization";
+
+    std::vector<helper::DimInfo> dim_infos(
+        {{.name = "soma_joinid",
+          .tiledb_datatype = TILEDB_INT64,
+          .dim_max = dim_max,
+          .use_current_domain = false}});
+
+    std::vector<helper::AttrInfo> attr_infos(
+        {{.name = "a0", .tiledb_datatype = TILEDB_INT64},
+         {.name = "a1", .tiledb_datatype = TILEDB_INT64}});
+
+    auto [schema, index_columns] =
+        helper::create_arrow_schema_and_index_columns(dim_infos, attr_infos);
+
+    SOMADataFrame::create(
+        uri,
+        std::move(schema),
+        ArrowTable(
+            std::move(index_columns.first), std::move(index_columns.second)),
+        ctx);
+
+    std::vector<int64_t> joinids(10), a0(10), a1(10);
+    for (int64_t j = 0; j < 10; j++) {
+        joinids[j] = j;
+        a0[j] = 10 * j;
+        a1[j] = j;
+    }
+
+    auto soma_dataframe = SOMADataFrame::open(uri, OpenMode::write, ctx);
+    soma_dataframe->set_column_data("a0", a0.size(), a0.data());
+    soma_dataframe->set_column_data("a1", a1.size(), a1.data());
+    soma_dataframe->set_column_data(
+        "soma_joinid", joinids.size(), joinids.data());
+    soma_dataframe->write();
+    soma_dataframe->close();
+
+    soma_dataframe = SOMADataFrame::open(uri, OpenMode::read, ctx);
+
+    auto read_column = [](const auto& batches, const std::string& name) {
+        std::vector<int64_t> values;
+        for (auto& batch : batches) {
+            auto data = batch->at(name)->template data<int64_t>();
+            values.insert(values.end(), data.begin(), data.end());
+        }
+        return values;
+    };
+
+    soma_dataframe->set_value_filter(ValueFilter::in_set(
+        "a0", std::vector<int64_t>{20, 50, 90, 1000}));
+    auto batches = soma_dataframe->read_late_materialized(
+        {"soma_joinid", "a1"});
+    REQUIRE(batches.size() >= 1);
+    REQUIRE(
+        batches[0]->names() == std::vector<std::string>({"soma_joinid", "a1"}));
+    REQUIRE(
+        read_column(batches, "soma_joinid") ==
+        std::vector<int64_t>({2, 5, 9}));
+    REQUIRE(read_column(batches, "a1") == std::vector<int64_t>({2, 5, 9}));
+
+    // Ranges set on the array apply to the first phase
+    soma_dataframe->reset();
+    soma_dataframe->set_dim_ranges<int64_t>(
+        "soma_joinid", std::vector<std::pair<int64_t, int64_t>>{{0, 5}});
+    soma_dataframe->set_value_filter(
+        ValueFilter::in_set("a0", std::vector<int64_t>{20, 50, 90}));
+    batches = soma_dataframe->read_late_materialized();
+    REQUIRE(read_column(batches, "a0") == std::vector<int64_t>({20, 50}));
+
+    // The column selection of the array's query is kept, and the query
+    // itself is not consumed
+    soma_dataframe->reset({"a1"});
+    soma_dataframe->set_value_filter(
+        ValueFilter::in_set("a0", std::vector<int64_t>{20, 50, 90}));
+    batches = soma_dataframe->read_late_materialized({"a0"});
+    REQUIRE(read_column(batches, "a0") == std::vector<int64_t>({20, 50, 90}));
+    std::vector<std::shared_ptr<ArrayBuffers>> direct;
+    while (auto batch = soma_dataframe->read_next()) {
+        REQUIRE((*batch)->names() == std::vector<std::string>({"a1"}));
+        direct.push_back(*batch);
+    }
+    REQUIRE(read_column(direct, "a1") == std::vector<int64_t>({2, 5, 9}));
+
+    // No matching rows
+    soma_dataframe->reset();
+    soma_dataframe->set_value_filter(
+        ValueFilter::in_set("a0", std::vector<int64_t>{-1}));
+    batches = soma_dataframe->read_late_materialized({"a1"});
+    REQUIRE(read_column(batches, "a1").empty());
+    soma_dataframe->close();
+}
+
+TEST_CASE("SOMADataFrame: late materialization of many runs") {
+    int64_t dim_max = 100000;
+    auto ctx = std::make_shared<SOMAContext>();
+    std::string uri = "mem://unit-test-dataframe-late-materialization-runs";
+
+    std::vector<helper::DimInfo> dim_infos(
+        {{.name = "soma_joinid",
+          .tiledb_datatype = TILEDB_INT64,
+          .dim_max = dim_max,
+          .use_current_domain = false}});
+
+    std::vector<helper::AttrInfo> attr_infos(
+        {{.name = "a0", .tiledb_datatype = TILEDB_INT64}});
+
+    auto [schema, index_columns] =
+        helper::create_arrow_schema_and_index_columns(dim_infos, attr_infos);
+
+    SOMADataFrame::create(
+        uri,
+        std::move(schema),
+        ArrowTable(
+            std::move(index_columns.first), std::move(index_columns.second)),
+        ctx);
+
+    // Every other row matches, so the 8192 matching rows form more runs
+    // than the 4096 ranges the second phase selects, and it filters merged
+    // ranges instead
+    int64_t num_rows = 1 << 14;
+    std::vector<int64_t> joinids(num_rows), a0(num_rows), expected;
+    for (int64_t j = 0; j < num_rows; j++) {
+        joinids[j] = j;
+        a0[j] = 3 * j;
+        if (j % 2 == 0) {
+            expected.push_back(3 * j);
+        }
+    }
+
+    auto soma_dataframe = SOMADataFrame::open(uri, OpenMode::write, ctx);
+    soma_dataframe->set_column_data("a0", a0.size(), a0.data());
+    soma_dataframe->set_column_data(
+        "soma_joinid", joinids.size(), joinids.data());
+    soma_dataframe->write();
+    soma_dataframe->close();
+
+    soma_dataframe = SOMADataFrame::open(uri, OpenMode::read, ctx);
+    soma_dataframe->set_value_filter(ValueFilter::in_set("a0", expected));
+
+    // soma_joinid is not requested: it is read to filter the merged ranges,
+    // but not returned
+    auto batches = soma_dataframe->read_late_materialized({"a0"});
+    std::vector<int64_t> values;
+    for (auto& batch : batches) {
+        REQUIRE(batch->names() == std::vector<std::string>({"a0"}));
+        auto data = batch->at("a0")->data<int64_t>();
+        values.insert(values.end(), data.begin(), data.end());
+    }
+    REQUIRE(values == expected);
+    soma_dataframe->close();
+}
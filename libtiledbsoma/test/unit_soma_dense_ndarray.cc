@@ -285,3 +285,65 @@ TEST_CASE("SOMADenseNDArray: metadata") {
         REQUIRE(soma_dense->metadata_num() == 2);
     }
 }
+
+TEST_CASE("SOMADenseNDArray: read_into") {
+    int64_t dim_max = 9;
+    auto ctx = std::make_shared<SOMAContext>();
+    std::string uri = "mem://unit-test-dense-ndarray-read-into";
+    tiledb_datatype_t tiledb_datatype = TILEDB_INT32;
+    std::string arrow_format = helper::to_arrow_format(tiledb_datatype);
+
+    std::vector<helper::DimInfo> dim_infos(
+        {{.name = "soma_dim_0",
+          .tiledb_datatype = TILEDB_INT64,
+          .dim_max = dim_max,
+          .use_current_domain = false},
+         {.name = "soma_dim_1",
+          .tiledb_datatype = TILEDB_INT64,
+          .dim_max = dim_max,
+          .use_current_domain = false}});
+
+    auto index_columns = helper::create_column_index_info(dim_infos);
+
+    SOMADenseNDArray::create(
+        uri,
+        arrow_format,
+        ArrowTable(
+            std::move(index_columns.first), std::move(index_columns.second)),
+        ctx);
+
+    // Rows 0-2 and columns 0-3 hold 0, 1, ..., 11 in row-major order
+    std::vector<int64_t> d0{0, 2};
+    std::vector<int64_t> d1{0, 3};
+    std::vector<int32_t> a0(12);
+    std::iota(a0.begin(), a0.end(), 0);
+
+    auto soma_dense = SOMADenseNDArray::open(uri, OpenMode::write, ctx);
+    soma_dense->set_column_data("soma_data", a0.size(), a0.data());
+    soma_dense->set_column_data("soma_dim_0", d0.size(), d0.data());
+    soma_dense->set_column_data("soma_dim_1", d1.size(), d1.data());
+    soma_dense->write();
+    soma_dense->close();
+
+    soma_dense = SOMADenseNDArray::open(uri, OpenMode::read, ctx);
+    std::vector<std::pair<int64_t, int64_t>> ranges{{1, 2}, {1, 3}};
+    std::vector<int32_t> out(6);
+    size_t nbytes = out.size() * sizeof(int32_t);
+
+    soma_dense->read_into(ranges, out.data(), nbytes, {12, 4});
+    REQUIRE(out == std::vector<int32_t>({5, 6, 7, 9, 10, 11}));
+
+    soma_dense->read_into(ranges, out.data(), nbytes, {4, 8});
+    REQUIRE(out == std::vector<int32_t>({5, 9, 6, 10, 7, 11}));
+
+    // Not contiguous
+    REQUIRE_THROWS_AS(
+        soma_dense->read_into(ranges, out.data(), nbytes, {8, 8}),
+        TileDBSOMAError);
+
+    // Too small
+    REQUIRE_THROWS_AS(
+        soma_dense->read_into(ranges, out.data(), nbytes - 1, {12, 4}),
+        TileDBSOMAError);
+    soma_dense->close();
+}
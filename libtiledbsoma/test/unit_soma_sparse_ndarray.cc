@@ -30,9 +30,60 @@
  * This file manages unit tests for the SOMASparseNDArray class
  */
 
+#include <reindexer/reindexer.h>
 #include "common.h"
 #define DIM_MAX 1000
 
+namespace {
+
+// Create a sparse array of `tiledb_datatype` values, with `ndim` int64
+// dimensions soma_dim_0, soma_dim_1, ... of domain [0, dim_max]
+void create_array(
+    const std::string& uri,
+    std::shared_ptr<SOMAContext> ctx,
+    tiledb_datatype_t tiledb_datatype,
+    size_t ndim = 1,
+    int64_t dim_max = 100) {
+    std::vector<helper::DimInfo> dim_infos;
+    for (size_t i = 0; i < ndim; i++) {
+        dim_infos.push_back(
+            {.name = "soma_dim_" + std::to_string(i),
+             .tiledb_datatype = TILEDB_INT64,
+             .dim_max = dim_max,
+             .use_current_domain = false});
+    }
+
+    auto index_columns = helper::create_column_index_info(dim_infos);
+
+    SOMASparseNDArray::create(
+        uri,
+        helper::to_arrow_format(tiledb_datatype),
+        ArrowTable(
+            std::move(index_columns.first), std::move(index_columns.second)),
+        ctx);
+}
+
+// Write `data` at `coords`, which hold the coordinates of each dimension
+template <typename T>
+void write_array(
+    const std::string& uri,
+    std::shared_ptr<SOMAContext> ctx,
+    const std::vector<T>& data,
+    const std::vector<std::vector<int64_t>>& coords) {
+    auto soma_sparse = SOMASparseNDArray::open(uri, OpenMode::write, ctx);
+    soma_sparse->set_column_data("soma_data", data.size(), data.data());
+    for (size_t i = 0; i < coords.size(); i++) {
+        soma_sparse->set_column_data(
+            "soma_dim_" + std::to_string(i),
+            coords[i].size(),
+            coords[i].data());
+    }
+    soma_sparse->write();
+    soma_sparse->close();
+}
+
+}  // namespace
+
 TEST_CASE("SOMASparseNDArray: basic") {
     int64_t dim_max = 1000;
     auto use_current_domain = GENERATE(false, true);
@@ -261,3 +312,656 @@ TEST_CASE("SOMASparseNDArray: metadata") {
         REQUIRE(soma_sparse->metadata_num() == 2);
     }
 }
+
+TEST_CASE("SOMASparseNDArray: read with dimension indexer") {
+    auto ctx = std::make_shared<SOMAContext>();
+    std::string uri = "mem://unit-test-sparse-ndarray-dim-indexer";
+    std::string dim_name = "soma_dim_0";
+
+    create_array(uri, ctx, TILEDB_INT64);
+
+    std::vector<int64_t> d0({10, 20, 30, 40, 50});
+    std::vector<int> a0({1, 2, 3, 4, 5});
+
+    write_array(uri, ctx, a0, {d0});
+
+    // 30 is intentionally missing from the indexer
+    std::vector<int64_t> keys({50, 40, 20, 10});
+    auto indexer = std::make_shared<IntIndexer>();
+    indexer->map_locations(keys);
+
+    auto soma_sparse = SOMASparseNDArray::open(uri, OpenMode::read, ctx);
+    REQUIRE_THROWS_AS(
+        soma_sparse->set_dim_indexer("nonesuch", indexer), TileDBSOMAError);
+
+    // An indexer without mapped keys is rejected rather than looked up
+    REQUIRE_THROWS_AS(
+        soma_sparse->set_dim_indexer(
+            dim_name, std::make_shared<IntIndexer>()),
+        TileDBSOMAError);
+    soma_sparse->set_dim_indexer(dim_name, indexer);
+
+    std::vector<int64_t> expected({3, 2, -1, 1, 0});
+    while (auto batch = soma_sparse->read_next()) {
+        auto arrbuf = batch.value();
+        auto d0span = arrbuf->at(dim_name)->data<int64_t>();
+        auto a0span = arrbuf->at("soma_data")->data<int>();
+        REQUIRE(
+            expected == std::vector<int64_t>(d0span.begin(), d0span.end()));
+        REQUIRE(a0 == std::vector<int>(a0span.begin(), a0span.end()));
+    }
+    soma_sparse->close();
+}
+
+TEST_CASE("SOMASparseNDArray: read points coalesced into ranges") {
+    auto ctx = std::make_shared<SOMAContext>();
+    std::string uri = "mem://unit-test-sparse-ndarray-coalesce-points";
+    std::string dim_name = "soma_dim_0";
+
+    create_array(uri, ctx, TILEDB_INT64);
+
+    std::vector<int64_t> d0(100);
+    std::vector<int> a0(100);
+    for (int j = 0; j < 100; j++) {
+        d0[j] = j;
+        a0[j] = j * 10;
+    }
+
+    write_array(uri, ctx, a0, {d0});
+
+    // Unsorted, with duplicates, and with gaps between the runs
+    std::vector<int64_t> points({42, 3, 4, 5, 5, 40, 41, 90, 3, 60});
+    std::vector<int64_t> expected({3, 4, 5, 40, 41, 42, 60, 90});
+
+    auto max_ranges = GENERATE(0, 1, 2);
+    std::ostringstream section;
+    section << "- max_ranges=" << max_ranges;
+    SECTION(section.str()) {
+        auto soma_sparse = SOMASparseNDArray::open(uri, OpenMode::read, ctx);
+        soma_sparse->set_max_ranges(max_ranges);
+        soma_sparse->set_dim_points(dim_name, points);
+
+        std::vector<int64_t> d0_read;
+        std::vector<int> a0_read;
+        while (auto batch = soma_sparse->read_next()) {
+            auto arrbuf = batch.value();
+            auto d0span = arrbuf->at(dim_name)->data<int64_t>();
+            auto a0span = arrbuf->at("soma_data")->data<int>();
+            d0_read.insert(d0_read.end(), d0span.begin(), d0span.end());
+            a0_read.insert(a0_read.end(), a0span.begin(), a0span.end());
+        }
+        REQUIRE(d0_read == expected);
+        for (size_t i = 0; i < d0_read.size(); i++) {
+            REQUIRE(a0_read[i] == d0_read[i] * 10);
+        }
+        soma_sparse->close();
+    }
+}
+
+TEST_CASE("SOMASparseNDArray: filter merged point ranges") {
+    auto ctx = std::make_shared<SOMAContext>();
+    std::string uri = "mem://unit-test-sparse-ndarray-merged-ranges";
+    std::string dim_name = "soma_dim_0";
+
+    create_array(uri, ctx, TILEDB_INT64);
+
+    std::vector<int64_t> d0(100);
+    std::vector<int> a0(100);
+    for (int j = 0; j < 100; j++) {
+        d0[j] = j;
+        a0[j] = j * 10;
+    }
+
+    write_array(uri, ctx, a0, {d0});
+    auto soma_sparse = SOMASparseNDArray::open(uri, OpenMode::read, ctx);
+
+    auto read_data = [&]() {
+        std::vector<int> a0_read;
+        while (auto batch = soma_sparse->read_next()) {
+            auto arrbuf = batch.value();
+            REQUIRE(!arrbuf->contains(dim_name));
+            auto a0span = arrbuf->at("soma_data")->data<int>();
+            a0_read.insert(a0_read.end(), a0span.begin(), a0span.end());
+        }
+        return a0_read;
+    };
+
+    soma_sparse->set_max_ranges(1);
+
+    SECTION("dimension not selected") {
+        soma_sparse->set_dim_points(dim_name, std::vector<int64_t>({3, 50}));
+        soma_sparse->select_columns({"soma_data"});
+        REQUIRE(read_data() == std::vector<int>({30, 500}));
+    }
+
+    SECTION("values projection") {
+        soma_sparse->set_dim_points(dim_name, std::vector<int64_t>({3, 50}));
+        soma_sparse->set_projection(Projection::values);
+        REQUIRE(read_data() == std::vector<int>({30, 500}));
+    }
+
+    SECTION("limit set after a selection") {
+        soma_sparse->set_dim_point<int64_t>(dim_name, 1);
+        REQUIRE_THROWS_AS(soma_sparse->set_max_ranges(2), TileDBSOMAError);
+    }
+
+    SECTION("repeated selections") {
+        // Every selection on the dimension is kept by the filter of the
+        // merged ranges, whichever call merged them
+        soma_sparse->set_dim_point<int64_t>(dim_name, 1);
+        soma_sparse->set_dim_points(dim_name, std::vector<int64_t>({3, 50}));
+        soma_sparse->set_dim_points(dim_name, std::vector<int64_t>({60, 70}));
+        soma_sparse->set_dim_ranges<int64_t>(dim_name, {{80, 81}});
+        soma_sparse->select_columns({"soma_data"});
+        REQUIRE(
+            read_data() ==
+            std::vector<int>({10, 30, 500, 600, 700, 800, 810}));
+    }
+    soma_sparse->close();
+}
+
+TEST_CASE("SOMASparseNDArray: aggregate") {
+    auto ctx = std::make_shared<SOMAContext>();
+    std::string uri = "mem://unit-test-sparse-ndarray-aggregate";
+
+    create_array(uri, ctx, TILEDB_FLOAT64, 2);
+
+    // Row 0 holds 1, 2, 3; row 5 holds 10
+    std::vector<int64_t> d0({0, 0, 0, 5});
+    std::vector<int64_t> d1({1, 2, 3, 4});
+    std::vector<double> a0({1, 2, 3, 10});
+
+    write_array(uri, ctx, a0, {d0, d1});
+
+    auto soma_sparse = SOMASparseNDArray::open(uri, OpenMode::read, ctx);
+
+    auto aggregate = [&](AggregateOp op,
+                         std::optional<std::string> group_by = std::nullopt) {
+        soma_sparse->reset();
+        return soma_sparse->aggregate("soma_data", op, group_by);
+    };
+
+    REQUIRE(
+        aggregate(AggregateOp::count)->at("count")->data<uint64_t>()[0] == 4);
+    REQUIRE(aggregate(AggregateOp::sum)->at("sum")->data<double>()[0] == 16);
+    REQUIRE(aggregate(AggregateOp::mean)->at("mean")->data<double>()[0] == 4);
+    REQUIRE(aggregate(AggregateOp::min)->at("min")->data<double>()[0] == 1);
+    REQUIRE(aggregate(AggregateOp::max)->at("max")->data<double>()[0] == 10);
+
+    auto by_row = aggregate(AggregateOp::sum, "soma_dim_0");
+    auto rows = by_row->at("soma_dim_0")->data<int64_t>();
+    auto sums = by_row->at("sum")->data<double>();
+    REQUIRE(
+        std::vector<int64_t>(rows.begin(), rows.end()) ==
+        std::vector<int64_t>({0, 5}));
+    REQUIRE(
+        std::vector<double>(sums.begin(), sums.end()) ==
+        std::vector<double>({6, 10}));
+
+    auto by_col = aggregate(AggregateOp::count, "soma_dim_1");
+    auto counts = by_col->at("count")->data<uint64_t>();
+    REQUIRE(by_col->num_rows() == 4);
+    REQUIRE(std::all_of(counts.begin(), counts.end(), [](uint64_t c) {
+        return c == 1;
+    }));
+
+    // An empty selection has no min
+    soma_sparse->reset();
+    soma_sparse->set_dim_points<int64_t>("soma_dim_0", std::vector<int64_t>{3});
+    auto empty = soma_sparse->aggregate("soma_data", AggregateOp::min);
+    REQUIRE(empty->at("min")->validity()[0] == 0);
+
+    REQUIRE_THROWS_AS(aggregate(AggregateOp::sum, "nonesuch"), TileDBSOMAError);
+    soma_sparse->close();
+}
+
+TEST_CASE("SOMASparseNDArray: aggregate narrow types") {
+    // Pushed-down results narrower than 8 bytes
+    auto ctx = std::make_shared<SOMAContext>();
+    std::string uri = "mem://unit-test-sparse-ndarray-aggregate-narrow";
+
+    create_array(uri, ctx, TILEDB_INT16);
+
+    std::vector<int64_t> d0({0, 1, 2});
+    std::vector<int16_t> a0({-300, 5, 7});
+
+    write_array(uri, ctx, a0, {d0});
+
+    auto soma_sparse = SOMASparseNDArray::open(uri, OpenMode::read, ctx);
+    auto aggregate = [&](AggregateOp op) {
+        soma_sparse->reset();
+        return soma_sparse->aggregate("soma_data", op);
+    };
+
+    auto min = aggregate(AggregateOp::min)->at("min");
+    REQUIRE(min->type() == TILEDB_INT16);
+    REQUIRE(min->data<int16_t>()[0] == -300);
+    REQUIRE(aggregate(AggregateOp::max)->at("max")->data<int16_t>()[0] == 7);
+    REQUIRE(aggregate(AggregateOp::sum)->at("sum")->data<int64_t>()[0] == -288);
+    soma_sparse->close();
+}
+
+TEST_CASE("SOMASparseNDArray: aggregate scan") {
+    auto ctx = std::make_shared<SOMAContext>();
+    std::string uri = "mem://unit-test-sparse-ndarray-aggregate-scan";
+
+    create_array(uri, ctx, TILEDB_INT64, 2);
+
+    // The sum of row 0 overflows int64
+    int64_t big = std::numeric_limits<int64_t>::max();
+    std::vector<int64_t> d0({0, 0, 0, 5});
+    std::vector<int64_t> d1({1, 2, 3, 4});
+    std::vector<int64_t> a0({big, 1, 2, 10});
+
+    write_array(uri, ctx, a0, {d0, d1});
+
+    auto soma_sparse = SOMASparseNDArray::open(uri, OpenMode::read, ctx);
+
+    // The sum saturates the same way whether it is pushed down or scanned
+    soma_sparse->reset();
+    auto pushed = soma_sparse->aggregate("soma_data", AggregateOp::sum);
+    REQUIRE(pushed->at("sum")->data<int64_t>()[0] == big);
+
+    // A limit forces the scan. Neither the column selection nor the
+    // indexer applies to it, and both are left in place.
+    auto indexer = std::make_shared<IntIndexer>();
+    indexer->map_locations(std::vector<int64_t>({5, 0}));
+    soma_sparse->reset({"soma_dim_0"});
+    soma_sparse->set_dim_indexer("soma_dim_0", indexer);
+    soma_sparse->set_limit(100);
+    auto scanned = soma_sparse->aggregate(
+        "soma_data", AggregateOp::sum, "soma_dim_0");
+    auto rows = scanned->at("soma_dim_0")->data<int64_t>();
+    auto sums = scanned->at("sum")->data<int64_t>();
+    REQUIRE(
+        std::vector<int64_t>(rows.begin(), rows.end()) ==
+        std::vector<int64_t>({0, 5}));
+    REQUIRE(
+        std::vector<int64_t>(sums.begin(), sums.end()) ==
+        std::vector<int64_t>({big, 10}));
+    std::vector<std::string> selected({"soma_dim_0"});
+    REQUIRE(soma_sparse->column_names() == selected);
+
+    // Means do not saturate
+    soma_sparse->reset();
+    soma_sparse->set_limit(100);
+    auto mean = soma_sparse->aggregate("soma_data", AggregateOp::mean);
+    REQUIRE(
+        mean->at("mean")->data<double>()[0] ==
+        (static_cast<double>(big) + 13) / 4);
+    soma_sparse->close();
+}
+
+TEST_CASE("SOMASparseNDArray: reduce_by_dim") {
+    int64_t dim_max = int64_t(1) << 40;
+    auto ctx = std::make_shared<SOMAContext>();
+    std::string uri = "mem://unit-test-sparse-ndarray-reduce-by-dim";
+
+    create_array(uri, ctx, TILEDB_INT32, 2, dim_max);
+
+    // Row 0 holds 1, 2, 3; row 2^36 holds 10
+    int64_t far = int64_t(1) << 36;
+    std::vector<int64_t> d0({0, 0, 0, far});
+    std::vector<int64_t> d1({1, 2, 3, 4});
+    std::vector<int32_t> a0({1, 2, 3, 10});
+
+    write_array(uri, ctx, a0, {d0, d1});
+
+    auto soma_sparse = SOMASparseNDArray::open(uri, OpenMode::read, ctx);
+
+    auto to_vector = [](auto span) {
+        return std::vector<typename decltype(span)::value_type>(
+            span.begin(), span.end());
+    };
+
+    // Without an indexer, one row per coordinate holding values. The rows
+    // span a sparse domain, reduced in hash maps.
+    auto by_row = soma_sparse->reduce_by_dim("soma_dim_0");
+    REQUIRE(by_row->num_rows() == 2);
+    REQUIRE(by_row->at("sum")->type() == TILEDB_INT64);
+    REQUIRE(
+        to_vector(by_row->at("soma_dim_0")->data<int64_t>()) ==
+        std::vector<int64_t>({0, far}));
+    REQUIRE(
+        to_vector(by_row->at("sum")->data<int64_t>()) ==
+        std::vector<int64_t>({6, 10}));
+    REQUIRE(
+        to_vector(by_row->at("count")->data<int64_t>()) ==
+        std::vector<int64_t>({3, 1}));
+
+    // The columns span a dense domain, reduced in vectors
+    auto by_dense_col = soma_sparse->reduce_by_dim("soma_dim_1");
+    REQUIRE(
+        to_vector(by_dense_col->at("soma_dim_1")->data<int64_t>()) ==
+        std::vector<int64_t>({1, 2, 3, 4}));
+    REQUIRE(
+        to_vector(by_dense_col->at("sum")->data<int64_t>()) ==
+        std::vector<int64_t>({1, 2, 3, 10}));
+
+    // With an indexer, positions are indexer positions and unmapped
+    // coordinates are skipped
+    auto indexer = std::make_shared<IntIndexer>();
+    indexer->map_locations(std::vector<int64_t>({4, 9}));
+    auto by_col = soma_sparse->reduce_by_dim("soma_dim_1", indexer);
+    REQUIRE(
+        to_vector(by_col->at("sum")->data<int64_t>()) ==
+        std::vector<int64_t>({10, 0}));
+    REQUIRE(
+        to_vector(by_col->at("count")->data<int64_t>()) ==
+        std::vector<int64_t>({1, 0}));
+
+    REQUIRE_THROWS_AS(soma_sparse->reduce_by_dim("soma_data"), TileDBSOMAError);
+    soma_sparse->close();
+}
+
+TEST_CASE("SOMASparseNDArray: projection") {
+    auto ctx = std::make_shared<SOMAContext>();
+    std::string uri = "mem://unit-test-sparse-ndarray-projection";
+
+    create_array(uri, ctx, TILEDB_INT32, 2);
+
+    std::vector<int64_t> d0({0, 0, 0, 5});
+    std::vector<int64_t> d1({1, 2, 3, 4});
+    std::vector<int32_t> a0({1, 2, 3, 10});
+
+    write_array(uri, ctx, a0, {d0, d1});
+
+    auto soma_sparse = SOMASparseNDArray::open(uri, OpenMode::read, ctx);
+
+    soma_sparse->set_projection(Projection::values);
+    auto batch = soma_sparse->read_next();
+    REQUIRE(batch.has_value());
+    REQUIRE((*batch)->names() == std::vector<std::string>({"soma_data"}));
+    REQUIRE((*batch)->num_rows() == a0.size());
+
+    soma_sparse->reset();
+    soma_sparse->set_projection(Projection::coordinates);
+    batch = soma_sparse->read_next();
+    REQUIRE(batch.has_value());
+    REQUIRE(
+        (*batch)->names() ==
+        std::vector<std::string>({"soma_dim_0", "soma_dim_1"}));
+    REQUIRE((*batch)->num_rows() == a0.size());
+
+    // Counts come back as a single batch
+    soma_sparse->reset();
+    soma_sparse->set_projection(Projection::count);
+    batch = soma_sparse->read_next();
+    REQUIRE(batch.has_value());
+    REQUIRE((*batch)->names() == std::vector<std::string>({"count"}));
+    REQUIRE((*batch)->at("count")->data<uint64_t>()[0] == a0.size());
+    REQUIRE(!soma_sparse->read_next().has_value());
+
+    soma_sparse->reset();
+    soma_sparse->set_projection(Projection::count);
+    soma_sparse->set_dim_points<int64_t>("soma_dim_0", std::vector<int64_t>{0});
+    batch = soma_sparse->read_next();
+    REQUIRE((*batch)->at("count")->data<uint64_t>()[0] == 3);
+
+    // Explicitly selected columns take precedence over the projection
+    soma_sparse->reset({"soma_dim_1"});
+    soma_sparse->set_projection(Projection::values);
+    batch = soma_sparse->read_next();
+    REQUIRE((*batch)->names() == std::vector<std::string>({"soma_dim_1"}));
+
+    // Including over a count
+    soma_sparse->reset({"soma_data"});
+    soma_sparse->set_projection(Projection::count);
+    batch = soma_sparse->read_next();
+    REQUIRE(batch.has_value());
+    REQUIRE((*batch)->names() == std::vector<std::string>({"soma_data"}));
+    REQUIRE((*batch)->num_rows() == a0.size());
+    soma_sparse->close();
+}
+
+TEST_CASE("SOMASparseNDArray: value filter") {
+    auto ctx = std::make_shared<SOMAContext>();
+    std::string uri = "mem://unit-test-sparse-ndarray-value-filter";
+
+    create_array(uri, ctx, TILEDB_INT32, 2);
+
+    std::vector<int64_t> d0({0, 0, 0, 5});
+    std::vector<int64_t> d1({1, 2, 3, 4});
+    std::vector<int32_t> a0({1, 2, 3, 10});
+
+    write_array(uri, ctx, a0, {d0, d1});
+
+    auto soma_sparse = SOMASparseNDArray::open(uri, OpenMode::read, ctx);
+
+    auto read_data = [&]() {
+        std::vector<int32_t> values;
+        while (auto batch = soma_sparse->read_next()) {
+            auto data = (*batch)->at("soma_data")->data<int32_t>();
+            values.insert(values.end(), data.begin(), data.end());
+        }
+        return values;
+    };
+
+    // soma_data * 2 > soma_dim_1 + 1
+    auto arithmetic = ValueFilter::compare(
+        CompareOp::gt,
+        ValueExpr::arithmetic(
+            ArithmeticOp::mul,
+            ValueExpr::column("soma_data"),
+            ValueExpr::literal(2)),
+        ValueExpr::arithmetic(
+            ArithmeticOp::add,
+            ValueExpr::column("soma_dim_1"),
+            ValueExpr::literal(1)));
+    soma_sparse->set_value_filter(arithmetic);
+    REQUIRE(read_data() == std::vector<int32_t>({2, 3, 10}));
+
+    soma_sparse->reset();
+    soma_sparse->set_value_filter(ValueFilter::any_of(
+        {ValueFilter::in_set("soma_dim_1", std::vector<int64_t>{2, 4}),
+         ValueFilter::negate(arithmetic)}));
+    REQUIRE(read_data() == std::vector<int32_t>({1, 2, 10}));
+
+    // Counts read the filtered columns
+    soma_sparse->reset();
+    soma_sparse->set_projection(Projection::count);
+    soma_sparse->set_value_filter(arithmetic);
+    auto batch = soma_sparse->read_next();
+    REQUIRE((*batch)->at("count")->data<uint64_t>()[0] == 3);
+
+    // The filtered columns are read without being selected, and left out
+    // of the results
+    soma_sparse->reset({"soma_dim_0"});
+    soma_sparse->set_value_filter(arithmetic);
+    std::vector<int64_t> rows;
+    while (auto batch = soma_sparse->read_next()) {
+        REQUIRE((*batch)->names() == std::vector<std::string>({"soma_dim_0"}));
+        auto data = (*batch)->at("soma_dim_0")->data<int64_t>();
+        rows.insert(rows.end(), data.begin(), data.end());
+    }
+    REQUIRE(rows == std::vector<int64_t>({0, 0, 5}));
+
+    // Set membership only applies to integral columns here
+    soma_sparse->reset();
+    soma_sparse->set_value_filter(
+        ValueFilter::in_set("soma_data", std::vector<std::string>{"a"}));
+    REQUIRE_THROWS_AS(soma_sparse->read_next(), TileDBSOMAError);
+    soma_sparse->close();
+}
+
+TEST_CASE("SOMASparseNDArray: value filter on large integers") {
+    auto ctx = std::make_shared<SOMAContext>();
+    std::string uri = "mem://unit-test-sparse-ndarray-value-filter-int64";
+
+    create_array(uri, ctx, TILEDB_INT64);
+
+    // Consecutive values above 2^53, which doubles cannot tell apart
+    int64_t base = int64_t{1} << 53;
+    std::vector<int64_t> d0({0, 1, 2});
+    std::vector<int64_t> a0({base, base + 1, base + 2});
+
+    write_array(uri, ctx, a0, {d0});
+
+    auto soma_sparse = SOMASparseNDArray::open(uri, OpenMode::read, ctx);
+
+    auto read_data = [&](std::shared_ptr<ValueFilter> filter) {
+        soma_sparse->reset();
+        soma_sparse->set_value_filter(filter);
+        std::vector<int64_t> values;
+        while (auto batch = soma_sparse->read_next()) {
+            auto data = (*batch)->at("soma_data")->data<int64_t>();
+            values.insert(values.end(), data.begin(), data.end());
+        }
+        return values;
+    };
+
+    auto soma_data = ValueExpr::column("soma_data");
+    REQUIRE(
+        read_data(ValueFilter::compare(
+            CompareOp::eq, soma_data, ValueExpr::literal(base + 1))) ==
+        std::vector<int64_t>({base + 1}));
+    REQUIRE(
+        read_data(ValueFilter::compare(
+            CompareOp::gt, soma_data, ValueExpr::literal(base))) ==
+        std::vector<int64_t>({base + 1, base + 2}));
+
+    // Integer arithmetic stays exact
+    REQUIRE(
+        read_data(ValueFilter::compare(
+            CompareOp::eq,
+            ValueExpr::arithmetic(
+                ArithmeticOp::sub, soma_data, ValueExpr::literal(2)),
+            ValueExpr::literal(base))) == std::vector<int64_t>({base + 2}));
+
+    // Unsigned constants compare by value against signed columns
+    REQUIRE(
+        read_data(ValueFilter::compare(
+            CompareOp::lt,
+            soma_data,
+            ValueExpr::literal(std::numeric_limits<uint64_t>::max()))) ==
+        a0);
+
+    // Ranking is exact too: as doubles, base and base + 1 would tie
+    soma_sparse->reset();
+    auto top = soma_sparse->read_top_k("soma_data", 2, true);
+    auto top_data = top->at("soma_data")->data<int64_t>();
+    REQUIRE(
+        std::vector<int64_t>(top_data.begin(), top_data.end()) ==
+        std::vector<int64_t>({base + 2, base + 1}));
+    soma_sparse->close();
+}
+
+TEST_CASE("SOMASparseNDArray: compressed matrix") {
+    auto ctx = std::make_shared<SOMAContext>();
+    std::string uri = "mem://unit-test-sparse-ndarray-compressed-matrix";
+
+    create_array(uri, ctx, TILEDB_INT32, 2);
+
+    std::vector<int64_t> d0({0, 0, 0, 5});
+    std::vector<int64_t> d1({1, 2, 3, 4});
+    std::vector<int32_t> a0({1, 2, 3, 10});
+
+    write_array(uri, ctx, a0, {d0, d1});
+
+    auto soma_sparse = SOMASparseNDArray::open(uri, OpenMode::read, ctx);
+
+    auto to_vector = [](tcb::span<std::byte> bytes) {
+        auto data = (const int32_t*)bytes.data();
+        return std::vector<int32_t>(
+            data, data + bytes.size() / sizeof(int32_t));
+    };
+
+    // CSR, positions are coordinates
+    auto csr = soma_sparse->read_compressed_matrix(
+        "soma_dim_0", "soma_dim_1", "soma_data", 6, 5);
+    REQUIRE(csr->nnz() == 4);
+    REQUIRE(csr->index_type() == TILEDB_INT32);
+    REQUIRE(csr->data_type() == TILEDB_INT32);
+    REQUIRE(
+        to_vector(csr->indptr()) ==
+        std::vector<int32_t>({0, 3, 3, 3, 3, 3, 4}));
+    REQUIRE(to_vector(csr->indices()) == std::vector<int32_t>({1, 2, 3, 4}));
+    REQUIRE(to_vector(csr->data()) == std::vector<int32_t>({1, 2, 3, 10}));
+
+    // CSC
+    soma_sparse->reset();
+    auto csc = soma_sparse->read_compressed_matrix(
+        "soma_dim_1", "soma_dim_0", "soma_data", 5, 6);
+    REQUIRE(
+        to_vector(csc->indptr()) == std::vector<int32_t>({0, 0, 1, 2, 3, 4}));
+    REQUIRE(to_vector(csc->indices()) == std::vector<int32_t>({0, 0, 0, 5}));
+    REQUIRE(to_vector(csc->data()) == std::vector<int32_t>({1, 2, 3, 10}));
+
+    // With indexers, the minor indices of a row are sorted after reindexing
+    auto rows = std::make_shared<IntIndexer>();
+    rows->map_locations(std::vector<int64_t>({5, 0}));
+    auto cols = std::make_shared<IntIndexer>();
+    cols->map_locations(std::vector<int64_t>({4, 3, 2, 1}));
+    soma_sparse->reset();
+    auto reindexed = soma_sparse->read_compressed_matrix(
+        "soma_dim_0", "soma_dim_1", "soma_data", 2, 4, rows, cols);
+    REQUIRE(to_vector(reindexed->indptr()) == std::vector<int32_t>({0, 1, 4}));
+    REQUIRE(
+        to_vector(reindexed->indices()) == std::vector<int32_t>({0, 1, 2, 3}));
+    REQUIRE(
+        to_vector(reindexed->data()) == std::vector<int32_t>({10, 3, 2, 1}));
+
+    // Coordinates must fall within the extents
+    soma_sparse->reset();
+    REQUIRE_THROWS_AS(
+        soma_sparse->read_compressed_matrix(
+            "soma_dim_0", "soma_dim_1", "soma_data", 3, 5),
+        TileDBSOMAError);
+
+    // The query must not have been read already
+    REQUIRE_THROWS_AS(
+        soma_sparse->read_compressed_matrix(
+            "soma_dim_0", "soma_dim_1", "soma_data", 6, 5),
+        TileDBSOMAError);
+    soma_sparse->close();
+}
+
+TEST_CASE("SOMASparseNDArray: COO tensor") {
+    auto ctx = std::make_shared<SOMAContext>();
+    std::string uri = "mem://unit-test-sparse-ndarray-coo-tensor";
+
+    create_array(uri, ctx, TILEDB_INT32, 2);
+
+    std::vector<int64_t> d0({0, 0, 0, 5});
+    std::vector<int64_t> d1({1, 2, 3, 4});
+    std::vector<int32_t> a0({1, 2, 3, 10});
+
+    write_array(uri, ctx, a0, {d0, d1});
+
+    auto soma_sparse = SOMASparseNDArray::open(uri, OpenMode::read, ctx);
+    std::vector<std::string> dims({"soma_dim_0", "soma_dim_1"});
+
+    // Coordinates are interleaved row by row
+    auto tensor = soma_sparse->read_next_coo_tensor(dims, "soma_data");
+    REQUIRE(tensor.has_value());
+    REQUIRE((*tensor)->nnz() == 4);
+    REQUIRE((*tensor)->ndim() == 2);
+    REQUIRE((*tensor)->data_type() == TILEDB_INT32);
+    auto coords = (*tensor)->coords();
+    REQUIRE(
+        std::vector<int64_t>(coords.begin(), coords.end()) ==
+        std::vector<int64_t>({0, 1, 0, 2, 0, 3, 5, 4}));
+    auto data = (*tensor)->data();
+    REQUIRE(data.size() == 4 * sizeof(int32_t));
+    auto values = (const int32_t*)data.data();
+    REQUIRE(
+        std::vector<int32_t>(values, values + 4) ==
+        std::vector<int32_t>({1, 2, 3, 10}));
+    REQUIRE(!soma_sparse->read_next_coo_tensor(dims, "soma_data"));
+
+    // The rest of the query in one tensor, transposed
+    soma_sparse->reset();
+    auto transposed = soma_sparse->read_coo_tensor(
+        {"soma_dim_1", "soma_dim_0"}, "soma_data");
+    coords = transposed->coords();
+    REQUIRE(
+        std::vector<int64_t>(coords.begin(), coords.end()) ==
+        std::vector<int64_t>({1, 0, 2, 0, 3, 0, 4, 5}));
+
+    // Dimensions must be int64
+    soma_sparse->reset();
+    REQUIRE_THROWS_AS(
+        soma_sparse->read_coo_tensor({"soma_data"}, "soma_data"),
+        TileDBSOMAError);
+    soma_sparse->close();
+}
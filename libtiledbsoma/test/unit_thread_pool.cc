@@ -235,6 +235,32 @@ TEST_CASE("ThreadPool: Test recursion", "[threadpool]") {
         cv.wait(ul);
 }
 
+TEST_CASE("ThreadPool: Test nested fine-grained tasks", "[threadpool]") {
+    // Every outer task fans out into many small inner tasks and waits on
+    // them from a worker thread. With work stealing, the waiting workers
+    // execute the inner tasks themselves, so this completes for any pool size.
+    for (size_t num_threads : {1, 2, 4, 16}) {
+        ThreadPool pool{num_threads};
+        std::atomic<int> result(0);
+
+        std::vector<ThreadPool::Task> outer;
+        for (int i = 0; i < 64; ++i) {
+            outer.push_back(pool.execute([&pool, &result]() {
+                std::vector<ThreadPool::Task> inner;
+                for (int j = 0; j < 64; ++j) {
+                    inner.push_back(pool.execute([&result]() {
+                        ++result;
+                        return Status::Ok();
+                    }));
+                }
+                return pool.wait_all(inner);
+            }));
+        }
+        REQUIRE(pool.wait_all(outer).ok());
+        REQUIRE(result == 64 * 64);
+    }
+}
+
 TEST_CASE("ThreadPool: Test recursion, two pools", "[threadpool]") {
     size_t num_threads = 0;
 